@@ -41,6 +41,7 @@
 #include "libavutil/avassert.h"
 #include "libavutil/avstring.h"
 #include "libavutil/bprint.h"
+#include "libavutil/buffer.h"
 #include "libavutil/channel_layout.h"
 #include "libavutil/display.h"
 #include "libavutil/mathematics.h"
@@ -1071,6 +1072,24 @@ int opt_max_alloc(void *optctx, const char *opt, const char *arg)
     return 0;
 }
 
+int opt_hugepages(void *optctx, const char *opt, const char *arg)
+{
+    int flags;
+
+    if (!strcmp(arg, "none"))
+        flags = 0;
+    else if (!strcmp(arg, "transparent"))
+        flags = AV_BUFFER_HUGEPAGES_TRANSPARENT;
+    else if (!strcmp(arg, "explicit"))
+        flags = AV_BUFFER_HUGEPAGES_EXPLICIT | AV_BUFFER_HUGEPAGES_TRANSPARENT;
+    else {
+        av_log(NULL, AV_LOG_FATAL, "Invalid hugepages mode \"%s\".\n", arg);
+        exit_program(1);
+    }
+    av_buffer_set_hugepages(flags);
+    return 0;
+}
+
 int opt_timelimit(void *optctx, const char *opt, const char *arg)
 {
 #if HAVE_SETRLIMIT
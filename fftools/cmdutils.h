@@ -108,6 +108,11 @@ int opt_report(void *optctx, const char *opt, const char *arg);
 
 int opt_max_alloc(void *optctx, const char *opt, const char *arg);
 
+/**
+ * Select how large buffers such as frame data are allocated.
+ */
+int opt_hugepages(void *optctx, const char *opt, const char *arg);
+
 int opt_codec_debug(void *optctx, const char *opt, const char *arg);
 
 /**
@@ -244,6 +249,7 @@ void show_help_options(const OptionDef *options, const char *msg, int req_flags,
     { "v",           HAS_ARG,              { .func_arg = opt_loglevel },     "set logging level", "loglevel" },         \
     { "report",      0,                    { .func_arg = opt_report },       "generate a report" },                     \
     { "max_alloc",   HAS_ARG,              { .func_arg = opt_max_alloc },    "set maximum size of a single allocated block", "bytes" }, \
+    { "hugepages",   HAS_ARG | OPT_EXPERT, { .func_arg = opt_hugepages },    "use hugepages for large buffers", "none|transparent|explicit" }, \
     { "cpuflags",    HAS_ARG | OPT_EXPERT, { .func_arg = opt_cpuflags },     "force specific cpu flags", "flags" },     \
     { "cpucount",    HAS_ARG | OPT_EXPERT, { .func_arg = opt_cpucount },     "force specific cpu count", "count" },     \
     { "hide_banner", OPT_BOOL | OPT_EXPERT, {&hide_banner},     "do not show program banner", "hide_banner" },          \
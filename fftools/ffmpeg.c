@@ -129,6 +129,7 @@ typedef struct BenchmarkTimeStamps {
 static void do_video_stats(OutputStream *ost, int frame_size);
 static BenchmarkTimeStamps get_benchmark_time_stamps(void);
 static int64_t getmaxrss(void);
+static int64_t getpagefaults(void);
 static int ifilter_has_all_input_formats(FilterGraph *fg);
 
 static int run_as_daemon  = 0;
@@ -167,6 +168,7 @@ static int restore_tty;
 
 #if HAVE_THREADS
 static void free_input_threads(void);
+static void free_encoder_threads(void);
 #endif
 
 /* sub2video hack:
@@ -516,9 +518,15 @@ static void ffmpeg_cleanup(int ret)
 {
     int i, j;
 
+#if HAVE_THREADS
+    free_encoder_threads();
+#endif
+
     if (do_benchmark) {
         int maxrss = getmaxrss() / 1024;
         av_log(NULL, AV_LOG_INFO, "bench: maxrss=%ikB\n", maxrss);
+        if (HAVE_GETRUSAGE)
+            av_log(NULL, AV_LOG_INFO, "bench: pagefaults=%"PRId64"\n", getpagefaults());
     }
 
     for (i = 0; i < nb_filtergraphs; i++) {
@@ -908,6 +916,281 @@ finish:
     }
 }
 
+#if HAVE_THREADS
+typedef struct EncoderMessage {
+    AVPacket *pkt;  /* encoded packet, NULL once the frame has been processed */
+    int       ret;  /* encoding error for the frame */
+} EncoderMessage;
+
+static void *encoder_thread(void *arg)
+{
+    OutputStream   *ost = arg;
+    AVCodecContext *enc = ost->enc_ctx;
+    AVFrame *frame;
+
+    while (av_thread_message_queue_recv(ost->enc_in_queue, &frame, 0) >= 0) {
+        EncoderMessage msg = { NULL };
+        int ret;
+
+        ret = avcodec_send_frame(enc, frame);
+        while (ret >= 0) {
+            AVPacket *pkt = av_packet_alloc();
+            if (!pkt) {
+                ret = AVERROR(ENOMEM);
+                break;
+            }
+
+            ret = avcodec_receive_packet(enc, pkt);
+            if (ret < 0) {
+                av_packet_free(&pkt);
+                if (ret == AVERROR(EAGAIN))
+                    ret = 0;
+                break;
+            }
+
+            if (enc->codec_type == AVMEDIA_TYPE_VIDEO) {
+                if (pkt->pts == AV_NOPTS_VALUE && !(enc->codec->capabilities & AV_CODEC_CAP_DELAY))
+                    pkt->pts = frame->pts;
+                /* if two pass, output log */
+                if (ost->logfile && enc->stats_out)
+                    fprintf(ost->logfile, "%s", enc->stats_out);
+            }
+            av_packet_rescale_ts(pkt, enc->time_base, ost->mux_timebase);
+
+            msg.pkt = pkt;
+            if (av_thread_message_queue_send(ost->enc_out_queue, &msg, 0) < 0) {
+                av_packet_free(&pkt);
+                av_frame_free(&frame);
+                return NULL;
+            }
+        }
+        av_frame_free(&frame);
+
+        msg.pkt = NULL;
+        msg.ret = ret;
+        if (av_thread_message_queue_send(ost->enc_out_queue, &msg, 0) < 0)
+            break;
+    }
+
+    return NULL;
+}
+
+static void encoder_msg_free(void *msg)
+{
+    av_packet_free(&((EncoderMessage *)msg)->pkt);
+}
+
+static void encoder_frame_free(void *msg)
+{
+    av_frame_free((AVFrame **)msg);
+}
+
+/*
+ * Receive one message from the encoder thread, waiting for it if block is
+ * set. Returns 0 if there was none.
+ */
+static int encoder_thread_receive(OutputStream *ost, int block)
+{
+    EncoderMessage msg;
+    int ret;
+
+    ret = av_thread_message_queue_recv(ost->enc_out_queue, &msg,
+                                       block ? 0 : AV_THREAD_MESSAGE_NONBLOCK);
+    if (ret == AVERROR(EAGAIN) && !block)
+        return 0;
+    if (ret < 0) {
+        av_log(NULL, AV_LOG_FATAL, "Encoder thread for stream #%d:%d exited: %s\n",
+               ost->file_index, ost->index, av_err2str(ret));
+        exit_program(1);
+    }
+
+    /* the end of a frame is stored as well, to know which round it belongs to */
+    ret = av_fifo_write(ost->enc_packets, &msg.pkt, 1);
+    if (ret < 0) {
+        av_packet_free(&msg.pkt);
+        exit_program(1);
+    }
+    if (msg.pkt)
+        return 1;
+
+    ost->enc_pending--;
+    ost->enc_done++;
+    if (msg.ret < 0) {
+        av_log(NULL, AV_LOG_FATAL, "%s encoding failed: %s\n",
+               ost->enc_ctx->codec_type == AVMEDIA_TYPE_VIDEO ? "Video" : "Audio",
+               av_err2str(msg.ret));
+        exit_program(1);
+    }
+    return 1;
+}
+
+/* wait until all the frames sent to the encoder thread have been encoded */
+static void encoder_thread_wait(OutputStream *ost)
+{
+    while (ost->enc_pending > 0)
+        encoder_thread_receive(ost, 1);
+}
+
+static void encoder_thread_send(OutputStream *ost, AVFrame *frame)
+{
+    AVFrame *tmp = av_frame_clone(frame);
+    int ret;
+
+    if (!tmp)
+        exit_program(1);
+
+    while ((ret = av_thread_message_queue_send(ost->enc_in_queue, &tmp,
+                                               AV_THREAD_MESSAGE_NONBLOCK)) == AVERROR(EAGAIN))
+        encoder_thread_receive(ost, 1);
+    if (ret < 0) {
+        av_frame_free(&tmp);
+        exit_program(1);
+    }
+    ost->enc_pending++;
+    ost->enc_sent++;
+}
+
+typedef struct EncoderRound {
+    int id;         /* rounds are numbered in the order they are muxed */
+    int nb_frames;  /* frames sent to the encoder thread during the round */
+} EncoderRound;
+
+/* oldest round not fully muxed, next round, and stream to mux next */
+static int enc_round_mux, enc_round_next;
+static int enc_mux_stream;
+
+/*
+ * Mux what the encoder threads have produced. Each call ends a round made of
+ * the frames sent to the encoder threads since the previous one. Rounds are
+ * muxed in order, and the streams of a round in order, so that the muxer
+ * sees the packets in the same order as if the frames had been encoded on
+ * the main thread. Unless flushing, this does not wait for the encoders: it
+ * stops at the first stream whose frames are not encoded yet, and the next
+ * call resumes from there.
+ */
+static void output_encoded_packets(int flush)
+{
+    int i, new_round = 0;
+
+    for (i = 0; i < nb_output_streams; i++) {
+        OutputStream *ost = output_streams[i];
+        EncoderRound round = { enc_round_next, ost->enc_sent };
+
+        if (!ost->enc_in_queue || !ost->enc_sent)
+            continue;
+        if (av_fifo_write(ost->enc_rounds, &round, 1) < 0)
+            exit_program(1);
+        ost->enc_sent = 0;
+        new_round = 1;
+    }
+    enc_round_next += new_round;
+
+    for (; enc_round_mux != enc_round_next; enc_round_mux++, enc_mux_stream = 0) {
+        for (; enc_mux_stream < nb_output_streams; enc_mux_stream++) {
+            OutputStream *ost = output_streams[enc_mux_stream];
+            OutputFile    *of = output_files[ost->file_index];
+            EncoderRound round;
+            AVPacket *pkt;
+
+            if (!ost->enc_in_queue ||
+                av_fifo_peek(ost->enc_rounds, &round, 1, 0) < 0 ||
+                round.id != enc_round_mux)
+                continue;
+
+            while (ost->enc_done < round.nb_frames)
+                if (!encoder_thread_receive(ost, flush))
+                    return;
+
+            while (round.nb_frames > 0) {
+                av_fifo_read(ost->enc_packets, &pkt, 1);
+                if (!pkt) {
+                    round.nb_frames--;
+                    ost->enc_done--;
+                    continue;
+                }
+                output_packet(of, pkt, ost, 0);
+                av_packet_free(&pkt);
+            }
+            av_fifo_drain2(ost->enc_rounds, 1);
+        }
+    }
+}
+
+static int init_encoder_thread(OutputStream *ost)
+{
+    int i, ret, nb_encoders = 0;
+
+    if (!parallel_encoding || vstats_filename || do_benchmark_all || debug_ts ||
+        (ost->enc_ctx->codec_type != AVMEDIA_TYPE_VIDEO &&
+         ost->enc_ctx->codec_type != AVMEDIA_TYPE_AUDIO))
+        return 0;
+
+    /* there is nothing to run in parallel with a single encoder */
+    for (i = 0; i < nb_output_streams; i++) {
+        OutputStream *ost2 = output_streams[i];
+        if (ost2->encoding_needed &&
+            (ost2->enc_ctx->codec_type == AVMEDIA_TYPE_VIDEO ||
+             ost2->enc_ctx->codec_type == AVMEDIA_TYPE_AUDIO))
+            nb_encoders++;
+    }
+    if (nb_encoders < 2)
+        return 0;
+
+    ost->enc_packets = av_fifo_alloc2(8, sizeof(AVPacket *), AV_FIFO_FLAG_AUTO_GROW);
+    ost->enc_rounds  = av_fifo_alloc2(8, sizeof(EncoderRound), AV_FIFO_FLAG_AUTO_GROW);
+    if (!ost->enc_packets || !ost->enc_rounds)
+        return AVERROR(ENOMEM);
+
+    ret = av_thread_message_queue_alloc(&ost->enc_in_queue, 8, sizeof(AVFrame *));
+    if (ret < 0)
+        return ret;
+    av_thread_message_queue_set_free_func(ost->enc_in_queue, encoder_frame_free);
+
+    ret = av_thread_message_queue_alloc(&ost->enc_out_queue, 32, sizeof(EncoderMessage));
+    if (ret < 0) {
+        av_thread_message_queue_free(&ost->enc_in_queue);
+        return ret;
+    }
+    av_thread_message_queue_set_free_func(ost->enc_out_queue, encoder_msg_free);
+
+    if ((ret = pthread_create(&ost->enc_thread, NULL, encoder_thread, ost))) {
+        av_log(NULL, AV_LOG_ERROR, "pthread_create failed: %s. Try to increase `ulimit -v` or decrease `ulimit -s`.\n", strerror(ret));
+        av_thread_message_queue_free(&ost->enc_in_queue);
+        av_thread_message_queue_free(&ost->enc_out_queue);
+        return AVERROR(ret);
+    }
+
+    return 0;
+}
+
+static void free_encoder_threads(void)
+{
+    int i;
+
+    for (i = 0; i < nb_output_streams; i++) {
+        OutputStream *ost = output_streams[i];
+        AVPacket *pkt;
+
+        if (!ost || !ost->enc_in_queue)
+            continue;
+
+        av_thread_message_queue_set_err_recv(ost->enc_in_queue, AVERROR_EOF);
+        av_thread_message_queue_set_err_send(ost->enc_out_queue, AVERROR_EOF);
+        pthread_join(ost->enc_thread, NULL);
+
+        av_thread_message_queue_free(&ost->enc_in_queue);
+        av_thread_message_queue_free(&ost->enc_out_queue);
+        while (av_fifo_read(ost->enc_packets, &pkt, 1) >= 0)
+            av_packet_free(&pkt);
+        av_fifo_freep2(&ost->enc_packets);
+        av_fifo_freep2(&ost->enc_rounds);
+        ost->enc_pending = 0;
+        ost->enc_done    = 0;
+        ost->enc_sent    = 0;
+    }
+}
+#endif
+
 static int check_recording_time(OutputStream *ost)
 {
     OutputFile *of = output_files[ost->file_index];
@@ -1015,6 +1298,13 @@ static void do_audio_out(OutputFile *of, OutputStream *ost,
                enc->time_base.num, enc->time_base.den);
     }
 
+#if HAVE_THREADS
+    if (ost->enc_in_queue) {
+        encoder_thread_send(ost, frame);
+        return;
+    }
+#endif
+
     ret = avcodec_send_frame(enc, frame);
     if (ret < 0)
         goto error;
@@ -1340,6 +1630,15 @@ static void do_video_out(OutputFile *of,
 
         ost->frames_encoded++;
 
+#if HAVE_THREADS
+        if (ost->enc_in_queue) {
+            encoder_thread_send(ost, in_picture);
+            // Make sure Closed Captions will not be duplicated
+            av_frame_remove_side_data(in_picture, AV_FRAME_DATA_A53_CC);
+            goto encoded;
+        }
+#endif
+
         ret = avcodec_send_frame(enc, in_picture);
         if (ret < 0)
             goto error;
@@ -1381,6 +1680,9 @@ static void do_video_out(OutputFile *of,
                 fprintf(ost->logfile, "%s", enc->stats_out);
             }
         }
+#if HAVE_THREADS
+encoded:
+#endif
         ost->sync_opts++;
         /*
          * For video, number of frames in == number of packets out.
@@ -1521,8 +1823,15 @@ static int reap_filters(int flush)
 
             switch (av_buffersink_get_type(filter)) {
             case AVMEDIA_TYPE_VIDEO:
-                if (!ost->frame_aspect_ratio.num)
+                if (!ost->frame_aspect_ratio.num) {
+#if HAVE_THREADS
+                    /* the encoder thread may be using the current value */
+                    if (ost->enc_in_queue &&
+                        av_cmp_q(enc->sample_aspect_ratio, filtered_frame->sample_aspect_ratio))
+                        encoder_thread_wait(ost);
+#endif
                     enc->sample_aspect_ratio = filtered_frame->sample_aspect_ratio;
+                }
 
                 do_video_out(of, ost, filtered_frame);
                 break;
@@ -1544,6 +1853,10 @@ static int reap_filters(int flush)
         }
     }
 
+#if HAVE_THREADS
+    output_encoded_packets(0);
+#endif
+
     return 0;
 }
 
@@ -3534,6 +3847,15 @@ static int init_output_stream(OutputStream *ost, AVFrame *frame,
         // copy estimated duration as a hint to the muxer
         if (ost->st->duration <= 0 && ist && ist->st->duration > 0)
             ost->st->duration = av_rescale_q(ist->st->duration, ist->st->time_base, ost->st->time_base);
+
+#if HAVE_THREADS
+        ret = init_encoder_thread(ost);
+        if (ret < 0) {
+            snprintf(error, error_len, "Error starting the encoder thread for "
+                     "output stream #%d:%d", ost->file_index, ost->index);
+            return ret;
+        }
+#endif
     } else if (ost->stream_copy) {
         ret = init_output_stream_streamcopy(ost);
         if (ret < 0)
@@ -4677,6 +4999,11 @@ static int transcode(void)
             process_input_packet(ist, NULL, 0);
         }
     }
+#if HAVE_THREADS
+    /* the encoders are flushed on this thread, wait for their last frames */
+    output_encoded_packets(1);
+    free_encoder_threads();
+#endif
     flush_encoders();
 
     term_exit();
@@ -4749,6 +5076,7 @@ static int transcode(void)
  fail:
 #if HAVE_THREADS
     free_input_threads();
+    free_encoder_threads();
 #endif
 
     if (output_streams) {
@@ -4818,6 +5146,17 @@ static int64_t getmaxrss(void)
 #endif
 }
 
+static int64_t getpagefaults(void)
+{
+#if HAVE_GETRUSAGE
+    struct rusage rusage;
+    getrusage(RUSAGE_SELF, &rusage);
+    return (int64_t)rusage.ru_minflt + rusage.ru_majflt;
+#else
+    return 0;
+#endif
+}
+
 static void log_callback_null(void *ptr, int level, const char *fmt, va_list vl)
 {
 }
@@ -571,6 +571,19 @@ typedef struct OutputStream {
 
     /* frame encode sum of squared error values */
     int64_t error[4];
+
+#if HAVE_THREADS
+    /* frames are encoded in a separate thread when enc_in_queue is set */
+    pthread_t enc_thread;
+    AVThreadMessageQueue *enc_in_queue;   /* frames sent to the encoder thread */
+    AVThreadMessageQueue *enc_out_queue;  /* packets returned by the encoder thread */
+    AVFifo *enc_packets;                  /* returned packets waiting to be muxed,
+                                             each frame ended by a NULL entry */
+    AVFifo *enc_rounds;                   /* frames sent in each round not yet muxed */
+    int enc_pending;                      /* frames not yet fully encoded */
+    int enc_done;                         /* encoded frames waiting in enc_packets */
+    int enc_sent;                         /* frames sent in the current round */
+#endif
 } OutputStream;
 
 typedef struct OutputFile {
@@ -633,6 +646,8 @@ extern char *filter_nbthreads;
 extern int filter_complex_nbthreads;
 extern int vstats_version;
 extern int auto_conversion_filters;
+extern int parallel_encoding;
+extern int parallel_filters;
 
 extern const AVIOInterruptCB int_cb;
 
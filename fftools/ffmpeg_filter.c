@@ -981,6 +981,12 @@ int configure_filtergraph(FilterGraph *fg)
     if (!(fg->graph = avfilter_graph_alloc()))
         return AVERROR(ENOMEM);
 
+    if (parallel_filters) {
+        ret = av_opt_set(fg->graph, "thread_type", "slice+graph", 0);
+        if (ret < 0)
+            goto fail;
+    }
+
     if (simple) {
         OutputStream *ost = fg->outputs[0]->ost;
         char args[512];
@@ -167,6 +167,8 @@ char *filter_nbthreads;
 int filter_complex_nbthreads = 0;
 int vstats_version = 2;
 int auto_conversion_filters = 1;
+int parallel_encoding = 1;
+int parallel_filters = 0;
 int64_t stats_period = 500000;
 
 
@@ -3670,6 +3672,10 @@ const OptionDef options[] = {
         "read complex filtergraph description from a file", "filename" },
     { "auto_conversion_filters", OPT_BOOL | OPT_EXPERT,              { &auto_conversion_filters },
         "enable automatic conversion filters globally" },
+    { "parallel_encoding", OPT_BOOL | OPT_EXPERT,                    { &parallel_encoding },
+        "run the encoders of different output streams in parallel" },
+    { "parallel_filters", OPT_BOOL | OPT_EXPERT,                     { &parallel_filters },
+        "run independent filters of a filtergraph in parallel" },
     { "stats",          OPT_BOOL,                                    { &print_stats },
         "print progress report during encoding", },
     { "stats_period",    HAS_ARG | OPT_EXPERT,                       { .func_arg = opt_stats_period },
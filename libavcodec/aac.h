@@ -259,6 +259,7 @@ typedef struct SingleChannelElement {
     uint8_t can_pns[128];                           ///< band is allowed to PNS (informative)
     float  is_ener[128];                            ///< Intensity stereo pos (used by encoder)
     float pns_ener[128];                            ///< Noise energy values (used by encoder)
+    int random_state;                               ///< PNS noise generator state (used by encoder)
     DECLARE_ALIGNED(32, INTFLOAT, pcoeffs)[1024];   ///< coefficients for IMDCT, pristine
     DECLARE_ALIGNED(32, INTFLOAT, coeffs)[1024];    ///< coefficients for IMDCT, maybe processed
     DECLARE_ALIGNED(32, INTFLOAT, saved)[1536];     ///< overlap
@@ -555,23 +555,12 @@ static void search_for_pns(AACEncContext *s, AVCodecContext *avctx, SingleChanne
     const float dist_bias = av_clipf(4.f * 120 / lambda, 0.25f, 4.0f);
     const float pns_transient_energy_r = FFMIN(0.7f, lambda / 140.f);
 
-    int refbits = avctx->bit_rate * 1024.0 / avctx->sample_rate
-        / ((avctx->flags & AV_CODEC_FLAG_QSCALE) ? 2.0f : avctx->channels)
-        * (lambda / 120.f);
-
-    /** Keep this in sync with twoloop's cutoff selection */
-    float rate_bandwidth_multiplier = 1.5f;
     int prev = -1000, prev_sf = -1;
-    int frame_bit_rate = (avctx->flags & AV_CODEC_FLAG_QSCALE)
-        ? (refbits * rate_bandwidth_multiplier * avctx->sample_rate / 1024)
-        : (avctx->bit_rate / avctx->channels);
-
-    frame_bit_rate *= 1.15f;
 
     if (avctx->cutoff > 0) {
         bandwidth = avctx->cutoff;
     } else {
-        bandwidth = FFMAX(3000, AAC_CUTOFF_FROM_BITRATE(frame_bit_rate, 1, avctx->sample_rate));
+        bandwidth = twoloop_bandwidth(avctx, lambda, 1);
     }
 
     cutoff = bandwidth * 2 * wlen / avctx->sample_rate;
@@ -643,8 +632,8 @@ static void search_for_pns(AACEncContext *s, AVCodecContext *avctx, SingleChanne
                 const int start_c = (w+w2)*128+sce->ics.swb_offset[g];
                 band = &s->psy.ch[s->cur_channel].psy_bands[(w+w2)*16+g];
                 for (i = 0; i < sce->ics.swb_sizes[g]; i++) {
-                    s->random_state  = lcg_random(s->random_state);
-                    PNS[i] = s->random_state;
+                    sce->random_state = lcg_random(sce->random_state);
+                    PNS[i] = sce->random_state;
                 }
                 band_energy = s->fdsp->scalarproduct_float(PNS, PNS, sce->ics.swb_sizes[g]);
                 scale = noise_amp/sqrtf(band_energy);
@@ -692,22 +681,10 @@ static void mark_pns(AACEncContext *s, AVCodecContext *avctx, SingleChannelEleme
     const float spread_threshold = FFMIN(0.75f, NOISE_SPREAD_THRESHOLD*FFMAX(0.5f, lambda/100.f));
     const float pns_transient_energy_r = FFMIN(0.7f, lambda / 140.f);
 
-    int refbits = avctx->bit_rate * 1024.0 / avctx->sample_rate
-        / ((avctx->flags & AV_CODEC_FLAG_QSCALE) ? 2.0f : avctx->channels)
-        * (lambda / 120.f);
-
-    /** Keep this in sync with twoloop's cutoff selection */
-    float rate_bandwidth_multiplier = 1.5f;
-    int frame_bit_rate = (avctx->flags & AV_CODEC_FLAG_QSCALE)
-        ? (refbits * rate_bandwidth_multiplier * avctx->sample_rate / 1024)
-        : (avctx->bit_rate / avctx->channels);
-
-    frame_bit_rate *= 1.15f;
-
     if (avctx->cutoff > 0) {
         bandwidth = avctx->cutoff;
     } else {
-        bandwidth = FFMAX(3000, AAC_CUTOFF_FROM_BITRATE(frame_bit_rate, 1, avctx->sample_rate));
+        bandwidth = twoloop_bandwidth(avctx, lambda, 1);
     }
 
     cutoff = bandwidth * 2 * wlen / avctx->sample_rate;
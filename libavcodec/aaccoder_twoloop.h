@@ -73,7 +73,6 @@ static void search_for_quantizers_twoloop(AVCodecContext *avctx,
     int destbits = avctx->bit_rate * 1024.0 / avctx->sample_rate
         / ((avctx->flags & AV_CODEC_FLAG_QSCALE) ? 2.0f : avctx->channels)
         * (lambda / 120.f);
-    int refbits = destbits;
     int toomanybits, toofewbits;
     char nzs[128];
     uint8_t nextband[128];
@@ -182,20 +181,13 @@ static void search_for_quantizers_twoloop(AVCodecContext *avctx,
          * rather than increase quantization noise. Adjust nominal bitrate
          * to effective bitrate according to encoding parameters,
          * AAC_CUTOFF_FROM_BITRATE is calibrated for effective bitrate.
+         * Compensate for extensions that increase efficiency.
          */
-        float rate_bandwidth_multiplier = 1.5f;
-        int frame_bit_rate = (avctx->flags & AV_CODEC_FLAG_QSCALE)
-            ? (refbits * rate_bandwidth_multiplier * avctx->sample_rate / 1024)
-            : (avctx->bit_rate / avctx->channels);
-
-        /** Compensate for extensions that increase efficiency */
-        if (s->options.pns || s->options.intensity_stereo)
-            frame_bit_rate *= 1.15f;
-
         if (avctx->cutoff > 0) {
             bandwidth = avctx->cutoff;
         } else {
-            bandwidth = FFMAX(3000, AAC_CUTOFF_FROM_BITRATE(frame_bit_rate, 1, avctx->sample_rate));
+            bandwidth = twoloop_bandwidth(avctx, lambda,
+                                          s->options.pns || s->options.intensity_stereo);
             s->psy.cutoff = bandwidth;
         }
 
@@ -553,19 +553,255 @@ static void copy_input_samples(AACEncContext *s, const AVFrame *frame)
     }
 }
 
+/**
+ * Choose the window, apply the MDCT and evaluate the clipping risk for the
+ * channels of one channel element.
+ */
+static int window_element(AVCodecContext *avctx, void *arg, int i, int threadnr)
+{
+    AACEncContext *s = avctx->priv_data;
+    AACEncContext *t = s->thread_ctx[threadnr];
+    const AVFrame *frame = arg;
+    float **samples = s->planar_samples, *samples2, *la, *overlap;
+    FFPsyWindowInfo *wi = s->windows + s->elements[i].start_ch;
+    ChannelElement *cpe = &s->cpe[i];
+    SingleChannelElement *sce;
+    IndividualChannelStream *ics;
+    int tag   = s->chan_map[i+1];
+    int chans = tag == TYPE_CPE ? 2 : 1;
+    int ch, w;
+
+    for (ch = 0; ch < chans; ch++) {
+        int k;
+        float clip_avoidance_factor;
+        sce = &cpe->ch[ch];
+        ics = &sce->ics;
+        t->cur_channel = s->elements[i].start_ch + ch;
+        overlap  = &samples[t->cur_channel][0];
+        samples2 = overlap + 1024;
+        la       = samples2 + (448+64);
+        if (!frame)
+            la = NULL;
+        if (tag == TYPE_LFE) {
+            wi[ch].window_type[0] = wi[ch].window_type[1] = ONLY_LONG_SEQUENCE;
+            wi[ch].window_shape   = 0;
+            wi[ch].num_windows    = 1;
+            wi[ch].grouping[0]    = 1;
+            wi[ch].clipping[0]    = 0;
+
+            /* Only the lowest 12 coefficients are used in a LFE channel.
+             * The expression below results in only the bottom 8 coefficients
+             * being used for 11.025kHz to 16kHz sample rates.
+             */
+            ics->num_swb = s->samplerate_index >= 8 ? 1 : 3;
+        } else {
+            wi[ch] = s->psy.model->window(&s->psy, samples2, la, t->cur_channel,
+                                          ics->window_sequence[0]);
+        }
+        ics->window_sequence[1] = ics->window_sequence[0];
+        ics->window_sequence[0] = wi[ch].window_type[0];
+        ics->use_kb_window[1]   = ics->use_kb_window[0];
+        ics->use_kb_window[0]   = wi[ch].window_shape;
+        ics->num_windows        = wi[ch].num_windows;
+        ics->swb_sizes          = s->psy.bands    [ics->num_windows == 8];
+        ics->num_swb            = tag == TYPE_LFE ? ics->num_swb : s->psy.num_bands[ics->num_windows == 8];
+        ics->max_sfb            = FFMIN(ics->max_sfb, ics->num_swb);
+        ics->swb_offset         = wi[ch].window_type[0] == EIGHT_SHORT_SEQUENCE ?
+                                    ff_swb_offset_128 [s->samplerate_index]:
+                                    ff_swb_offset_1024[s->samplerate_index];
+        ics->tns_max_bands      = wi[ch].window_type[0] == EIGHT_SHORT_SEQUENCE ?
+                                    ff_tns_max_bands_128 [s->samplerate_index]:
+                                    ff_tns_max_bands_1024[s->samplerate_index];
+
+        for (w = 0; w < ics->num_windows; w++)
+            ics->group_len[w] = wi[ch].grouping[w];
+
+        /* Calculate input sample maximums and evaluate clipping risk */
+        clip_avoidance_factor = 0.0f;
+        for (w = 0; w < ics->num_windows; w++) {
+            const float *wbuf = overlap + w * 128;
+            const int wlen = 2048 / ics->num_windows;
+            float max = 0;
+            int j;
+            /* mdct input is 2 * output */
+            for (j = 0; j < wlen; j++)
+                max = FFMAX(max, fabsf(wbuf[j]));
+            wi[ch].clipping[w] = max;
+        }
+        for (w = 0; w < ics->num_windows; w++) {
+            if (wi[ch].clipping[w] > CLIP_AVOIDANCE_FACTOR) {
+                ics->window_clipping[w] = 1;
+                clip_avoidance_factor = FFMAX(clip_avoidance_factor, wi[ch].clipping[w]);
+            } else {
+                ics->window_clipping[w] = 0;
+            }
+        }
+        if (clip_avoidance_factor > CLIP_AVOIDANCE_FACTOR) {
+            ics->clip_avoidance_factor = CLIP_AVOIDANCE_FACTOR / clip_avoidance_factor;
+        } else {
+            ics->clip_avoidance_factor = 1.0f;
+        }
+
+        apply_window_and_mdct(s, sce, overlap);
+
+        if (s->options.ltp && s->coder->update_ltp) {
+            s->coder->update_ltp(t, sce);
+            apply_window[sce->ics.window_sequence[0]](s->fdsp, sce, &sce->ltp_state[0]);
+            s->mdct1024.mdct_calc(&s->mdct1024, sce->lcoeffs, sce->ret_buf);
+        }
+
+        for (k = 0; k < 1024; k++) {
+            if (!(fabs(cpe->ch[ch].coeffs[k]) < 1E16)) { // Ensure headroom for energy calculation
+                av_log(avctx, AV_LOG_ERROR, "Input contains (near) NaN/+-Inf\n");
+                return AVERROR(EINVAL);
+            }
+        }
+        avoid_clipping(s, sce);
+    }
+
+    return 0;
+}
+
+/**
+ * Search quantizers and coding tools for one channel element and write it
+ * to the element's own bitstream buffer. Elements are independent once the
+ * psychoacoustic analysis of the frame is done.
+ */
+static int code_element(AVCodecContext *avctx, void *arg, int i, int threadnr)
+{
+    AACEncContext *s = avctx->priv_data;
+    AACEncContext *t = s->thread_ctx[threadnr];
+    AACEncElement *el = &s->elements[i];
+    FFPsyWindowInfo *wi = s->windows + el->start_ch;
+    ChannelElement *cpe = &s->cpe[i];
+    SingleChannelElement *sce;
+    int tag   = s->chan_map[i+1];
+    int chans = tag == TYPE_CPE ? 2 : 1;
+    int start_ch = el->start_ch;
+    int ch, w;
+
+    t->psy              = s->psy;
+    t->psy.bitres.alloc = el->bitres_alloc;
+    t->psy.bitres.bits  = s->last_frame_pb_count / s->channels;
+    t->lambda           = s->lambda;
+
+    el->ms_mode = el->is_mode = el->tns_mode = el->pred_mode = 0;
+
+    init_put_bits(&t->pb, el->buf, el->buf_size);
+    put_bits(&t->pb, 3, tag);
+    put_bits(&t->pb, 4, el->instance);
+
+    t->cur_type = tag;
+    for (ch = 0; ch < chans; ch++) {
+        t->cur_channel = start_ch + ch;
+        if (t->options.pns && t->coder->mark_pns)
+            t->coder->mark_pns(t, avctx, &cpe->ch[ch]);
+        t->coder->search_for_quantizers(avctx, t, &cpe->ch[ch], t->lambda);
+    }
+    if (chans > 1
+        && wi[0].window_type[0] == wi[1].window_type[0]
+        && wi[0].window_shape   == wi[1].window_shape) {
+
+        cpe->common_window = 1;
+        for (w = 0; w < wi[0].num_windows; w++) {
+            if (wi[0].grouping[w] != wi[1].grouping[w]) {
+                cpe->common_window = 0;
+                break;
+            }
+        }
+    }
+    for (ch = 0; ch < chans; ch++) { /* TNS and PNS */
+        sce = &cpe->ch[ch];
+        t->cur_channel = start_ch + ch;
+        if (t->options.tns && t->coder->search_for_tns)
+            t->coder->search_for_tns(t, sce);
+        if (t->options.tns && t->coder->apply_tns_filt)
+            t->coder->apply_tns_filt(t, sce);
+        if (sce->tns.present)
+            el->tns_mode = 1;
+        if (t->options.pns && t->coder->search_for_pns)
+            t->coder->search_for_pns(t, avctx, sce);
+    }
+    t->cur_channel = start_ch;
+    if (t->options.intensity_stereo) { /* Intensity Stereo */
+        if (t->coder->search_for_is)
+            t->coder->search_for_is(t, avctx, cpe);
+        if (cpe->is_mode) el->is_mode = 1;
+        apply_intensity_stereo(cpe);
+    }
+    if (t->options.pred) { /* Prediction */
+        for (ch = 0; ch < chans; ch++) {
+            sce = &cpe->ch[ch];
+            t->cur_channel = start_ch + ch;
+            if (t->options.pred && t->coder->search_for_pred)
+                t->coder->search_for_pred(t, sce);
+            if (cpe->ch[ch].ics.predictor_present) el->pred_mode = 1;
+        }
+        t->cur_channel = start_ch;
+        if (t->coder->adjust_common_pred)
+            t->coder->adjust_common_pred(t, cpe);
+        for (ch = 0; ch < chans; ch++) {
+            sce = &cpe->ch[ch];
+            t->cur_channel = start_ch + ch;
+            if (t->options.pred && t->coder->apply_main_pred)
+                t->coder->apply_main_pred(t, sce);
+        }
+        t->cur_channel = start_ch;
+    }
+    if (t->options.mid_side) { /* Mid/Side stereo */
+        if (t->options.mid_side == -1 && t->coder->search_for_ms)
+            t->coder->search_for_ms(t, cpe);
+        else if (cpe->common_window)
+            memset(cpe->ms_mask, 1, sizeof(cpe->ms_mask));
+        apply_mid_side_stereo(cpe);
+    }
+    adjust_frame_information(cpe, chans);
+    if (t->options.ltp) { /* LTP */
+        for (ch = 0; ch < chans; ch++) {
+            sce = &cpe->ch[ch];
+            t->cur_channel = start_ch + ch;
+            if (t->coder->search_for_ltp)
+                t->coder->search_for_ltp(t, sce, cpe->common_window);
+            if (sce->ics.ltp.present) el->pred_mode = 1;
+        }
+        t->cur_channel = start_ch;
+        if (t->coder->adjust_common_ltp)
+            t->coder->adjust_common_ltp(t, cpe);
+    }
+    if (chans == 2) {
+        put_bits(&t->pb, 1, cpe->common_window);
+        if (cpe->common_window) {
+            put_ics_info(t, &cpe->ch[0].ics);
+            if (t->coder->encode_main_pred)
+                t->coder->encode_main_pred(t, &cpe->ch[0]);
+            if (t->coder->encode_ltp_info)
+                t->coder->encode_ltp_info(t, &cpe->ch[0], 1);
+            encode_ms_info(&t->pb, cpe);
+            if (cpe->ms_mode) el->ms_mode = 1;
+        }
+    }
+    for (ch = 0; ch < chans; ch++) {
+        t->cur_channel = start_ch + ch;
+        encode_individual_channel(avctx, t, &cpe->ch[ch], cpe->common_window);
+    }
+
+    el->bits   = put_bits_count(&t->pb);
+    el->cutoff = t->psy.cutoff;
+    flush_put_bits(&t->pb);
+
+    return 0;
+}
+
 static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
                             const AVFrame *frame, int *got_packet_ptr)
 {
     AACEncContext *s = avctx->priv_data;
-    float **samples = s->planar_samples, *samples2, *la, *overlap;
     ChannelElement *cpe;
     SingleChannelElement *sce;
-    IndividualChannelStream *ics;
-    int i, its, ch, w, chans, tag, start_ch, ret, frame_bits;
+    int i, its, ch, w, chans, tag, ret, frame_bits;
     int target_bits, rate_bits, too_many_bits, too_few_bits;
     int ms_mode = 0, is_mode = 0, tns_mode = 0, pred_mode = 0;
-    int chan_el_counter[4];
-    FFPsyWindowInfo windows[AAC_MAX_CHANNELS];
+    int rets[AAC_MAX_CHANNELS];
 
     /* add current frame to queue */
     if (frame) {
@@ -583,114 +819,18 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
     if (!avctx->frame_number)
         return 0;
 
-    start_ch = 0;
-    for (i = 0; i < s->chan_map[0]; i++) {
-        FFPsyWindowInfo* wi = windows + start_ch;
-        tag      = s->chan_map[i+1];
-        chans    = tag == TYPE_CPE ? 2 : 1;
-        cpe      = &s->cpe[i];
-        for (ch = 0; ch < chans; ch++) {
-            int k;
-            float clip_avoidance_factor;
-            sce = &cpe->ch[ch];
-            ics = &sce->ics;
-            s->cur_channel = start_ch + ch;
-            overlap  = &samples[s->cur_channel][0];
-            samples2 = overlap + 1024;
-            la       = samples2 + (448+64);
-            if (!frame)
-                la = NULL;
-            if (tag == TYPE_LFE) {
-                wi[ch].window_type[0] = wi[ch].window_type[1] = ONLY_LONG_SEQUENCE;
-                wi[ch].window_shape   = 0;
-                wi[ch].num_windows    = 1;
-                wi[ch].grouping[0]    = 1;
-                wi[ch].clipping[0]    = 0;
-
-                /* Only the lowest 12 coefficients are used in a LFE channel.
-                 * The expression below results in only the bottom 8 coefficients
-                 * being used for 11.025kHz to 16kHz sample rates.
-                 */
-                ics->num_swb = s->samplerate_index >= 8 ? 1 : 3;
-            } else {
-                wi[ch] = s->psy.model->window(&s->psy, samples2, la, s->cur_channel,
-                                              ics->window_sequence[0]);
-            }
-            ics->window_sequence[1] = ics->window_sequence[0];
-            ics->window_sequence[0] = wi[ch].window_type[0];
-            ics->use_kb_window[1]   = ics->use_kb_window[0];
-            ics->use_kb_window[0]   = wi[ch].window_shape;
-            ics->num_windows        = wi[ch].num_windows;
-            ics->swb_sizes          = s->psy.bands    [ics->num_windows == 8];
-            ics->num_swb            = tag == TYPE_LFE ? ics->num_swb : s->psy.num_bands[ics->num_windows == 8];
-            ics->max_sfb            = FFMIN(ics->max_sfb, ics->num_swb);
-            ics->swb_offset         = wi[ch].window_type[0] == EIGHT_SHORT_SEQUENCE ?
-                                        ff_swb_offset_128 [s->samplerate_index]:
-                                        ff_swb_offset_1024[s->samplerate_index];
-            ics->tns_max_bands      = wi[ch].window_type[0] == EIGHT_SHORT_SEQUENCE ?
-                                        ff_tns_max_bands_128 [s->samplerate_index]:
-                                        ff_tns_max_bands_1024[s->samplerate_index];
-
-            for (w = 0; w < ics->num_windows; w++)
-                ics->group_len[w] = wi[ch].grouping[w];
-
-            /* Calculate input sample maximums and evaluate clipping risk */
-            clip_avoidance_factor = 0.0f;
-            for (w = 0; w < ics->num_windows; w++) {
-                const float *wbuf = overlap + w * 128;
-                const int wlen = 2048 / ics->num_windows;
-                float max = 0;
-                int j;
-                /* mdct input is 2 * output */
-                for (j = 0; j < wlen; j++)
-                    max = FFMAX(max, fabsf(wbuf[j]));
-                wi[ch].clipping[w] = max;
-            }
-            for (w = 0; w < ics->num_windows; w++) {
-                if (wi[ch].clipping[w] > CLIP_AVOIDANCE_FACTOR) {
-                    ics->window_clipping[w] = 1;
-                    clip_avoidance_factor = FFMAX(clip_avoidance_factor, wi[ch].clipping[w]);
-                } else {
-                    ics->window_clipping[w] = 0;
-                }
-            }
-            if (clip_avoidance_factor > CLIP_AVOIDANCE_FACTOR) {
-                ics->clip_avoidance_factor = CLIP_AVOIDANCE_FACTOR / clip_avoidance_factor;
-            } else {
-                ics->clip_avoidance_factor = 1.0f;
-            }
-
-            apply_window_and_mdct(s, sce, overlap);
-
-            if (s->options.ltp && s->coder->update_ltp) {
-                s->coder->update_ltp(s, sce);
-                apply_window[sce->ics.window_sequence[0]](s->fdsp, sce, &sce->ltp_state[0]);
-                s->mdct1024.mdct_calc(&s->mdct1024, sce->lcoeffs, sce->ret_buf);
-            }
+    avctx->execute2(avctx, window_element, (void *)frame, rets, s->chan_map[0]);
+    for (i = 0; i < s->chan_map[0]; i++)
+        if (rets[i] < 0)
+            return rets[i];
 
-            for (k = 0; k < 1024; k++) {
-                if (!(fabs(cpe->ch[ch].coeffs[k]) < 1E16)) { // Ensure headroom for energy calculation
-                    av_log(avctx, AV_LOG_ERROR, "Input contains (near) NaN/+-Inf\n");
-                    return AVERROR(EINVAL);
-                }
-            }
-            avoid_clipping(s, sce);
-        }
-        start_ch += chans;
-    }
     if ((ret = ff_alloc_packet(avctx, avpkt, 8192 * s->channels)) < 0)
         return ret;
     frame_bits = its = 0;
     do {
-        init_put_bits(&s->pb, avpkt->data, avpkt->size);
-
-        if ((avctx->frame_number & 0xFF)==1 && !(avctx->flags & AV_CODEC_FLAG_BITEXACT))
-            put_bitstream_info(s, LIBAVCODEC_IDENT);
-        start_ch = 0;
         target_bits = 0;
-        memset(chan_el_counter, 0, sizeof(chan_el_counter));
         for (i = 0; i < s->chan_map[0]; i++) {
-            FFPsyWindowInfo* wi = windows + start_ch;
+            FFPsyWindowInfo* wi = s->windows + s->elements[i].start_ch;
             const float *coeffs[2];
             tag      = s->chan_map[i+1];
             chans    = tag == TYPE_CPE ? 2 : 1;
@@ -698,8 +838,6 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
             cpe->common_window = 0;
             memset(cpe->is_mask, 0, sizeof(cpe->is_mask));
             memset(cpe->ms_mask, 0, sizeof(cpe->ms_mask));
-            put_bits(&s->pb, 3, tag);
-            put_bits(&s->pb, 4, chan_el_counter[tag]++);
             for (ch = 0; ch < chans; ch++) {
                 sce = &cpe->ch[ch];
                 coeffs[ch] = sce->coeffs;
@@ -712,108 +850,39 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
                     if (sce->band_type[w] > RESERVED_BT)
                         sce->band_type[w] = 0;
             }
+            /* All elements are analyzed before any is coded, so set up the
+             * cutoff the quantizer search of the previous element picks. */
+            if (i && s->options.coder == AAC_CODER_TWOLOOP && avctx->cutoff <= 0)
+                s->psy.cutoff = twoloop_bandwidth(avctx, s->lambda,
+                                                  s->options.pns ||
+                                                  s->options.intensity_stereo);
             s->psy.bitres.alloc = -1;
             s->psy.bitres.bits = s->last_frame_pb_count / s->channels;
-            s->psy.model->analyze(&s->psy, start_ch, coeffs, wi);
+            s->psy.model->analyze(&s->psy, s->elements[i].start_ch, coeffs, wi);
             if (s->psy.bitres.alloc > 0) {
                 /* Lambda unused here on purpose, we need to take psy's unscaled allocation */
                 target_bits += s->psy.bitres.alloc
                     * (s->lambda / (avctx->global_quality ? avctx->global_quality : 120));
                 s->psy.bitres.alloc /= chans;
             }
-            s->cur_type = tag;
-            for (ch = 0; ch < chans; ch++) {
-                s->cur_channel = start_ch + ch;
-                if (s->options.pns && s->coder->mark_pns)
-                    s->coder->mark_pns(s, avctx, &cpe->ch[ch]);
-                s->coder->search_for_quantizers(avctx, s, &cpe->ch[ch], s->lambda);
-            }
-            if (chans > 1
-                && wi[0].window_type[0] == wi[1].window_type[0]
-                && wi[0].window_shape   == wi[1].window_shape) {
-
-                cpe->common_window = 1;
-                for (w = 0; w < wi[0].num_windows; w++) {
-                    if (wi[0].grouping[w] != wi[1].grouping[w]) {
-                        cpe->common_window = 0;
-                        break;
-                    }
-                }
-            }
-            for (ch = 0; ch < chans; ch++) { /* TNS and PNS */
-                sce = &cpe->ch[ch];
-                s->cur_channel = start_ch + ch;
-                if (s->options.tns && s->coder->search_for_tns)
-                    s->coder->search_for_tns(s, sce);
-                if (s->options.tns && s->coder->apply_tns_filt)
-                    s->coder->apply_tns_filt(s, sce);
-                if (sce->tns.present)
-                    tns_mode = 1;
-                if (s->options.pns && s->coder->search_for_pns)
-                    s->coder->search_for_pns(s, avctx, sce);
-            }
-            s->cur_channel = start_ch;
-            if (s->options.intensity_stereo) { /* Intensity Stereo */
-                if (s->coder->search_for_is)
-                    s->coder->search_for_is(s, avctx, cpe);
-                if (cpe->is_mode) is_mode = 1;
-                apply_intensity_stereo(cpe);
-            }
-            if (s->options.pred) { /* Prediction */
-                for (ch = 0; ch < chans; ch++) {
-                    sce = &cpe->ch[ch];
-                    s->cur_channel = start_ch + ch;
-                    if (s->options.pred && s->coder->search_for_pred)
-                        s->coder->search_for_pred(s, sce);
-                    if (cpe->ch[ch].ics.predictor_present) pred_mode = 1;
-                }
-                if (s->coder->adjust_common_pred)
-                    s->coder->adjust_common_pred(s, cpe);
-                for (ch = 0; ch < chans; ch++) {
-                    sce = &cpe->ch[ch];
-                    s->cur_channel = start_ch + ch;
-                    if (s->options.pred && s->coder->apply_main_pred)
-                        s->coder->apply_main_pred(s, sce);
-                }
-                s->cur_channel = start_ch;
-            }
-            if (s->options.mid_side) { /* Mid/Side stereo */
-                if (s->options.mid_side == -1 && s->coder->search_for_ms)
-                    s->coder->search_for_ms(s, cpe);
-                else if (cpe->common_window)
-                    memset(cpe->ms_mask, 1, sizeof(cpe->ms_mask));
-                apply_mid_side_stereo(cpe);
-            }
-            adjust_frame_information(cpe, chans);
-            if (s->options.ltp) { /* LTP */
-                for (ch = 0; ch < chans; ch++) {
-                    sce = &cpe->ch[ch];
-                    s->cur_channel = start_ch + ch;
-                    if (s->coder->search_for_ltp)
-                        s->coder->search_for_ltp(s, sce, cpe->common_window);
-                    if (sce->ics.ltp.present) pred_mode = 1;
-                }
-                s->cur_channel = start_ch;
-                if (s->coder->adjust_common_ltp)
-                    s->coder->adjust_common_ltp(s, cpe);
-            }
-            if (chans == 2) {
-                put_bits(&s->pb, 1, cpe->common_window);
-                if (cpe->common_window) {
-                    put_ics_info(s, &cpe->ch[0].ics);
-                    if (s->coder->encode_main_pred)
-                        s->coder->encode_main_pred(s, &cpe->ch[0]);
-                    if (s->coder->encode_ltp_info)
-                        s->coder->encode_ltp_info(s, &cpe->ch[0], 1);
-                    encode_ms_info(&s->pb, cpe);
-                    if (cpe->ms_mode) ms_mode = 1;
-                }
-            }
-            for (ch = 0; ch < chans; ch++) {
-                s->cur_channel = start_ch + ch;
-                encode_individual_channel(avctx, s, &cpe->ch[ch], cpe->common_window);
-            }
-            start_ch += chans;
+            s->elements[i].bitres_alloc = s->psy.bitres.alloc;
+        }
+
+        avctx->execute2(avctx, code_element, NULL, NULL, s->chan_map[0]);
+
+        init_put_bits(&s->pb, avpkt->data, avpkt->size);
+
+        if ((avctx->frame_number & 0xFF)==1 && !(avctx->flags & AV_CODEC_FLAG_BITEXACT))
+            put_bitstream_info(s, LIBAVCODEC_IDENT);
+        for (i = 0; i < s->chan_map[0]; i++) {
+            AACEncElement *el = &s->elements[i];
+            tag = s->chan_map[i+1];
+            ff_copy_bits(&s->pb, el->buf, el->bits);
+            ms_mode   |= el->ms_mode;
+            is_mode   |= el->is_mode;
+            tns_mode  |= el->tns_mode;
+            pred_mode |= el->pred_mode;
+            s->psy.cutoff = el->cutoff;
         }
 
         if (avctx->flags & AV_CODEC_FLAG_QSCALE) {
@@ -899,6 +968,7 @@ static int aac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
 static av_cold int aac_encode_end(AVCodecContext *avctx)
 {
     AACEncContext *s = avctx->priv_data;
+    int i;
 
     av_log(avctx, AV_LOG_INFO, "Qavg: %.3f\n", s->lambda_count ? s->lambda_sum / s->lambda_count : NAN);
 
@@ -906,6 +976,15 @@ static av_cold int aac_encode_end(AVCodecContext *avctx)
     ff_mdct_end(&s->mdct128);
     ff_psy_end(&s->psy);
     ff_lpc_end(&s->lpc);
+    for (i = 0; i < s->nb_threads; i++) {
+        ff_lpc_end(&s->thread_ctx[i]->lpc);
+        av_freep(&s->thread_ctx[i]);
+    }
+    av_freep(&s->thread_ctx);
+    if (s->elements)
+        for (i = 0; i < s->chan_map[0]; i++)
+            av_freep(&s->elements[i].buf);
+    av_freep(&s->elements);
     if (s->psypp)
         ff_psy_preprocess_end(s->psypp);
     av_freep(&s->buffer.samples);
@@ -915,6 +994,17 @@ static av_cold int aac_encode_end(AVCodecContext *avctx)
     return 0;
 }
 
+av_cold void ff_aac_dsp_init(AACEncContext *s)
+{
+    s->abs_pow34   = abs_pow34_v;
+    s->quant_bands = quantize_bands;
+
+    if (ARCH_AARCH64)
+        ff_aac_dsp_init_aarch64(s);
+    if (ARCH_X86)
+        ff_aac_dsp_init_x86(s);
+}
+
 static av_cold int dsp_init(AVCodecContext *avctx, AACEncContext *s)
 {
     int ret = 0;
@@ -936,14 +1026,69 @@ static av_cold int dsp_init(AVCodecContext *avctx, AACEncContext *s)
 
 static av_cold int alloc_buffers(AVCodecContext *avctx, AACEncContext *s)
 {
-    int ch;
+    int ch, i, start_ch = 0;
+    int instances[4] = { 0 };
     if (!FF_ALLOCZ_TYPED_ARRAY(s->buffer.samples, s->channels * 3 * 1024) ||
-        !FF_ALLOCZ_TYPED_ARRAY(s->cpe,            s->chan_map[0]))
+        !FF_ALLOCZ_TYPED_ARRAY(s->cpe,            s->chan_map[0]) ||
+        !FF_ALLOCZ_TYPED_ARRAY(s->elements,       s->chan_map[0]))
         return AVERROR(ENOMEM);
 
     for(ch = 0; ch < s->channels; ch++)
         s->planar_samples[ch] = s->buffer.samples + 3 * 1024 * ch;
 
+    for (i = 0; i < s->chan_map[0]; i++) {
+        AACEncElement *el = &s->elements[i];
+        int tag   = s->chan_map[i+1];
+        int chans = tag == TYPE_CPE ? 2 : 1;
+
+        el->start_ch = start_ch;
+        el->instance = instances[tag]++;
+        el->buf_size = 8192 * chans;
+        el->buf      = av_malloc(el->buf_size);
+        if (!el->buf)
+            return AVERROR(ENOMEM);
+        /* every channel draws its own PNS noise, so the noise does not
+         * depend on the order the elements are coded in */
+        for (ch = 0; ch < chans; ch++)
+            s->cpe[i].ch[ch].random_state = 0x1f2e3d4c;
+        start_ch += chans;
+    }
+
+    return 0;
+}
+
+/**
+ * Set up the coder contexts used by code_element(). With slice threading
+ * every worker gets its own copy of the context for the per-channel state
+ * and scratch buffers of the coder; channel elements are shared.
+ */
+static av_cold int alloc_thread_contexts(AVCodecContext *avctx, AACEncContext *s)
+{
+    int i, ret;
+
+    if (!(avctx->active_thread_type & FF_THREAD_SLICE) || avctx->thread_count <= 1) {
+        if (!FF_ALLOCZ_TYPED_ARRAY(s->thread_ctx, 1))
+            return AVERROR(ENOMEM);
+        s->thread_ctx[0] = s;
+        return 0;
+    }
+
+    if (!FF_ALLOCZ_TYPED_ARRAY(s->thread_ctx, avctx->thread_count))
+        return AVERROR(ENOMEM);
+    for (i = 0; i < avctx->thread_count; i++) {
+        AACEncContext *t = av_memdup(s, sizeof(*s));
+        if (!t)
+            return AVERROR(ENOMEM);
+        s->thread_ctx[i] = t;
+        s->nb_threads    = i + 1;
+        t->thread_ctx    = NULL;
+        t->nb_threads    = 0;
+        memset(&t->lpc, 0, sizeof(t->lpc));
+        if ((ret = ff_lpc_init(&t->lpc, 2*avctx->frame_size, TNS_MAX_ORDER,
+                               FF_LPC_TYPE_LEVINSON)) < 0)
+            return ret;
+    }
+
     return 0;
 }
 
@@ -1087,13 +1232,8 @@ static av_cold int aac_encode_init(AVCodecContext *avctx)
         return ret;
     s->psypp = ff_psy_preprocess_init(avctx);
     ff_lpc_init(&s->lpc, 2*avctx->frame_size, TNS_MAX_ORDER, FF_LPC_TYPE_LEVINSON);
-    s->random_state = 0x1f2e3d4c;
 
-    s->abs_pow34   = abs_pow34_v;
-    s->quant_bands = quantize_bands;
-
-    if (ARCH_X86)
-        ff_aac_dsp_init_x86(s);
+    ff_aac_dsp_init(s);
 
     if (HAVE_MIPSDSP)
         ff_aac_coder_init_mips(s);
@@ -1101,7 +1241,7 @@ static av_cold int aac_encode_init(AVCodecContext *avctx)
     ff_af_queue_init(avctx, &s->afq);
     ff_aac_tableinit();
 
-    return 0;
+    return alloc_thread_contexts(avctx, s);
 }
 
 #define AACENC_FLAGS AV_OPT_FLAG_ENCODING_PARAM | AV_OPT_FLAG_AUDIO_PARAM
@@ -1145,7 +1285,8 @@ const AVCodec ff_aac_encoder = {
     .defaults       = aac_encode_defaults,
     .supported_samplerates = ff_mpeg4audio_sample_rates,
     .caps_internal  = FF_CODEC_CAP_INIT_THREADSAFE | FF_CODEC_CAP_INIT_CLEANUP,
-    .capabilities   = AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_DELAY,
+    .capabilities   = AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_DELAY |
+                      AV_CODEC_CAP_SLICE_THREADS,
     .sample_fmts    = (const enum AVSampleFormat[]){ AV_SAMPLE_FMT_FLTP,
                                                      AV_SAMPLE_FMT_NONE },
     .priv_class     = &aacenc_class,
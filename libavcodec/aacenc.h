@@ -373,6 +373,21 @@ static const AACPCEInfo aac_pce_configs[] = {
     },
 };
 
+/**
+ * Channel element coded in one rate control iteration. Elements are coded
+ * into their own buffer and concatenated into the frame in order.
+ */
+typedef struct AACEncElement {
+    int start_ch;                                ///< first channel of the element
+    int instance;                                ///< element instance tag
+    int bitres_alloc;                            ///< psy bit allocation per channel
+    int cutoff;                                  ///< psy cutoff after quantizer search
+    int ms_mode, is_mode, tns_mode, pred_mode;   ///< coding tools used
+    uint8_t *buf;                                ///< element bitstream
+    int buf_size;
+    int bits;                                    ///< number of bits written to buf
+} AACEncElement;
+
 /**
  * AAC encoder context
  */
@@ -399,13 +414,17 @@ typedef struct AACEncContext {
     struct FFPsyPreprocessContext* psypp;
     const AACCoefficientsEncoder *coder;
     int cur_channel;                             ///< current channel for coder context
-    int random_state;
     float lambda;
     int last_frame_pb_count;                     ///< number of bits for the previous frame
     float lambda_sum;                            ///< sum(lambda), for Qvg reporting
     int lambda_count;                            ///< count(lambda), for Qvg reporting
     enum RawDataBlockType cur_type;              ///< channel group type cur_channel belongs to
 
+    AACEncElement *elements;                     ///< channel elements of the current frame
+    FFPsyWindowInfo windows[PSY_MAX_CHANS];      ///< window decisions of the current frame
+    struct AACEncContext **thread_ctx;           ///< coder contexts of the worker threads
+    int nb_threads;                              ///< number of separately allocated thread_ctx
+
     AudioFrameQueue afq;
     DECLARE_ALIGNED(16, int,   qcoefs)[96];      ///< quantized coefficients
     DECLARE_ALIGNED(32, float, scoefs)[1024];    ///< scaled coefficients
@@ -423,6 +442,8 @@ typedef struct AACEncContext {
     } buffer;
 } AACEncContext;
 
+void ff_aac_dsp_init(AACEncContext *s);
+void ff_aac_dsp_init_aarch64(AACEncContext *s);
 void ff_aac_dsp_init_x86(AACEncContext *s);
 void ff_aac_coder_init_mips(AACEncContext *c);
 void ff_quantize_band_cost_cache_init(struct AACEncContext *s);
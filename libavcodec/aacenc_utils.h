@@ -32,6 +32,7 @@
 #include "aac.h"
 #include "aacenctab.h"
 #include "aactab.h"
+#include "psymodel.h"
 
 #define ROUND_STANDARD 0.4054f
 #define ROUND_TO_ZERO 0.1054f
@@ -196,6 +197,28 @@ static av_always_inline float bval2bmax(float b)
  * map to valid, nonzero bands of the form w*16+g (with w being the initial
  * window of the window group, only) are left indetermined.
  */
+/**
+ * Bandwidth the twoloop quantizer search limits the spectrum to when no
+ * cutoff is set. The constant quality mode scales the bit rate by lambda.
+ * Coding tools that increase the efficiency raise it by 15%.
+ */
+static inline int twoloop_bandwidth(const AVCodecContext *avctx, float lambda,
+                                    int efficient)
+{
+    int refbits = avctx->bit_rate * 1024.0 / avctx->sample_rate
+        / ((avctx->flags & AV_CODEC_FLAG_QSCALE) ? 2.0f : avctx->channels)
+        * (lambda / 120.f);
+    float rate_bandwidth_multiplier = 1.5f;
+    int frame_bit_rate = (avctx->flags & AV_CODEC_FLAG_QSCALE)
+        ? (refbits * rate_bandwidth_multiplier * avctx->sample_rate / 1024)
+        : (avctx->bit_rate / avctx->channels);
+
+    if (efficient)
+        frame_bit_rate *= 1.15f;
+
+    return FFMAX(3000, AAC_CUTOFF_FROM_BITRATE(frame_bit_rate, 1, avctx->sample_rate));
+}
+
 static inline void ff_init_nextband_map(const SingleChannelElement *sce, uint8_t *nextband)
 {
     unsigned char prevband = 0;
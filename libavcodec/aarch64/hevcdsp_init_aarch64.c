@@ -53,15 +53,106 @@ void ff_hevc_idct_4x4_dc_10_neon(int16_t *coeffs);
 void ff_hevc_idct_8x8_dc_10_neon(int16_t *coeffs);
 void ff_hevc_idct_16x16_dc_10_neon(int16_t *coeffs);
 void ff_hevc_idct_32x32_dc_10_neon(int16_t *coeffs);
-void ff_hevc_sao_band_filter_8x8_8_neon(uint8_t *_dst, uint8_t *_src,
-                                  ptrdiff_t stride_dst, ptrdiff_t stride_src,
-                                  int16_t *sao_offset_val, int sao_left_class,
-                                  int width, int height);
+void ff_hevc_sao_band_filter_8_neon(uint8_t *_dst, uint8_t *_src,
+                                    ptrdiff_t stride_dst, ptrdiff_t stride_src,
+                                    int16_t *sao_offset_val, int sao_left_class,
+                                    int width, int height);
+void ff_hevc_sao_band_filter_10_neon(uint8_t *_dst, uint8_t *_src,
+                                     ptrdiff_t stride_dst, ptrdiff_t stride_src,
+                                     int16_t *sao_offset_val, int sao_left_class,
+                                     int width, int height);
+void ff_hevc_sao_edge_filter_8_neon(uint8_t *_dst, uint8_t *_src, ptrdiff_t stride_dst,
+                                    int16_t *sao_offset_val, int eo, int width, int height);
+void ff_hevc_sao_edge_filter_10_neon(uint8_t *_dst, uint8_t *_src, ptrdiff_t stride_dst,
+                                     int16_t *sao_offset_val, int eo, int width, int height);
 
+#define NEON_DEBLOCK_FUNCS(bd)                                                          \
+void ff_hevc_h_loop_filter_luma_ ## bd ## _neon(uint8_t *pix, ptrdiff_t stride,         \
+        int beta, int32_t *tc, uint8_t *no_p, uint8_t *no_q);                           \
+void ff_hevc_v_loop_filter_luma_ ## bd ## _neon(uint8_t *pix, ptrdiff_t stride,         \
+        int beta, int32_t *tc, uint8_t *no_p, uint8_t *no_q);                           \
+void ff_hevc_h_loop_filter_chroma_ ## bd ## _neon(uint8_t *pix, ptrdiff_t stride,       \
+        int32_t *tc, uint8_t *no_p, uint8_t *no_q);                                     \
+void ff_hevc_v_loop_filter_chroma_ ## bd ## _neon(uint8_t *pix, ptrdiff_t stride,       \
+        int32_t *tc, uint8_t *no_p, uint8_t *no_q)
 
+NEON_DEBLOCK_FUNCS(8);
+NEON_DEBLOCK_FUNCS(10);
+
+#define NEON_MC_FUNCS(pel, dir, bd)                                                     \
+void ff_hevc_put_hevc_ ## pel ## _ ## dir ## _ ## bd ## _neon(int16_t *dst,             \
+        uint8_t *src, ptrdiff_t srcstride,                                              \
+        int height, intptr_t mx, intptr_t my, int width);                               \
+void ff_hevc_put_hevc_ ## pel ## _uni_ ## dir ## _ ## bd ## _neon(uint8_t *dst,         \
+        ptrdiff_t dststride, uint8_t *src, ptrdiff_t srcstride,                         \
+        int height, intptr_t mx, intptr_t my, int width);                               \
+void ff_hevc_put_hevc_ ## pel ## _uni_w_ ## dir ## _ ## bd ## _neon(uint8_t *dst,       \
+        ptrdiff_t dststride, uint8_t *src, ptrdiff_t srcstride,                         \
+        int height, int denom, int wx, int ox,                                          \
+        intptr_t mx, intptr_t my, int width);                                           \
+void ff_hevc_put_hevc_ ## pel ## _bi_ ## dir ## _ ## bd ## _neon(uint8_t *dst,          \
+        ptrdiff_t dststride, uint8_t *src, ptrdiff_t srcstride, int16_t *src2,          \
+        int height, intptr_t mx, intptr_t my, int width);                               \
+void ff_hevc_put_hevc_ ## pel ## _bi_w_ ## dir ## _ ## bd ## _neon(uint8_t *dst,        \
+        ptrdiff_t dststride, uint8_t *src, ptrdiff_t srcstride, int16_t *src2,          \
+        int height, int denom, int wx0, int wx1, int ox0, int ox1,                      \
+        intptr_t mx, intptr_t my, int width)
+
+#define NEON_MC_ALL_FUNCS(bd)           \
+    NEON_MC_FUNCS(pel,  pixels, bd);    \
+    NEON_MC_FUNCS(qpel, h,      bd);    \
+    NEON_MC_FUNCS(qpel, v,      bd);    \
+    NEON_MC_FUNCS(qpel, hv,     bd);    \
+    NEON_MC_FUNCS(epel, h,      bd);    \
+    NEON_MC_FUNCS(epel, v,      bd);    \
+    NEON_MC_FUNCS(epel, hv,     bd)
+
+NEON_MC_ALL_FUNCS(8);
+NEON_MC_ALL_FUNCS(10);
+
+/* The MC functions handle any width that is a multiple of 4; widths 2 and 6
+ * (size index 0 and 2, chroma only) are left to the C code. */
+#define NEON_MC_ASSIGN(member, v, h, fn)                            \
+    for (i = 1; i < 10; i++)                                        \
+        if (i != 2)                                                 \
+            c->member[i][v][h] = fn
+
+#define NEON_MC(pel, type, v, h, dir, bd)                                           \
+    NEON_MC_ASSIGN(put_hevc_ ## pel, v, h,                                          \
+                   ff_hevc_put_hevc_ ## type ## _ ## dir ## _ ## bd ## _neon);      \
+    NEON_MC_ASSIGN(put_hevc_ ## pel ## _uni, v, h,                                  \
+                   ff_hevc_put_hevc_ ## type ## _uni_ ## dir ## _ ## bd ## _neon);  \
+    NEON_MC_ASSIGN(put_hevc_ ## pel ## _uni_w, v, h,                                \
+                   ff_hevc_put_hevc_ ## type ## _uni_w_ ## dir ## _ ## bd ## _neon);\
+    NEON_MC_ASSIGN(put_hevc_ ## pel ## _bi, v, h,                                   \
+                   ff_hevc_put_hevc_ ## type ## _bi_ ## dir ## _ ## bd ## _neon);   \
+    NEON_MC_ASSIGN(put_hevc_ ## pel ## _bi_w, v, h,                                 \
+                   ff_hevc_put_hevc_ ## type ## _bi_w_ ## dir ## _ ## bd ## _neon)
+
+#define NEON_MC_ALL(bd)                         \
+    NEON_MC(qpel, pel,  0, 0, pixels, bd);      \
+    NEON_MC(qpel, qpel, 0, 1, h,      bd);      \
+    NEON_MC(qpel, qpel, 1, 0, v,      bd);      \
+    NEON_MC(qpel, qpel, 1, 1, hv,     bd);      \
+    NEON_MC(epel, pel,  0, 0, pixels, bd);      \
+    NEON_MC(epel, epel, 0, 1, h,      bd);      \
+    NEON_MC(epel, epel, 1, 0, v,      bd);      \
+    NEON_MC(epel, epel, 1, 1, hv,     bd)
+
+#define NEON_DEBLOCK_SAO(bd)                                                    \
+    c->hevc_h_loop_filter_luma     = ff_hevc_h_loop_filter_luma_ ## bd ## _neon;    \
+    c->hevc_v_loop_filter_luma     = ff_hevc_v_loop_filter_luma_ ## bd ## _neon;    \
+    c->hevc_h_loop_filter_chroma   = ff_hevc_h_loop_filter_chroma_ ## bd ## _neon;  \
+    c->hevc_v_loop_filter_chroma   = ff_hevc_v_loop_filter_chroma_ ## bd ## _neon;  \
+    for (i = 0; i < 5; i++) {                                                       \
+        c->sao_band_filter[i]      = ff_hevc_sao_band_filter_ ## bd ## _neon;       \
+        c->sao_edge_filter[i]      = ff_hevc_sao_edge_filter_ ## bd ## _neon;       \
+    }
 
 av_cold void ff_hevc_dsp_init_aarch64(HEVCDSPContext *c, const int bit_depth)
 {
+    int i;
+
     if (!have_neon(av_get_cpu_flags())) return;
 
     if (bit_depth == 8) {
@@ -75,11 +166,8 @@ av_cold void ff_hevc_dsp_init_aarch64(HEVCDSPContext *c, const int bit_depth)
         c->idct_dc[1]                  = ff_hevc_idct_8x8_dc_8_neon;
         c->idct_dc[2]                  = ff_hevc_idct_16x16_dc_8_neon;
         c->idct_dc[3]                  = ff_hevc_idct_32x32_dc_8_neon;
-        // This function is disabled, as it doesn't handle widths that aren't
-        // an even multiple of 8 correctly. fate-hevc doesn't exercise that
-        // for the current size, but if enabled for bigger sizes, the cases
-        // of non-multiple of 8 seem to arise.
-//        c->sao_band_filter[0]          = ff_hevc_sao_band_filter_8x8_8_neon;
+        NEON_DEBLOCK_SAO(8);
+        NEON_MC_ALL(8);
     }
     if (bit_depth == 10) {
         c->add_residual[0]             = ff_hevc_add_residual_4x4_10_neon;
@@ -92,5 +180,7 @@ av_cold void ff_hevc_dsp_init_aarch64(HEVCDSPContext *c, const int bit_depth)
         c->idct_dc[1]                  = ff_hevc_idct_8x8_dc_10_neon;
         c->idct_dc[2]                  = ff_hevc_idct_16x16_dc_10_neon;
         c->idct_dc[3]                  = ff_hevc_idct_32x32_dc_10_neon;
+        NEON_DEBLOCK_SAO(10);
+        NEON_MC_ALL(10);
     }
 }
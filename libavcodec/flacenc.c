@@ -102,6 +102,18 @@ typedef struct FlacFrame {
     int verbatim_only;
 } FlacFrame;
 
+/**
+ * Input frame queued for frame-parallel encoding, and its encoded output.
+ */
+typedef struct FlacThreadSlot {
+    AVFrame *frame;
+    uint32_t frame_count;
+    int max_framesize;
+    uint8_t *buf;
+    unsigned int buf_size;
+    int size;
+} FlacThreadSlot;
+
 typedef struct FlacEncodeContext {
     AVClass *class;
     PutBitContext pb;
@@ -116,7 +128,6 @@ typedef struct FlacEncodeContext {
     uint32_t frame_count;
     uint64_t sample_count;
     uint8_t md5sum[16];
-    FlacFrame frame;
     CompressionOptions options;
     AVCodecContext *avctx;
     LPCContext lpc_ctx;
@@ -128,6 +139,17 @@ typedef struct FlacEncodeContext {
 
     int flushed;
     int64_t next_pts;
+
+    int nb_threads;
+    struct FlacEncodeContext **thread_ctx; ///< per-thread copies of this context
+    FlacThreadSlot *slots;                 ///< ring of nb_threads queued frames
+    int slot_head;                         ///< oldest queued frame
+    int nb_encoded;                        ///< encoded frames waiting for output
+    int nb_pending;                        ///< frames waiting to be encoded
+
+    /* The frame must be the last member: worker contexts copy everything
+     * before it and use their own frame buffer. */
+    FlacFrame frame;
 } FlacEncodeContext;
 
 
@@ -238,6 +260,50 @@ static av_cold void dprint_compression_options(FlacEncodeContext *s)
 }
 
 
+/**
+ * Set up frame-parallel encoding: FLAC frames only depend on their own
+ * samples and frame number, so up to thread_count frames are buffered and
+ * encoded at once by worker copies of the context.
+ */
+static av_cold int init_threads(AVCodecContext *avctx)
+{
+    FlacEncodeContext *s = avctx->priv_data;
+    int i, ret;
+
+    s->nb_threads = avctx->thread_count;
+    s->thread_ctx = av_calloc(s->nb_threads, sizeof(*s->thread_ctx));
+    s->slots      = av_calloc(s->nb_threads, sizeof(*s->slots));
+    if (!s->thread_ctx || !s->slots)
+        return AVERROR(ENOMEM);
+
+    for (i = 0; i < s->nb_threads; i++) {
+        FlacEncodeContext *t;
+
+        s->slots[i].frame = av_frame_alloc();
+        if (!s->slots[i].frame)
+            return AVERROR(ENOMEM);
+
+        t = s->thread_ctx[i] = av_mallocz(sizeof(*t));
+        if (!t)
+            return AVERROR(ENOMEM);
+        memcpy(t, s, offsetof(FlacEncodeContext, frame));
+        t->md5ctx          = NULL;
+        t->md5_buffer      = NULL;
+        t->md5_buffer_size = 0;
+        t->nb_threads      = 0;
+        t->thread_ctx      = NULL;
+        t->slots           = NULL;
+        memset(&t->lpc_ctx, 0, sizeof(t->lpc_ctx));
+        ret = ff_lpc_init(&t->lpc_ctx, avctx->frame_size,
+                          s->options.max_prediction_order, FF_LPC_TYPE_LEVINSON);
+        if (ret < 0)
+            return ret;
+    }
+
+    return 0;
+}
+
+
 static av_cold int flac_encode_init(AVCodecContext *avctx)
 {
     int freq = avctx->sample_rate;
@@ -422,6 +488,8 @@ static av_cold int flac_encode_init(AVCodecContext *avctx)
 
     ret = ff_lpc_init(&s->lpc_ctx, avctx->frame_size,
                       s->options.max_prediction_order, FF_LPC_TYPE_LEVINSON);
+    if (ret < 0)
+        return ret;
 
     ff_bswapdsp_init(&s->bdsp);
     ff_flacdsp_init(&s->flac_dsp, avctx->sample_fmt, channels,
@@ -429,7 +497,10 @@ static av_cold int flac_encode_init(AVCodecContext *avctx)
 
     dprint_compression_options(s);
 
-    return ret;
+    if (avctx->active_thread_type & FF_THREAD_SLICE && avctx->thread_count > 1)
+        return init_threads(avctx);
+
+    return 0;
 }
 
 
@@ -1276,9 +1347,9 @@ static void write_frame_footer(FlacEncodeContext *s)
 }
 
 
-static int write_frame(FlacEncodeContext *s, AVPacket *avpkt)
+static int write_frame(FlacEncodeContext *s, uint8_t *buf, int buf_size)
 {
-    init_put_bits(&s->pb, avpkt->data, avpkt->size);
+    init_put_bits(&s->pb, buf, buf_size);
     write_frame_header(s);
     write_subframes(s);
     write_frame_footer(s);
@@ -1286,10 +1357,11 @@ static int write_frame(FlacEncodeContext *s, AVPacket *avpkt)
 }
 
 
-static int update_md5_sum(FlacEncodeContext *s, const void *samples)
+static int update_md5_sum(FlacEncodeContext *s, const void *samples,
+                          int nb_samples)
 {
     const uint8_t *buf;
-    int buf_size = s->frame.blocksize * s->channels *
+    int buf_size = nb_samples * s->channels *
                    ((s->avctx->bits_per_raw_sample + 7) / 8);
 
     if (s->avctx->bits_per_raw_sample > 16 || HAVE_BIGENDIAN) {
@@ -1310,7 +1382,7 @@ static int update_md5_sum(FlacEncodeContext *s, const void *samples)
         const int32_t *samples0 = samples;
         uint8_t *tmp            = s->md5_buffer;
 
-        for (i = 0; i < s->frame.blocksize * s->channels; i++) {
+        for (i = 0; i < nb_samples * s->channels; i++) {
             int32_t v = samples0[i] >> 8;
             AV_WL24(tmp + 3*i, v);
         }
@@ -1322,6 +1394,147 @@ static int update_md5_sum(FlacEncodeContext *s, const void *samples)
 }
 
 
+/**
+ * Encode one frame of samples into s->frame.
+ * @return the size of the encoded frame in bytes or a negative error code
+ */
+static int encode_samples(FlacEncodeContext *s, const AVFrame *frame)
+{
+    int frame_bytes;
+
+    init_frame(s, frame->nb_samples);
+
+    copy_samples(s, frame->data[0]);
+
+    channel_decorrelation(s);
+
+    remove_wasted_bits(s);
+
+    frame_bytes = encode_frame(s);
+
+    /* Fall back on verbatim mode if the compressed frame is larger than it
+       would be if encoded uncompressed. */
+    if (frame_bytes < 0 || frame_bytes > s->max_framesize) {
+        s->frame.verbatim_only = 1;
+        frame_bytes = encode_frame(s);
+        if (frame_bytes < 0) {
+            av_log(s->avctx, AV_LOG_ERROR, "Bad frame count\n");
+            return frame_bytes;
+        }
+    }
+
+    return frame_bytes;
+}
+
+
+static void update_frame_stats(AVCodecContext *avctx, AVPacket *avpkt,
+                               const AVFrame *frame, int out_bytes)
+{
+    FlacEncodeContext *s = avctx->priv_data;
+
+    if (out_bytes > s->max_encoded_framesize)
+        s->max_encoded_framesize = out_bytes;
+    if (out_bytes < s->min_framesize)
+        s->min_framesize = out_bytes;
+
+    avpkt->pts      = frame->pts;
+    avpkt->duration = ff_samples_to_time_base(avctx, frame->nb_samples);
+
+    s->next_pts = avpkt->pts + avpkt->duration;
+}
+
+
+static int encode_slot(AVCodecContext *avctx, void *arg, int jobnr, int threadnr)
+{
+    FlacEncodeContext *s = avctx->priv_data;
+    FlacEncodeContext *t = s->thread_ctx[threadnr];
+    FlacThreadSlot *slot = &s->slots[(s->slot_head + jobnr) % s->nb_threads];
+    int frame_bytes;
+
+    t->frame_count   = slot->frame_count;
+    t->max_framesize = slot->max_framesize;
+
+    frame_bytes = encode_samples(t, slot->frame);
+    if (frame_bytes < 0)
+        return slot->size = frame_bytes;
+
+    av_fast_malloc(&slot->buf, &slot->buf_size, frame_bytes);
+    if (!slot->buf)
+        return slot->size = AVERROR(ENOMEM);
+
+    slot->size = write_frame(t, slot->buf, frame_bytes);
+    return 0;
+}
+
+
+/**
+ * Frame-parallel variant of flac_encode_frame(). Input frames are numbered
+ * and hashed in order as they arrive, encoded nb_threads at a time and
+ * returned in order, one packet per call.
+ */
+static int encode_frame_threaded(AVCodecContext *avctx, AVPacket *avpkt,
+                                 const AVFrame *frame, int *got_packet_ptr)
+{
+    FlacEncodeContext *s = avctx->priv_data;
+    FlacThreadSlot *slot;
+    int i, ret;
+
+    if (frame) {
+        slot = &s->slots[(s->slot_head + s->nb_encoded + s->nb_pending) % s->nb_threads];
+
+        /* change max_framesize for small final frame */
+        if (frame->nb_samples < s->frame.blocksize) {
+            s->max_framesize = ff_flac_get_max_frame_size(frame->nb_samples,
+                                                          s->channels,
+                                                          avctx->bits_per_raw_sample);
+        }
+        s->frame.blocksize = frame->nb_samples;
+
+        if ((ret = av_frame_ref(slot->frame, frame)) < 0)
+            return ret;
+        slot->frame_count   = s->frame_count++;
+        slot->max_framesize = s->max_framesize;
+        s->sample_count    += frame->nb_samples;
+        s->nb_pending++;
+
+        if ((ret = update_md5_sum(s, frame->data[0], frame->nb_samples)) < 0) {
+            av_log(avctx, AV_LOG_ERROR, "Error updating MD5 checksum\n");
+            return ret;
+        }
+    }
+
+    if (!s->nb_encoded && s->nb_pending &&
+        (!frame || s->nb_pending == s->nb_threads)) {
+        avctx->execute2(avctx, encode_slot, NULL, NULL, s->nb_pending);
+        for (i = 0; i < s->nb_pending; i++) {
+            ret = s->slots[(s->slot_head + i) % s->nb_threads].size;
+            if (ret < 0)
+                return ret;
+        }
+        s->nb_encoded = s->nb_pending;
+        s->nb_pending = 0;
+    }
+
+    if (!s->nb_encoded)
+        return 0;
+
+    slot = &s->slots[s->slot_head];
+
+    if ((ret = ff_get_encode_buffer(avctx, avpkt, slot->size, 0)) < 0)
+        return ret;
+    memcpy(avpkt->data, slot->buf, slot->size);
+
+    update_frame_stats(avctx, avpkt, slot->frame, slot->size);
+    av_frame_unref(slot->frame);
+
+    s->slot_head = (s->slot_head + 1) % s->nb_threads;
+    s->nb_encoded--;
+
+    *got_packet_ptr = 1;
+    return 0;
+}
+
+
 static int flac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
                              const AVFrame *frame, int *got_packet_ptr)
 {
@@ -1330,6 +1543,9 @@ static int flac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
 
     s = avctx->priv_data;
 
+    if (s->nb_threads && (frame || s->nb_encoded || s->nb_pending))
+        return encode_frame_threaded(avctx, avpkt, frame, got_packet_ptr);
+
     /* when the last block is reached, update the header in extradata */
     if (!frame) {
         s->max_framesize = s->max_encoded_framesize;
@@ -1359,47 +1575,22 @@ static int flac_encode_frame(AVCodecContext *avctx, AVPacket *avpkt,
                                                       avctx->bits_per_raw_sample);
     }
 
-    init_frame(s, frame->nb_samples);
-
-    copy_samples(s, frame->data[0]);
-
-    channel_decorrelation(s);
-
-    remove_wasted_bits(s);
-
-    frame_bytes = encode_frame(s);
-
-    /* Fall back on verbatim mode if the compressed frame is larger than it
-       would be if encoded uncompressed. */
-    if (frame_bytes < 0 || frame_bytes > s->max_framesize) {
-        s->frame.verbatim_only = 1;
-        frame_bytes = encode_frame(s);
-        if (frame_bytes < 0) {
-            av_log(avctx, AV_LOG_ERROR, "Bad frame count\n");
-            return frame_bytes;
-        }
-    }
+    frame_bytes = encode_samples(s, frame);
+    if (frame_bytes < 0)
+        return frame_bytes;
 
     if ((ret = ff_get_encode_buffer(avctx, avpkt, frame_bytes, 0)) < 0)
         return ret;
 
-    out_bytes = write_frame(s, avpkt);
+    out_bytes = write_frame(s, avpkt->data, avpkt->size);
 
     s->frame_count++;
     s->sample_count += frame->nb_samples;
-    if ((ret = update_md5_sum(s, frame->data[0])) < 0) {
+    if ((ret = update_md5_sum(s, frame->data[0], frame->nb_samples)) < 0) {
         av_log(avctx, AV_LOG_ERROR, "Error updating MD5 checksum\n");
         return ret;
     }
-    if (out_bytes > s->max_encoded_framesize)
-        s->max_encoded_framesize = out_bytes;
-    if (out_bytes < s->min_framesize)
-        s->min_framesize = out_bytes;
-
-    avpkt->pts      = frame->pts;
-    avpkt->duration = ff_samples_to_time_base(avctx, frame->nb_samples);
-
-    s->next_pts = avpkt->pts + avpkt->duration;
+    update_frame_stats(avctx, avpkt, frame, out_bytes);
 
     av_shrink_packet(avpkt, out_bytes);
 
@@ -1412,6 +1603,21 @@ static av_cold int flac_encode_close(AVCodecContext *avctx)
 {
     FlacEncodeContext *s = avctx->priv_data;
 
+    int i;
+
+    for (i = 0; i < s->nb_threads; i++) {
+        if (s->thread_ctx && s->thread_ctx[i]) {
+            ff_lpc_end(&s->thread_ctx[i]->lpc_ctx);
+            av_freep(&s->thread_ctx[i]);
+        }
+        if (s->slots) {
+            av_frame_free(&s->slots[i].frame);
+            av_freep(&s->slots[i].buf);
+        }
+    }
+    av_freep(&s->thread_ctx);
+    av_freep(&s->slots);
+
     av_freep(&s->md5ctx);
     av_freep(&s->md5_buffer);
     ff_lpc_end(&s->lpc_ctx);
@@ -1463,7 +1669,7 @@ const AVCodec ff_flac_encoder = {
     .type           = AVMEDIA_TYPE_AUDIO,
     .id             = AV_CODEC_ID_FLAC,
     .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_DELAY |
-                      AV_CODEC_CAP_SMALL_LAST_FRAME,
+                      AV_CODEC_CAP_SMALL_LAST_FRAME | AV_CODEC_CAP_SLICE_THREADS,
     .priv_data_size = sizeof(FlacEncodeContext),
     .init           = flac_encode_init,
     .encode2        = flac_encode_frame,
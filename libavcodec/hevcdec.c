@@ -25,6 +25,7 @@
 
 #include "libavutil/attributes.h"
 #include "libavutil/common.h"
+#include "libavutil/cpu.h"
 #include "libavutil/display.h"
 #include "libavutil/film_grain_params.h"
 #include "libavutil/internal.h"
@@ -552,6 +553,31 @@ fail:
     return ret;
 }
 
+/* Free the row thread pool of a frame thread and the per row thread contexts. */
+static void hevc_wpp_uninit(HEVCContext *s)
+{
+    int i;
+
+    if (s->HEVClcList && s->sList) {
+        for (i = 1; i < s->threads_number; i++) {
+            av_freep(&s->HEVClcList[i]);
+            av_freep(&s->sList[i]);
+        }
+    }
+
+    if (s->wpp_thread) {
+        avpriv_slicethread_free(&s->wpp_thread);
+        for (i = 0; i < s->threads_number; i++) {
+            pthread_mutex_destroy(&s->wpp_progress_mutex[i]);
+            pthread_cond_destroy(&s->wpp_progress_cond[i]);
+        }
+    }
+    av_freep(&s->wpp_progress_mutex);
+    av_freep(&s->wpp_progress_cond);
+    av_freep(&s->wpp_entries);
+    s->wpp_nb_entries = 0;
+}
+
 static int hls_slice_header(HEVCContext *s)
 {
     GetBitContext *gb = &s->HEVClc->gb;
@@ -934,6 +960,7 @@ static int hls_slice_header(HEVCContext *s)
             }
             if (s->threads_number > 1 && (s->ps.pps->num_tile_rows > 1 || s->ps.pps->num_tile_columns > 1)) {
                 s->enable_parallel_tiles = 0; // TODO: you can enable tiles in parallel here
+                hevc_wpp_uninit(s);
                 s->threads_number = 1;
             } else
                 s->enable_parallel_tiles = 0;
@@ -2538,6 +2565,63 @@ static int hls_slice_data(HEVCContext *s)
     s->avctx->execute(s->avctx, hls_decode_entry, arg, ret , 1, sizeof(int));
     return ret[0];
 }
+
+static void hevc_wpp_report_progress(HEVCContext *s, int field, int thread, int n)
+{
+    if (!s->wpp_thread) {
+        ff_thread_report_progress2(s->avctx, field, thread, n);
+        return;
+    }
+
+    pthread_mutex_lock(&s->wpp_progress_mutex[thread]);
+    s->wpp_entries[field] += n;
+    pthread_cond_signal(&s->wpp_progress_cond[thread]);
+    pthread_mutex_unlock(&s->wpp_progress_mutex[thread]);
+}
+
+static void hevc_wpp_await_progress(HEVCContext *s, int field, int thread, int shift)
+{
+    if (!s->wpp_thread) {
+        ff_thread_await_progress2(s->avctx, field, thread, shift);
+        return;
+    }
+
+    if (!field)
+        return;
+
+    thread = thread ? thread - 1 : s->threads_number - 1;
+
+    pthread_mutex_lock(&s->wpp_progress_mutex[thread]);
+    while (s->wpp_entries[field - 1] - s->wpp_entries[field] < shift)
+        pthread_cond_wait(&s->wpp_progress_cond[thread], &s->wpp_progress_mutex[thread]);
+    pthread_mutex_unlock(&s->wpp_progress_mutex[thread]);
+}
+
+static int hevc_wpp_alloc_entries(HEVCContext *s, int count)
+{
+    if (!s->wpp_thread)
+        return ff_alloc_entries(s->avctx, count);
+
+    if (count > s->wpp_nb_entries) {
+        av_freep(&s->wpp_entries);
+        s->wpp_nb_entries = 0;
+        s->wpp_entries = av_calloc(count, sizeof(*s->wpp_entries));
+        if (!s->wpp_entries)
+            return AVERROR(ENOMEM);
+        s->wpp_nb_entries = count;
+    }
+    return 0;
+}
+
+static void hevc_wpp_reset_entries(HEVCContext *s)
+{
+    if (!s->wpp_thread) {
+        ff_reset_entries(s->avctx);
+        return;
+    }
+    memset(s->wpp_entries, 0, s->wpp_nb_entries * sizeof(*s->wpp_entries));
+}
+
 static int hls_decode_entry_wpp(AVCodecContext *avctxt, void *input_ctb_row, int job, int self_id)
 {
     HEVCContext *s1  = avctxt->priv_data, *s;
@@ -2567,10 +2651,10 @@ static int hls_decode_entry_wpp(AVCodecContext *avctxt, void *input_ctb_row, int
 
         hls_decode_neighbour(s, x_ctb, y_ctb, ctb_addr_ts);
 
-        ff_thread_await_progress2(s->avctx, ctb_row, thread, SHIFT_CTB_WPP);
+        hevc_wpp_await_progress(s, ctb_row, thread, SHIFT_CTB_WPP);
 
         if (atomic_load(&s1->wpp_err)) {
-            ff_thread_report_progress2(s->avctx, ctb_row , thread, SHIFT_CTB_WPP);
+            hevc_wpp_report_progress(s, ctb_row, thread, SHIFT_CTB_WPP);
             return 0;
         }
 
@@ -2588,18 +2672,18 @@ static int hls_decode_entry_wpp(AVCodecContext *avctxt, void *input_ctb_row, int
         ctb_addr_ts++;
 
         ff_hevc_save_states(s, ctb_addr_ts);
-        ff_thread_report_progress2(s->avctx, ctb_row, thread, 1);
+        hevc_wpp_report_progress(s, ctb_row, thread, 1);
         ff_hevc_hls_filters(s, x_ctb, y_ctb, ctb_size);
 
         if (!more_data && (x_ctb+ctb_size) < s->ps.sps->width && ctb_row != s->sh.num_entry_point_offsets) {
             atomic_store(&s1->wpp_err, 1);
-            ff_thread_report_progress2(s->avctx, ctb_row ,thread, SHIFT_CTB_WPP);
+            hevc_wpp_report_progress(s, ctb_row, thread, SHIFT_CTB_WPP);
             return 0;
         }
 
         if ((x_ctb+ctb_size) >= s->ps.sps->width && (y_ctb+ctb_size) >= s->ps.sps->height ) {
             ff_hevc_hls_filter(s, x_ctb, y_ctb, ctb_size);
-            ff_thread_report_progress2(s->avctx, ctb_row , thread, SHIFT_CTB_WPP);
+            hevc_wpp_report_progress(s, ctb_row, thread, SHIFT_CTB_WPP);
             return ctb_addr_ts;
         }
         ctb_addr_rs       = s->ps.pps->ctb_addr_ts_to_rs[ctb_addr_ts];
@@ -2609,16 +2693,23 @@ static int hls_decode_entry_wpp(AVCodecContext *avctxt, void *input_ctb_row, int
             break;
         }
     }
-    ff_thread_report_progress2(s->avctx, ctb_row ,thread, SHIFT_CTB_WPP);
+    hevc_wpp_report_progress(s, ctb_row, thread, SHIFT_CTB_WPP);
 
     return 0;
 error:
     s->tab_slice_address[ctb_addr_rs] = -1;
     atomic_store(&s1->wpp_err, 1);
-    ff_thread_report_progress2(s->avctx, ctb_row ,thread, SHIFT_CTB_WPP);
+    hevc_wpp_report_progress(s, ctb_row, thread, SHIFT_CTB_WPP);
     return ret;
 }
 
+static void hevc_wpp_worker(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
+{
+    HEVCContext *s = priv;
+
+    s->wpp_ret[jobnr] = hls_decode_entry_wpp(s->avctx, s->wpp_arg, jobnr, threadnr);
+}
+
 static int hls_slice_data_wpp(HEVCContext *s, const H2645NAL *nal)
 {
     const uint8_t *data = nal->data;
@@ -2645,7 +2736,9 @@ static int hls_slice_data_wpp(HEVCContext *s, const H2645NAL *nal)
         goto error;
     }
 
-    ff_alloc_entries(s->avctx, s->sh.num_entry_point_offsets + 1);
+    res = hevc_wpp_alloc_entries(s, s->sh.num_entry_point_offsets + 1);
+    if (res < 0)
+        goto error;
 
     for (i = 1; i < s->threads_number; i++) {
         if (s->sList[i] && s->HEVClcList[i])
@@ -2705,15 +2798,21 @@ static int hls_slice_data_wpp(HEVCContext *s, const H2645NAL *nal)
     }
 
     atomic_store(&s->wpp_err, 0);
-    ff_reset_entries(s->avctx);
+    hevc_wpp_reset_entries(s);
 
     for (i = 0; i <= s->sh.num_entry_point_offsets; i++) {
         arg[i] = i;
         ret[i] = 0;
     }
 
-    if (s->ps.pps->entropy_coding_sync_enabled_flag)
-        s->avctx->execute2(s->avctx, hls_decode_entry_wpp, arg, ret, s->sh.num_entry_point_offsets + 1);
+    if (s->ps.pps->entropy_coding_sync_enabled_flag) {
+        if (s->wpp_thread) {
+            s->wpp_arg = arg;
+            s->wpp_ret = ret;
+            avpriv_slicethread_execute(s->wpp_thread, s->sh.num_entry_point_offsets + 1, 0);
+        } else
+            s->avctx->execute2(s->avctx, hls_decode_entry_wpp, arg, ret, s->sh.num_entry_point_offsets + 1);
+    }
 
     for (i = 0; i <= s->sh.num_entry_point_offsets; i++)
         res += ret[i];
@@ -3605,12 +3704,7 @@ static av_cold int hevc_decode_free(AVCodecContext *avctx)
     av_freep(&s->sh.offset);
     av_freep(&s->sh.size);
 
-    if (s->HEVClcList && s->sList) {
-        for (i = 1; i < s->threads_number; i++) {
-            av_freep(&s->HEVClcList[i]);
-            av_freep(&s->sList[i]);
-        }
-    }
+    hevc_wpp_uninit(s);
     av_freep(&s->HEVClc);
     av_freep(&s->HEVClcList);
     av_freep(&s->sList);
@@ -3734,7 +3828,7 @@ static int hevc_update_thread_context(AVCodecContext *dst,
     s->is_nalff        = s0->is_nalff;
     s->nal_length_size = s0->nal_length_size;
 
-    s->threads_number      = s0->threads_number;
+    // threads_number is not copied, each frame thread has its own row threads
     s->threads_type        = s0->threads_type;
 
     if (s0->eos) {
@@ -3791,6 +3885,35 @@ static int hevc_update_thread_context(AVCodecContext *dst,
 }
 #endif
 
+static av_cold int hevc_wpp_init(HEVCContext *s)
+{
+    int i, nb_threads;
+
+    nb_threads = avpriv_slicethread_create(&s->wpp_thread, s, hevc_wpp_worker,
+                                           NULL, s->threads_number);
+    if (nb_threads <= 1) {
+        // run the rows in the frame thread as before
+        avpriv_slicethread_free(&s->wpp_thread);
+        s->threads_number = 1;
+        return 0;
+    }
+
+    s->wpp_progress_mutex = av_malloc_array(s->threads_number, sizeof(*s->wpp_progress_mutex));
+    s->wpp_progress_cond  = av_malloc_array(s->threads_number, sizeof(*s->wpp_progress_cond));
+    if (!s->wpp_progress_mutex || !s->wpp_progress_cond) {
+        avpriv_slicethread_free(&s->wpp_thread);
+        return AVERROR(ENOMEM);
+    }
+    for (i = 0; i < s->threads_number; i++) {
+        pthread_mutex_init(&s->wpp_progress_mutex[i], NULL);
+        pthread_cond_init(&s->wpp_progress_cond[i], NULL);
+    }
+
+    av_log(s->avctx, AV_LOG_DEBUG, "Using %d threads for WPP rows\n", nb_threads);
+
+    return 0;
+}
+
 static av_cold int hevc_decode_init(AVCodecContext *avctx)
 {
     HEVCContext *s = avctx->priv_data;
@@ -3806,10 +3929,28 @@ static av_cold int hevc_decode_init(AVCodecContext *avctx)
     else
         s->threads_type = FF_THREAD_SLICE;
 
+    if (s->threads_type == FF_THREAD_FRAME) {
+        int wpp_threads = s->wpp_threads;
+        // By default, use the cores left idle by the frame threads, but at
+        // least two row threads. Frame threads spend much of their time
+        // waiting for their references, which the row threads of the other
+        // frames can use, so with the default of one frame thread per core
+        // WPP streams would otherwise be decoded a row at a time.
+        if (!wpp_threads)
+            wpp_threads = FFMAX(av_cpu_count() / avctx->thread_count, 2);
+        s->threads_number = FFMIN(wpp_threads, HEVC_MAX_WPP_THREADS);
+    }
+
     ret = hevc_init_context(avctx);
     if (ret < 0)
         return ret;
 
+    if (s->threads_type == FF_THREAD_FRAME && s->threads_number > 1) {
+        ret = hevc_wpp_init(s);
+        if (ret < 0)
+            return ret;
+    }
+
     s->enable_parallel_tiles = 0;
     s->sei.picture_timing.picture_struct = 0;
     s->eos = 1;
@@ -3847,6 +3988,8 @@ static const AVOption options[] = {
         AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, PAR },
     { "strict-displaywin", "stricly apply default display window size", OFFSET(apply_defdispwin),
         AV_OPT_TYPE_BOOL, {.i64 = 0}, 0, 1, PAR },
+    { "wpp_threads", "Number of threads decoding the CTB rows of WPP slices in each frame thread (0 = auto, the cores left idle by the frame threads, at least 2)",
+        OFFSET(wpp_threads), AV_OPT_TYPE_INT, {.i64 = 0}, 0, HEVC_MAX_WPP_THREADS, PAR },
     { NULL },
 };
 
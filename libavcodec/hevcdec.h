@@ -27,6 +27,8 @@
 
 #include "libavutil/buffer.h"
 #include "libavutil/mem_internal.h"
+#include "libavutil/slicethread.h"
+#include "libavutil/thread.h"
 
 #include "avcodec.h"
 #include "bswapdsp.h"
@@ -44,6 +46,7 @@
 #include "videodsp.h"
 
 #define SHIFT_CTB_WPP 2
+#define HEVC_MAX_WPP_THREADS 16
 
 #define MAX_TB_SIZE 32
 #define MAX_QP 51
@@ -557,6 +560,20 @@ typedef struct HEVCContext {
     int enable_parallel_tiles;
     atomic_int wpp_err;
 
+    /**
+     * CTB row jobs of WPP slices when frame threading is active. Slice
+     * threading is not available then, so each frame thread runs the rows
+     * of its own frame on this pool and tracks their progress itself.
+     */
+    AVSliceThread   *wpp_thread;
+    int              wpp_threads;       ///< requested number of row threads, 0 = auto
+    int             *wpp_entries;
+    int              wpp_nb_entries;
+    pthread_mutex_t *wpp_progress_mutex;
+    pthread_cond_t  *wpp_progress_cond;
+    int             *wpp_arg;
+    int             *wpp_ret;
+
     const uint8_t *data;
 
     H2645Packet pkt;
@@ -183,6 +183,9 @@ double ff_lpc_calc_ref_coefs_f(LPCContext *s, const float *samples, int len,
         s->windowed_samples[i] = weight*samples[i];
         s->windowed_samples[len-1-i] = weight*samples[len-1-i];
     }
+    /* autocorr reads past the end, clear what an earlier longer call left */
+    s->windowed_samples[len]   = 0.0;
+    s->windowed_samples[len+1] = 0.0;
 
     s->lpc_compute_autocorr(s->windowed_samples, len, order, autoc);
     signal = autoc[0];
@@ -314,6 +317,8 @@ av_cold int ff_lpc_init(LPCContext *s, int blocksize, int max_order,
     s->lpc_apply_welch_window = lpc_apply_welch_window_c;
     s->lpc_compute_autocorr   = lpc_compute_autocorr_c;
 
+    if (ARCH_AARCH64)
+        ff_lpc_init_aarch64(s);
     if (ARCH_X86)
         ff_lpc_init_x86(s);
 
@@ -70,7 +70,7 @@ typedef struct LPCContext {
      * Perform autocorrelation on input samples with delay of 0 to lag.
      * @param data  input samples.
      *              constraints: no alignment needed, but must have at
-     *              least lag*sizeof(double) valid bytes preceding it, and
+     *              least lag*sizeof(double) zeroed bytes preceding it, and
      *              size must be at least (len+1)*sizeof(double) if data is
      *              16-byte aligned or (len+2)*sizeof(double) if data is
      *              unaligned.
@@ -108,6 +108,7 @@ double ff_lpc_calc_ref_coefs_f(LPCContext *s, const float *samples, int len,
  */
 int ff_lpc_init(LPCContext *s, int blocksize, int max_order,
                 enum FFLPCType lpc_type);
+void ff_lpc_init_aarch64(LPCContext *s);
 void ff_lpc_init_x86(LPCContext *s);
 
 /**
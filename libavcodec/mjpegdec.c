@@ -47,12 +47,91 @@
 #include "jpeglsdec.h"
 #include "profiles.h"
 #include "put_bits.h"
+#include "thread.h"
 #include "tiff.h"
 #include "exif.h"
 #include "bytestream.h"
 #include "tiff_common.h"
 
 
+/**
+ * Build the table used by decode_block() to decode two consecutive entries
+ * of the fast table with a single lookup.
+ */
+static void build_ac_pair_table(MJpegDecodeContext *s, int index)
+{
+    const int16_t *fast = s->ac_fast[index];
+    uint32_t *pair = s->ac_pair[index];
+    int v;
+
+    for (v = 0; v < 1 << AC_PAIR_BITS; v++) {
+        int first = fast[v >> (AC_PAIR_BITS - AC_FAST_BITS)];
+        int left  = AC_PAIR_BITS - (first & 0xf);
+        int rest  = v & ((1 << left) - 1);
+        int second;
+
+        pair[v] = 0;
+        /* the first code can not be EOB */
+        if (!(first >> 8))
+            continue;
+        second = fast[left >= AC_FAST_BITS ? rest >> (left - AC_FAST_BITS) :
+                                             rest << (AC_FAST_BITS - left)];
+        if (!second || (second & 0xf) > left)
+            continue;
+        pair[v] = (uint32_t)(second & 0xfff0) << 12 | (first & 0xfff0) |
+                  ((first & 0xf) + (second & 0xf));
+    }
+}
+
+/**
+ * Build the table used by decode_block() to decode a sequential AC code and
+ * the coefficient bits that follow it with a single lookup.
+ */
+static void build_ac_fast_table(MJpegDecodeContext *s, int index)
+{
+    const uint8_t *lengths = s->raw_huffman_lengths[1][index];
+    const uint8_t *values  = s->raw_huffman_values[1][index];
+    int16_t *fast = s->ac_fast[index];
+    unsigned code = 0;
+    int len, i, k = 0;
+
+    memset(s->ac_fast[index], 0, sizeof(s->ac_fast[index]));
+    for (len = 1; len <= AC_FAST_BITS; len++) {
+        for (i = 0; i < lengths[len - 1]; i++, k++, code++) {
+            int run  = values[k] >> 4;
+            int size = values[k] & 0xf;
+            int free = AC_FAST_BITS - len - size;
+            int v, j;
+
+            if (code >= 1U << len) {
+                /* overfull table, leave everything to the VLC reader */
+                memset(s->ac_fast[index], 0, sizeof(s->ac_fast[index]));
+                memset(s->ac_pair[index], 0, sizeof(s->ac_pair[index]));
+                return;
+            }
+            if (free < 0 || (!size && run))
+                continue;
+            if (!size) { /* EOB */
+                for (j = 0; j < 1 << free; j++)
+                    fast[(code << free) + j] = len;
+                continue;
+            }
+            for (v = 0; v < 1 << size; v++) {
+                int level = v < 1 << (size - 1) ? v - (1 << size) + 1 : v;
+                int base  = (code << size | v) << free;
+
+                if (level < -128 || level > 127)
+                    continue;
+                for (j = 0; j < 1 << free; j++)
+                    fast[base + j] = level * 256 + run * 16 + len + size;
+            }
+        }
+        code <<= 1;
+    }
+
+    build_ac_pair_table(s, index);
+}
+
 static int init_default_huffman_tables(MJpegDecodeContext *s)
 {
     static const struct {
@@ -90,6 +169,8 @@ static int init_default_huffman_tables(MJpegDecodeContext *s)
                    ht[i].bits + 1, 16);
             memcpy(s->raw_huffman_values[ht[i].class][ht[i].index],
                    ht[i].values, ht[i].length);
+            if (ht[i].class == 1)
+                build_ac_fast_table(s, ht[i].index);
         }
     }
 
@@ -292,6 +373,8 @@ int ff_mjpeg_decode_dht(MJpegDecodeContext *s)
             s->raw_huffman_lengths[class][index][i] = bits_table[i + 1];
         for (i = 0; i < 256; i++)
             s->raw_huffman_values[class][index][i] = val_table[i];
+        if (class > 0)
+            build_ac_fast_table(s, index);
     }
     return 0;
 }
@@ -710,7 +793,7 @@ int ff_mjpeg_decode_sof(MJpegDecodeContext *s)
                 s->avctx->pix_fmt,
                 AV_PIX_FMT_NONE,
             };
-            s->hwaccel_pix_fmt = ff_get_format(s->avctx, pix_fmts);
+            s->hwaccel_pix_fmt = ff_thread_get_format(s->avctx, pix_fmts);
             if (s->hwaccel_pix_fmt < 0)
                 return AVERROR(EINVAL);
 
@@ -726,7 +809,7 @@ int ff_mjpeg_decode_sof(MJpegDecodeContext *s)
         }
 
         av_frame_unref(s->picture_ptr);
-        if (ff_get_buffer(s->avctx, s->picture_ptr, AV_GET_BUFFER_FLAG_REF) < 0)
+        if (ff_thread_get_buffer(s->avctx, s->picture_ptr, AV_GET_BUFFER_FLAG_REF) < 0)
             return -1;
         s->picture_ptr->pict_type = AV_PICTURE_TYPE_I;
         s->picture_ptr->key_frame = 1;
@@ -823,6 +906,42 @@ static int decode_block(MJpegDecodeContext *s, int16_t *block, int component,
     {OPEN_READER(re, &s->gb);
     do {
         UPDATE_CACHE(re, &s->gb);
+        code = s->ac_pair[ac_index][SHOW_UBITS(re, &s->gb, AC_PAIR_BITS)];
+        /* unless the first code ends the block: the next one is not part of it */
+        if (code && i + ((code >> 4) & 0xf) + 1 < 63) {
+            /* two short codes and their coefficient bits in one lookup */
+            SKIP_BITS(re, &s->gb, code & 0xf);
+            i += ((code >> 4) & 0xf) + 1;
+            j        = s->scantable.permutated[i];
+            block[j] = (int8_t)(code >> 8) * quant_matrix[i];
+            level = (int8_t)(code >> 20);
+            if (!level)
+                break;
+            i += ((code >> 16) & 0xf) + 1;
+            if (i > 63) {
+                av_log(s->avctx, AV_LOG_ERROR, "error count: %d\n", i);
+                return AVERROR_INVALIDDATA;
+            }
+            j        = s->scantable.permutated[i];
+            block[j] = level * quant_matrix[i];
+            continue;
+        }
+        code = s->ac_fast[ac_index][SHOW_UBITS(re, &s->gb, AC_FAST_BITS)];
+        if (code) {
+            /* short code and coefficient bits in one lookup */
+            SKIP_BITS(re, &s->gb, code & 0xf);
+            level = code >> 8;
+            if (!level)
+                break;
+            i += ((code >> 4) & 0xf) + 1;
+            if (i > 63) {
+                av_log(s->avctx, AV_LOG_ERROR, "error count: %d\n", i);
+                return AVERROR_INVALIDDATA;
+            }
+            j        = s->scantable.permutated[i];
+            block[j] = level * quant_matrix[i];
+            continue;
+        }
         GET_VLC(code, re, &s->gb, s->vlcs[1][ac_index].table, 9, 2);
 
         i += ((unsigned)code) >> 4;
@@ -1420,12 +1539,13 @@ static void shift_output(MJpegDecodeContext *s, uint8_t *ptr, int linesize)
     }
 }
 
-static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
-                             int Al, const uint8_t *mb_bitmask,
-                             int mb_bitmask_size,
-                             const AVFrame *reference)
+static int mjpeg_decode_scan_mcus(MJpegDecodeContext *s, int nb_components, int Ah,
+                                  int Al, const uint8_t *mb_bitmask,
+                                  int mb_bitmask_size,
+                                  const AVFrame *reference,
+                                  int mcu_start, int mcu_end)
 {
-    int i, mb_x, mb_y, chroma_h_shift, chroma_v_shift, chroma_width, chroma_height;
+    int i, mcu, mb_x, mb_y, chroma_h_shift, chroma_v_shift, chroma_width, chroma_height;
     uint8_t *data[MAX_COMPONENTS];
     const uint8_t *reference_data[MAX_COMPONENTS];
     int linesize[MAX_COMPONENTS];
@@ -1455,92 +1575,198 @@ static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
         s->coefs_finished[c] |= 1;
     }
 
-    for (mb_y = 0; mb_y < s->mb_height; mb_y++) {
-        for (mb_x = 0; mb_x < s->mb_width; mb_x++) {
-            const int copy_mb = mb_bitmask && !get_bits1(&mb_bitmask_gb);
+    mb_x = mcu_start % s->mb_width;
+    mb_y = mcu_start / s->mb_width;
+    for (mcu = mcu_start; mcu < mcu_end; mcu++) {
+        const int copy_mb = mb_bitmask && !get_bits1(&mb_bitmask_gb);
 
-            if (s->restart_interval && !s->restart_count)
-                s->restart_count = s->restart_interval;
+        if (s->restart_interval && !s->restart_count)
+            s->restart_count = s->restart_interval;
+
+        if (get_bits_left(&s->gb) < 0) {
+            av_log(s->avctx, AV_LOG_ERROR, "overread %d\n",
+                   -get_bits_left(&s->gb));
+            return AVERROR_INVALIDDATA;
+        }
+        for (i = 0; i < nb_components; i++) {
+            uint8_t *ptr;
+            int n, h, v, x, y, c, j;
+            int block_offset;
+            n = s->nb_blocks[i];
+            c = s->comp_index[i];
+            h = s->h_scount[i];
+            v = s->v_scount[i];
+            x = 0;
+            y = 0;
+            for (j = 0; j < n; j++) {
+                block_offset = (((linesize[c] * (v * mb_y + y) * 8) +
+                                 (h * mb_x + x) * 8 * bytes_per_pixel) >> s->avctx->lowres);
+
+                if (s->interlaced && s->bottom_field)
+                    block_offset += linesize[c] >> 1;
+                if (   8*(h * mb_x + x) < ((c == 1) || (c == 2) ? chroma_width  : s->width)
+                    && 8*(v * mb_y + y) < ((c == 1) || (c == 2) ? chroma_height : s->height)) {
+                    ptr = data[c] + block_offset;
+                } else
+                    ptr = NULL;
+                if (!s->progressive) {
+                    if (copy_mb) {
+                        if (ptr)
+                            mjpeg_copy_block(s, ptr, reference_data[c] + block_offset,
+                                            linesize[c], s->avctx->lowres);
 
-            if (get_bits_left(&s->gb) < 0) {
-                av_log(s->avctx, AV_LOG_ERROR, "overread %d\n",
-                       -get_bits_left(&s->gb));
-                return AVERROR_INVALIDDATA;
-            }
-            for (i = 0; i < nb_components; i++) {
-                uint8_t *ptr;
-                int n, h, v, x, y, c, j;
-                int block_offset;
-                n = s->nb_blocks[i];
-                c = s->comp_index[i];
-                h = s->h_scount[i];
-                v = s->v_scount[i];
-                x = 0;
-                y = 0;
-                for (j = 0; j < n; j++) {
-                    block_offset = (((linesize[c] * (v * mb_y + y) * 8) +
-                                     (h * mb_x + x) * 8 * bytes_per_pixel) >> s->avctx->lowres);
-
-                    if (s->interlaced && s->bottom_field)
-                        block_offset += linesize[c] >> 1;
-                    if (   8*(h * mb_x + x) < ((c == 1) || (c == 2) ? chroma_width  : s->width)
-                        && 8*(v * mb_y + y) < ((c == 1) || (c == 2) ? chroma_height : s->height)) {
-                        ptr = data[c] + block_offset;
-                    } else
-                        ptr = NULL;
-                    if (!s->progressive) {
-                        if (copy_mb) {
-                            if (ptr)
-                                mjpeg_copy_block(s, ptr, reference_data[c] + block_offset,
-                                                linesize[c], s->avctx->lowres);
-
-                        } else {
-                            s->bdsp.clear_block(s->block);
-                            if (decode_block(s, s->block, i,
-                                             s->dc_index[i], s->ac_index[i],
-                                             s->quant_matrixes[s->quant_sindex[i]]) < 0) {
-                                av_log(s->avctx, AV_LOG_ERROR,
-                                       "error y=%d x=%d\n", mb_y, mb_x);
-                                return AVERROR_INVALIDDATA;
-                            }
-                            if (ptr) {
-                                s->idsp.idct_put(ptr, linesize[c], s->block);
-                                if (s->bits & 7)
-                                    shift_output(s, ptr, linesize[c]);
-                            }
-                        }
                     } else {
-                        int block_idx  = s->block_stride[c] * (v * mb_y + y) +
-                                         (h * mb_x + x);
-                        int16_t *block = s->blocks[c][block_idx];
-                        if (Ah)
-                            block[0] += get_bits1(&s->gb) *
-                                        s->quant_matrixes[s->quant_sindex[i]][0] << Al;
-                        else if (decode_dc_progressive(s, block, i, s->dc_index[i],
-                                                       s->quant_matrixes[s->quant_sindex[i]],
-                                                       Al) < 0) {
+                        s->bdsp.clear_block(s->block);
+                        if (decode_block(s, s->block, i,
+                                         s->dc_index[i], s->ac_index[i],
+                                         s->quant_matrixes[s->quant_sindex[i]]) < 0) {
                             av_log(s->avctx, AV_LOG_ERROR,
                                    "error y=%d x=%d\n", mb_y, mb_x);
                             return AVERROR_INVALIDDATA;
                         }
+                        if (ptr) {
+                            s->idsp.idct_put(ptr, linesize[c], s->block);
+                            if (s->bits & 7)
+                                shift_output(s, ptr, linesize[c]);
+                        }
                     }
-                    ff_dlog(s->avctx, "mb: %d %d processed\n", mb_y, mb_x);
-                    ff_dlog(s->avctx, "%d %d %d %d %d %d %d %d \n",
-                            mb_x, mb_y, x, y, c, s->bottom_field,
-                            (v * mb_y + y) * 8, (h * mb_x + x) * 8);
-                    if (++x == h) {
-                        x = 0;
-                        y++;
+                } else {
+                    int block_idx  = s->block_stride[c] * (v * mb_y + y) +
+                                     (h * mb_x + x);
+                    int16_t *block = s->blocks[c][block_idx];
+                    if (Ah)
+                        block[0] += get_bits1(&s->gb) *
+                                    s->quant_matrixes[s->quant_sindex[i]][0] << Al;
+                    else if (decode_dc_progressive(s, block, i, s->dc_index[i],
+                                                   s->quant_matrixes[s->quant_sindex[i]],
+                                                   Al) < 0) {
+                        av_log(s->avctx, AV_LOG_ERROR,
+                               "error y=%d x=%d\n", mb_y, mb_x);
+                        return AVERROR_INVALIDDATA;
                     }
                 }
+                ff_dlog(s->avctx, "mb: %d %d processed\n", mb_y, mb_x);
+                ff_dlog(s->avctx, "%d %d %d %d %d %d %d %d \n",
+                        mb_x, mb_y, x, y, c, s->bottom_field,
+                        (v * mb_y + y) * 8, (h * mb_x + x) * 8);
+                if (++x == h) {
+                    x = 0;
+                    y++;
+                }
             }
+        }
+
+        handle_rstn(s, nb_components);
 
-            handle_rstn(s, nb_components);
+        if (++mb_x == s->mb_width) {
+            mb_x = 0;
+            mb_y++;
         }
     }
     return 0;
 }
 
+#define MAX_SCAN_JOBS 64
+
+typedef struct ScanSliceArgs {
+    int nb_components, Ah, Al;
+    int nb_intervals;
+    int nb_jobs;
+    const uint8_t *start; ///< start of the entropy-coded data of the scan
+    int end_pos;          ///< bit position in s->gb after the last interval
+} ScanSliceArgs;
+
+static int decode_scan_slice(AVCodecContext *avctx, void *arg,
+                             int jobnr, int threadnr)
+{
+    MJpegDecodeContext *s  = avctx->priv_data;
+    MJpegDecodeContext *sl = &s->slice_ctx[threadnr];
+    ScanSliceArgs *a = arg;
+    int first = a->nb_intervals *  jobnr      / a->nb_jobs;
+    int last  = a->nb_intervals * (jobnr + 1) / a->nb_jobs;
+    const uint8_t *start = first ? s->buffer + s->restart_pos[first - 1] : a->start;
+    const uint8_t *end   = last < a->nb_intervals ? s->buffer + s->restart_pos[last - 1] - 2
+                                                  : s->gb.buffer_end;
+    int ret;
+
+    *sl = *s;
+    ret = init_get_bits8(&sl->gb, start, end - start);
+    if (ret < 0)
+        return ret;
+
+    ret = mjpeg_decode_scan_mcus(sl, a->nb_components, a->Ah, a->Al, NULL, 0, NULL,
+                                 first * s->restart_interval,
+                                 FFMIN(last * s->restart_interval,
+                                       s->mb_width * s->mb_height));
+    if (ret >= 0 && last == a->nb_intervals)
+        a->end_pos = (sl->gb.buffer - s->gb.buffer) * 8 + get_bits_count(&sl->gb);
+    return ret;
+}
+
+/**
+ * Check that the restart markers found while unescaping the scan split it
+ * into exactly nb_intervals intervals in the expected RSTn order.
+ */
+static int restart_markers_valid(MJpegDecodeContext *s, int start, int nb_intervals)
+{
+    int size = s->gb.buffer_end - s->gb.buffer;
+    int i, prev = start;
+
+    if (s->nb_restart_pos != nb_intervals - 1)
+        return 0;
+    for (i = 0; i < s->nb_restart_pos; i++) {
+        int pos = s->restart_pos[i];
+        if (pos - 2 < prev || pos > size || s->buffer[pos - 1] != RST0 + (i & 7))
+            return 0;
+        prev = pos;
+    }
+    return 1;
+}
+
+static int mjpeg_decode_scan(MJpegDecodeContext *s, int nb_components, int Ah,
+                             int Al, const uint8_t *mb_bitmask,
+                             int mb_bitmask_size,
+                             const AVFrame *reference)
+{
+    AVCodecContext *avctx = s->avctx;
+    int mcu_count = s->mb_width * s->mb_height;
+
+    /* Restart intervals are independent of each other, so with slice
+     * threading and the interval boundaries known from unescaping they are
+     * decoded in parallel. */
+    if (avctx->active_thread_type & FF_THREAD_SLICE && avctx->thread_count > 1 &&
+        s->restart_interval && !s->progressive && !mb_bitmask &&
+        avctx->codec_id != AV_CODEC_ID_THP &&
+        s->gb.buffer == s->buffer && !(get_bits_count(&s->gb) & 7)) {
+        ScanSliceArgs a = { .nb_components = nb_components, .Ah = Ah, .Al = Al };
+        int start = get_bits_count(&s->gb) >> 3;
+        int rets[MAX_SCAN_JOBS];
+        int i;
+
+        a.nb_intervals = (mcu_count + s->restart_interval - 1) / s->restart_interval;
+        if (a.nb_intervals > 1 && restart_markers_valid(s, start, a.nb_intervals)) {
+            if (!s->slice_ctx) {
+                s->slice_ctx = av_malloc_array(avctx->thread_count, sizeof(*s->slice_ctx));
+                if (!s->slice_ctx)
+                    return AVERROR(ENOMEM);
+            }
+            a.start   = s->buffer + start;
+            a.nb_jobs = FFMIN3(a.nb_intervals, avctx->thread_count, MAX_SCAN_JOBS);
+            avctx->execute2(avctx, decode_scan_slice, &a, rets, a.nb_jobs);
+            for (i = 0; i < a.nb_jobs; i++)
+                if (rets[i] < 0)
+                    return rets[i];
+            for (i = 0; i < nb_components; i++)
+                s->coefs_finished[s->comp_index[i]] |= 1;
+            skip_bits_long(&s->gb, a.end_pos - get_bits_count(&s->gb));
+            return 0;
+        }
+    }
+
+    return mjpeg_decode_scan_mcus(s, nb_components, Ah, Al, mb_bitmask,
+                                  mb_bitmask_size, reference, 0, mcu_count);
+}
+
 static int mjpeg_decode_scan_progressive_ac(MJpegDecodeContext *s, int ss,
                                             int se, int Ah, int Al)
 {
@@ -2185,6 +2411,15 @@ static int find_marker(const uint8_t **pbuf_ptr, const uint8_t *buf_end)
 
     buf_ptr = *pbuf_ptr;
     while (buf_end - buf_ptr > 1) {
+        /* memchr() is vectorized by the C library, which matters when
+         * skipping over large amounts of entropy-coded data */
+        const uint8_t *ff = memchr(buf_ptr, 0xff, buf_end - buf_ptr - 1);
+        if (!ff) {
+            skipped += buf_end - buf_ptr - 1;
+            break;
+        }
+        skipped += ff - buf_ptr;
+        buf_ptr  = ff;
         v  = *buf_ptr++;
         v2 = *buf_ptr;
         if ((v == 0xff) && (v2 >= SOF0) && (v2 <= COM) && buf_ptr < buf_end) {
@@ -2212,6 +2447,7 @@ int ff_mjpeg_find_marker(MJpegDecodeContext *s,
     av_fast_padded_malloc(&s->buffer, &s->buffer_size, buf_end - *buf_ptr);
     if (!s->buffer)
         return AVERROR(ENOMEM);
+    s->nb_restart_pos = 0;
 
     /* unescape buffer of SOS, use special treatment for JPEG-LS */
     if (start_code == SOS && !s->ls) {
@@ -2233,29 +2469,45 @@ int ff_mjpeg_find_marker(MJpegDecodeContext *s,
             copy_data_segment(0);
         } else {
             while (ptr < buf_end) {
-                uint8_t x = *(ptr++);
+                ptrdiff_t skip = 0;
+                uint8_t x;
+
+                /* Jump to the next 0xFF, everything before it is copied
+                 * verbatim by the next copy_data_segment(). */
+                ptr = memchr(ptr, 0xff, buf_end - ptr);
+                if (!ptr) {
+                    ptr = buf_end;
+                    break;
+                }
+                x = *(ptr++);
 
-                if (x == 0xff) {
-                    ptrdiff_t skip = 0;
-                    while (ptr < buf_end && x == 0xff) {
-                        x = *(ptr++);
-                        skip++;
-                    }
+                while (ptr < buf_end && x == 0xff) {
+                    x = *(ptr++);
+                    skip++;
+                }
 
-                    /* 0xFF, 0xFF, ... */
-                    if (skip > 1) {
-                        copy_data_segment(skip);
+                /* 0xFF, 0xFF, ... */
+                if (skip > 1) {
+                    copy_data_segment(skip);
 
-                        /* decrement src as it is equal to ptr after the
-                         * copy_data_segment macro and we might want to
-                         * copy the current value of x later on */
-                        src--;
-                    }
+                    /* decrement src as it is equal to ptr after the
+                     * copy_data_segment macro and we might want to
+                     * copy the current value of x later on */
+                    src--;
+                }
 
-                    if (x < RST0 || x > RST7) {
-                        copy_data_segment(1);
-                        if (x)
-                            break;
+                if (x < RST0 || x > RST7) {
+                    copy_data_segment(1);
+                    if (x)
+                        break;
+                } else {
+                    /* remember where each restart interval starts in the
+                     * unescaped buffer, so they can be decoded in parallel */
+                    int *pos = av_fast_realloc(s->restart_pos, &s->restart_pos_size,
+                                               (s->nb_restart_pos + 1) * sizeof(*pos));
+                    if (pos) {
+                        s->restart_pos = pos;
+                        pos[s->nb_restart_pos++] = (dst - s->buffer) + (ptr - src);
                     }
                 }
             }
@@ -2395,7 +2647,7 @@ static int mjpeg_get_packet(AVCodecContext *avctx)
     return 0;
 }
 
-int ff_mjpeg_receive_frame(AVCodecContext *avctx, AVFrame *frame)
+static int mjpeg_decode_packet(AVCodecContext *avctx, AVFrame *frame)
 {
     MJpegDecodeContext *s = avctx->priv_data;
     const uint8_t *buf_end, *buf_ptr;
@@ -2408,11 +2660,6 @@ int ff_mjpeg_receive_frame(AVCodecContext *avctx, AVFrame *frame)
     int is16bit;
     AVDictionaryEntry *e = NULL;
 
-    s->force_pal8 = 0;
-
-    if (avctx->codec_id == AV_CODEC_ID_SMVJPEG && s->smv_next_frame > 0)
-        return smv_process_frame(avctx, frame);
-
     av_dict_free(&s->exif_metadata);
     av_freep(&s->stereo3d);
     s->adobe_transform = -1;
@@ -2420,9 +2667,6 @@ int ff_mjpeg_receive_frame(AVCodecContext *avctx, AVFrame *frame)
     if (s->iccnum != 0)
         reset_icc_profile(s);
 
-    ret = mjpeg_get_packet(avctx);
-    if (ret < 0)
-        return ret;
 redo_for_pal8:
     buf_ptr = s->pkt->data;
     buf_end = s->pkt->data + s->pkt->size;
@@ -2611,6 +2855,17 @@ eoi_parser:
                 break;
             }
 
+            /* With frame threading, let the next frame start once only the
+             * entropy-coded data of a picture that will be output is left. */
+            if (buf_ptr == s->last_scan && s->got_picture && !s->setup_finished &&
+                (!s->interlaced ||
+                 (!s->last_scan_has_rst && s->bottom_field == !s->interlace_polarity))) {
+                s->next_got_picture  = 0;
+                s->next_bottom_field = s->bottom_field ^ s->interlaced;
+                s->setup_finished    = 1;
+                ff_thread_finish_setup(avctx);
+            }
+
             if ((ret = ff_mjpeg_decode_sos(s, NULL, 0, NULL)) < 0 &&
                 (avctx->err_recognition & AV_EF_EXPLODE))
                 goto fail;
@@ -2942,6 +3197,23 @@ the_end_no_picture:
     return ret;
 }
 
+int ff_mjpeg_receive_frame(AVCodecContext *avctx, AVFrame *frame)
+{
+    MJpegDecodeContext *s = avctx->priv_data;
+    int ret;
+
+    s->force_pal8 = 0;
+
+    if (avctx->codec_id == AV_CODEC_ID_SMVJPEG && s->smv_next_frame > 0)
+        return smv_process_frame(avctx, frame);
+
+    ret = mjpeg_get_packet(avctx);
+    if (ret < 0)
+        return ret;
+
+    return mjpeg_decode_packet(avctx, frame);
+}
+
 /* mxpeg may call the following function (with a blank MJpegDecodeContext)
  * even without having called ff_mjpeg_decode_init(). */
 av_cold int ff_mjpeg_decode_end(AVCodecContext *avctx)
@@ -2962,6 +3234,8 @@ av_cold int ff_mjpeg_decode_end(AVCodecContext *avctx)
     av_frame_free(&s->smv_frame);
 
     av_freep(&s->buffer);
+    av_freep(&s->restart_pos);
+    av_freep(&s->slice_ctx);
     av_freep(&s->stereo3d);
     av_freep(&s->ljpeg_buffer);
     s->ljpeg_buffer_size = 0;
@@ -2994,6 +3268,174 @@ static void decode_flush(AVCodecContext *avctx)
 }
 
 #if CONFIG_MJPEG_DECODER
+/**
+ * Find the last scan of a packet that is only followed by restart markers
+ * and EOI, so that nothing parsed after its header can affect later frames.
+ *
+ * @return the position after the SOS marker of that scan or NULL
+ */
+static const uint8_t *find_last_scan(const uint8_t *buf_ptr, const uint8_t *buf_end,
+                                     int *followed_by_rst)
+{
+    const uint8_t *last_scan = NULL;
+
+    *followed_by_rst = 0;
+    while (buf_end - buf_ptr > 1) {
+        const uint8_t *ptr = memchr(buf_ptr, 0xff, buf_end - buf_ptr - 1);
+        int code;
+
+        if (!ptr)
+            break;
+        buf_ptr = ptr + 1;
+        code    = *buf_ptr;
+        if (code < SOF0 || code > COM)
+            continue;
+        buf_ptr++;
+
+        if (code == SOS) {
+            last_scan        = buf_ptr;
+            *followed_by_rst = 0;
+        } else if (code >= RST0 && code <= RST7) {
+            *followed_by_rst = 1;
+        } else if (code != EOI) {
+            last_scan = NULL;
+        }
+    }
+    return last_scan;
+}
+
+static int mjpeg_decode_frame(AVCodecContext *avctx, void *data,
+                              int *got_frame, AVPacket *avpkt)
+{
+    MJpegDecodeContext *s = avctx->priv_data;
+    int ret;
+
+    s->force_pal8     = 0;
+    s->pkt            = avpkt;
+    s->buf_size       = avpkt->size;
+    s->setup_finished = 0;
+    s->last_scan      = NULL;
+    if (avctx->active_thread_type & FF_THREAD_FRAME)
+        s->last_scan = find_last_scan(avpkt->data, avpkt->data + avpkt->size,
+                                      &s->last_scan_has_rst);
+
+    ret = mjpeg_decode_packet(avctx, data);
+
+    if (!s->setup_finished) {
+        s->next_got_picture  = s->got_picture;
+        s->next_bottom_field = s->bottom_field;
+    }
+    if (ret == AVERROR(EAGAIN))
+        return avpkt->size;
+    if (ret < 0)
+        return ret;
+
+    *got_frame = 1;
+    return avpkt->size;
+}
+
+#if HAVE_THREADS
+static int copy_huffman_tables(MJpegDecodeContext *s, const MJpegDecodeContext *s1)
+{
+    int class, index, i, ret;
+
+    for (class = 0; class < 2; class++) {
+        for (index = 0; index < 4; index++) {
+            const uint8_t *lengths = s1->raw_huffman_lengths[class][index];
+            const uint8_t *values  = s1->raw_huffman_values[class][index];
+            uint8_t bits_table[17] = { 0 };
+            int n = 0;
+
+            for (i = 0; i < 16; i++)
+                n += lengths[i];
+            if (!s->vlcs[class][index].table == !s1->vlcs[class][index].table &&
+                !memcmp(s->raw_huffman_lengths[class][index], lengths, 16) &&
+                !memcmp(s->raw_huffman_values[class][index], values, n))
+                continue;
+
+            ff_free_vlc(&s->vlcs[class][index]);
+            if (class > 0)
+                ff_free_vlc(&s->vlcs[2][index]);
+            memcpy(s->raw_huffman_lengths[class][index], lengths, 16);
+            memcpy(s->raw_huffman_values[class][index],  values,  256);
+            if (!s1->vlcs[class][index].table)
+                continue;
+
+            memcpy(bits_table + 1, lengths, 16);
+            if ((ret = ff_mjpeg_build_vlc(&s->vlcs[class][index], bits_table,
+                                          values, class > 0, s->avctx)) < 0)
+                return ret;
+            if (class > 0 &&
+                (ret = ff_mjpeg_build_vlc(&s->vlcs[2][index], bits_table,
+                                          values, 0, s->avctx)) < 0)
+                return ret;
+            if (class > 0)
+                build_ac_fast_table(s, index);
+        }
+    }
+    return 0;
+}
+
+static int mjpeg_update_thread_context(AVCodecContext *dst, const AVCodecContext *src)
+{
+    MJpegDecodeContext *s = dst->priv_data, *s1 = src->priv_data;
+    int ret;
+
+    if (dst == src)
+        return 0;
+
+    if ((ret = copy_huffman_tables(s, s1)) < 0)
+        return ret;
+    memcpy(s->quant_matrixes, s1->quant_matrixes, sizeof(s->quant_matrixes));
+    memcpy(s->qscale,         s1->qscale,         sizeof(s->qscale));
+
+    if (s->bits != s1->bits)
+        init_idct(dst);
+
+    s->width              = s1->width;
+    s->height             = s1->height;
+    s->bits               = s1->bits;
+    s->nb_components      = s1->nb_components;
+    memcpy(s->component_id, s1->component_id, sizeof(s->component_id));
+    memcpy(s->h_count,      s1->h_count,      sizeof(s->h_count));
+    memcpy(s->v_count,      s1->v_count,      sizeof(s->v_count));
+    memcpy(s->quant_index,  s1->quant_index,  sizeof(s->quant_index));
+    memcpy(s->linesize,     s1->linesize,     sizeof(s->linesize));
+    s->h_max              = s1->h_max;
+    s->v_max              = s1->v_max;
+    s->lossless           = s1->lossless;
+    s->ls                 = s1->ls;
+    s->progressive        = s1->progressive;
+    s->rgb                = s1->rgb;
+    s->rct                = s1->rct;
+    s->pegasus_rct        = s1->pegasus_rct;
+    s->colr               = s1->colr;
+    s->xfrm               = s1->xfrm;
+    s->flipped            = s1->flipped;
+    s->palette_index      = s1->palette_index;
+    s->buggy_avid         = s1->buggy_avid;
+    s->cs_itu601          = s1->cs_itu601;
+    s->multiscope         = s1->multiscope;
+    s->first_picture      = s1->first_picture;
+    s->interlaced         = s1->interlaced;
+    s->interlace_polarity = s1->interlace_polarity;
+    s->pix_desc           = s1->pix_desc;
+    s->hwaccel_pix_fmt    = s1->hwaccel_pix_fmt;
+    s->hwaccel_sw_pix_fmt = s1->hwaccel_sw_pix_fmt;
+
+    /* A first field left by the previous packet is completed by this one. */
+    s->got_picture        = s1->next_got_picture;
+    s->bottom_field       = s1->next_bottom_field;
+    if (s->got_picture) {
+        av_frame_unref(s->picture_ptr);
+        if ((ret = av_frame_ref(s->picture_ptr, s1->picture_ptr)) < 0)
+            return ret;
+    }
+
+    return 0;
+}
+#endif
+
 #define OFFSET(x) offsetof(MJpegDecodeContext, x)
 #define VD AV_OPT_FLAG_VIDEO_PARAM | AV_OPT_FLAG_DECODING_PARAM
 static const AVOption options[] = {
@@ -3017,9 +3459,11 @@ const AVCodec ff_mjpeg_decoder = {
     .priv_data_size = sizeof(MJpegDecodeContext),
     .init           = ff_mjpeg_decode_init,
     .close          = ff_mjpeg_decode_end,
-    .receive_frame  = ff_mjpeg_receive_frame,
+    .decode         = mjpeg_decode_frame,
+    .update_thread_context = ONLY_IF_THREADS_ENABLED(mjpeg_update_thread_context),
     .flush          = decode_flush,
-    .capabilities   = AV_CODEC_CAP_DR1,
+    .capabilities   = AV_CODEC_CAP_DR1 | AV_CODEC_CAP_FRAME_THREADS |
+                      AV_CODEC_CAP_SLICE_THREADS,
     .max_lowres     = 3,
     .priv_class     = &mjpegdec_class,
     .profiles       = NULL_IF_CONFIG_SMALL(ff_mjpeg_profiles),
@@ -43,6 +43,8 @@
 #undef near /* This file uses struct member 'near' which in windows.h is defined as empty. */
 
 #define MAX_COMPONENTS 4
+#define AC_FAST_BITS   9
+#define AC_PAIR_BITS   12
 
 typedef struct ICCEntry {
     uint8_t *data;
@@ -65,6 +67,13 @@ typedef struct MJpegDecodeContext {
 
     uint16_t quant_matrixes[4][64];
     VLC vlcs[3][4];
+    /* Sequential AC codes that fit in AC_FAST_BITS together with their
+     * coefficient bits: level << 8 | run << 4 | total length, 0 if absent. */
+    int16_t ac_fast[4][1 << AC_FAST_BITS];
+    /* Pairs of such codes fitting in AC_PAIR_BITS, the second one possibly
+     * EOB: level2 << 20 | run2 << 16 | level1 << 8 | run1 << 4 | total length,
+     * 0 if absent. */
+    uint32_t ac_pair[4][1 << AC_PAIR_BITS];
     int qscale[4];      ///< quantizer scale calculated from quant_matrixes
 
     int orig_height;  /* size given at codec init */
@@ -125,6 +134,10 @@ typedef struct MJpegDecodeContext {
 
     int restart_interval;
     int restart_count;
+    int *restart_pos;               ///< unescaped scan offsets following each RSTn marker
+    unsigned int restart_pos_size;
+    int nb_restart_pos;
+    struct MJpegDecodeContext *slice_ctx; ///< per-thread copies for decoding restart intervals in parallel
 
     int buggy_avid;
     int cs_itu601;
@@ -167,6 +180,13 @@ typedef struct MJpegDecodeContext {
     enum AVPixelFormat hwaccel_pix_fmt;
     void *hwaccel_picture_private;
     struct JLSState *jls_state;
+
+    /* frame threading: state handed to the next frame thread */
+    const uint8_t *last_scan; ///< scan after which ff_thread_finish_setup() may be called
+    int last_scan_has_rst;
+    int setup_finished;
+    int next_got_picture;
+    int next_bottom_field;
 } MJpegDecodeContext;
 
 int ff_mjpeg_build_vlc(VLC *vlc, const uint8_t *bits_table,
@@ -993,6 +993,18 @@ static int get_intra_count(MpegEncContext *s, uint8_t *src,
     return acc;
 }
 
+static int b_frame_score_thread(AVCodecContext *c, void *arg, int jobnr, int threadnr)
+{
+    MpegEncContext *s = arg;
+    Picture *pic = s->input_picture[jobnr + 1];
+
+    if (pic && pic->b_frame_score == 0)
+        pic->b_frame_score = get_intra_count(s, pic->f->data[0],
+                                             s->input_picture[jobnr]->f->data[0],
+                                             s->linesize) + 1;
+    return 0;
+}
+
 static int alloc_picture(MpegEncContext *s, Picture *pic, int shared)
 {
     return ff_alloc_picture(s->avctx, pic, &s->me, &s->sc, shared, 1,
@@ -1214,32 +1226,125 @@ static int encode_frame(AVCodecContext *c, AVFrame *frame, AVPacket *pkt)
     return size;
 }
 
-static int estimate_best_b_count(MpegEncContext *s)
+/**
+ * Trial encodes of estimate_best_b_count(), one per candidate B-frame count.
+ * The trials are independent and run on the slice thread pool, so at most
+ * max_b_frames + 1 threads are used. Only the decision is parallel: the
+ * chosen frames are encoded after it, not overlapped with the next one.
+ */
+typedef struct BCountTrials {
+    MpegEncContext *s;
+    int width, height;
+    int p_lambda, b_lambda, lambda2;
+    int64_t rd[MAX_B_FRAMES + 1];
+} BCountTrials;
+
+static int encode_b_count_trial(AVCodecContext *avctx, void *arg, int j, int threadnr)
 {
+    BCountTrials *bt = arg;
+    MpegEncContext *s = bt->s;
+    AVCodecContext *c;
+    AVFrame *frame;
     AVPacket *pkt;
+    int64_t rd = 0;
+    int i, out_size, ret;
+
+    c     = avcodec_alloc_context3(NULL);
+    frame = av_frame_alloc();
+    pkt   = av_packet_alloc();
+    if (!c || !frame || !pkt) {
+        ret = AVERROR(ENOMEM);
+        goto fail;
+    }
+
+    c->width        = bt->width;
+    c->height       = bt->height;
+    c->flags        = AV_CODEC_FLAG_QSCALE | AV_CODEC_FLAG_PSNR;
+    c->flags       |= s->avctx->flags & AV_CODEC_FLAG_QPEL;
+    c->mb_decision  = s->avctx->mb_decision;
+    c->me_cmp       = s->avctx->me_cmp;
+    c->mb_cmp       = s->avctx->mb_cmp;
+    c->me_sub_cmp   = s->avctx->me_sub_cmp;
+    c->pix_fmt      = AV_PIX_FMT_YUV420P;
+    c->time_base    = s->avctx->time_base;
+    c->max_b_frames = s->max_b_frames;
+
+    ret = avcodec_open2(c, s->avctx->codec, NULL);
+    if (ret < 0)
+        goto fail;
+
+    /* The downscaled pictures are shared by all trials, so the picture type
+     * and quality of each trial are set on a reference of its own. */
+    for (i = 0; i < s->max_b_frames + 2; i++) {
+        ret = av_frame_ref(frame, s->tmp_frames[i]);
+        if (ret < 0)
+            goto fail;
+
+        if (!i) {
+            frame->pict_type = AV_PICTURE_TYPE_I;
+            frame->quality   = 1 * FF_QP2LAMBDA;
+        } else {
+            int is_p = (i - 1) % (j + 1) == j || i - 1 == s->max_b_frames;
+
+            frame->pict_type = is_p ? AV_PICTURE_TYPE_P : AV_PICTURE_TYPE_B;
+            frame->quality   = is_p ? bt->p_lambda : bt->b_lambda;
+        }
+
+        out_size = encode_frame(c, frame, pkt);
+        av_frame_unref(frame);
+        if (out_size < 0) {
+            ret = out_size;
+            goto fail;
+        }
+
+        //rd += (out_size * lambda2) >> FF_LAMBDA_SHIFT;
+        if (i)
+            rd += (out_size * bt->lambda2) >> (FF_LAMBDA_SHIFT - 3);
+    }
+
+    /* get the delayed frames */
+    out_size = encode_frame(c, NULL, pkt);
+    if (out_size < 0) {
+        ret = out_size;
+        goto fail;
+    }
+    rd += (out_size * bt->lambda2) >> (FF_LAMBDA_SHIFT - 3);
+
+    rd += c->error[0] + c->error[1] + c->error[2];
+
+    bt->rd[j] = rd;
+
+fail:
+    avcodec_free_context(&c);
+    av_frame_free(&frame);
+    av_packet_free(&pkt);
+    return ret;
+}
+
+static int estimate_best_b_count(MpegEncContext *s)
+{
+    BCountTrials bt = { .s = s };
     const int scale = s->brd_scale;
     int width  = s->width  >> scale;
     int height = s->height >> scale;
-    int i, j, out_size, p_lambda, b_lambda, lambda2;
+    int rets[MAX_B_FRAMES + 1];
+    int i, j, nb_trials;
     int64_t best_rd  = INT64_MAX;
     int best_b_count = -1;
-    int ret = 0;
 
     av_assert0(scale >= 0 && scale <= 3);
 
-    pkt = av_packet_alloc();
-    if (!pkt)
-        return AVERROR(ENOMEM);
-
     //emms_c();
     //s->next_picture_ptr->quality;
-    p_lambda = s->last_lambda_for[AV_PICTURE_TYPE_P];
+    bt.p_lambda = s->last_lambda_for[AV_PICTURE_TYPE_P];
     //p_lambda * FFABS(s->avctx->b_quant_factor) + s->avctx->b_quant_offset;
-    b_lambda = s->last_lambda_for[AV_PICTURE_TYPE_B];
-    if (!b_lambda) // FIXME we should do this somewhere else
-        b_lambda = p_lambda;
-    lambda2  = (b_lambda * b_lambda + (1 << FF_LAMBDA_SHIFT) / 2) >>
-               FF_LAMBDA_SHIFT;
+    bt.b_lambda = s->last_lambda_for[AV_PICTURE_TYPE_B];
+    if (!bt.b_lambda) // FIXME we should do this somewhere else
+        bt.b_lambda = bt.p_lambda;
+    bt.lambda2  = (bt.b_lambda * bt.b_lambda + (1 << FF_LAMBDA_SHIFT) / 2) >>
+                  FF_LAMBDA_SHIFT;
+    bt.width    = width;
+    bt.height   = height;
 
     for (i = 0; i < s->max_b_frames + 2; i++) {
         Picture pre_input, *pre_input_ptr = i ? s->input_picture[i - 1] :
@@ -1274,89 +1379,21 @@ static int estimate_best_b_count(MpegEncContext *s)
         }
     }
 
-    for (j = 0; j < s->max_b_frames + 1; j++) {
-        AVCodecContext *c;
-        int64_t rd = 0;
-
-        if (!s->input_picture[j])
+    for (nb_trials = 0; nb_trials < s->max_b_frames + 1; nb_trials++)
+        if (!s->input_picture[nb_trials])
             break;
 
-        c = avcodec_alloc_context3(NULL);
-        if (!c) {
-            ret = AVERROR(ENOMEM);
-            goto fail;
-        }
-
-        c->width        = width;
-        c->height       = height;
-        c->flags        = AV_CODEC_FLAG_QSCALE | AV_CODEC_FLAG_PSNR;
-        c->flags       |= s->avctx->flags & AV_CODEC_FLAG_QPEL;
-        c->mb_decision  = s->avctx->mb_decision;
-        c->me_cmp       = s->avctx->me_cmp;
-        c->mb_cmp       = s->avctx->mb_cmp;
-        c->me_sub_cmp   = s->avctx->me_sub_cmp;
-        c->pix_fmt      = AV_PIX_FMT_YUV420P;
-        c->time_base    = s->avctx->time_base;
-        c->max_b_frames = s->max_b_frames;
-
-        ret = avcodec_open2(c, s->avctx->codec, NULL);
-        if (ret < 0)
-            goto fail;
-
-
-        s->tmp_frames[0]->pict_type = AV_PICTURE_TYPE_I;
-        s->tmp_frames[0]->quality   = 1 * FF_QP2LAMBDA;
-
-        out_size = encode_frame(c, s->tmp_frames[0], pkt);
-        if (out_size < 0) {
-            ret = out_size;
-            goto fail;
-        }
-
-        //rd += (out_size * lambda2) >> FF_LAMBDA_SHIFT;
-
-        for (i = 0; i < s->max_b_frames + 1; i++) {
-            int is_p = i % (j + 1) == j || i == s->max_b_frames;
-
-            s->tmp_frames[i + 1]->pict_type = is_p ?
-                                     AV_PICTURE_TYPE_P : AV_PICTURE_TYPE_B;
-            s->tmp_frames[i + 1]->quality   = is_p ? p_lambda : b_lambda;
+    s->avctx->execute2(s->avctx, encode_b_count_trial, &bt, rets, nb_trials);
 
-            out_size = encode_frame(c, s->tmp_frames[i + 1], pkt);
-            if (out_size < 0) {
-                ret = out_size;
-                goto fail;
-            }
-
-            rd += (out_size * lambda2) >> (FF_LAMBDA_SHIFT - 3);
-        }
-
-        /* get the delayed frames */
-        out_size = encode_frame(c, NULL, pkt);
-        if (out_size < 0) {
-            ret = out_size;
-            goto fail;
-        }
-        rd += (out_size * lambda2) >> (FF_LAMBDA_SHIFT - 3);
-
-        rd += c->error[0] + c->error[1] + c->error[2];
-
-        if (rd < best_rd) {
-            best_rd = rd;
+    for (j = 0; j < nb_trials; j++) {
+        if (rets[j] < 0)
+            return rets[j];
+        if (bt.rd[j] < best_rd) {
+            best_rd = bt.rd[j];
             best_b_count = j;
         }
-
-fail:
-        avcodec_free_context(&c);
-        av_packet_unref(pkt);
-        if (ret < 0) {
-            best_b_count = ret;
-            break;
-        }
     }
 
-    av_packet_free(&pkt);
-
     return best_b_count;
 }
 
@@ -1413,16 +1450,8 @@ static int select_input_picture(MpegEncContext *s)
                 while (b_frames && !s->input_picture[b_frames])
                     b_frames--;
             } else if (s->b_frame_strategy == 1) {
-                for (i = 1; i < s->max_b_frames + 1; i++) {
-                    if (s->input_picture[i] &&
-                        s->input_picture[i]->b_frame_score == 0) {
-                        s->input_picture[i]->b_frame_score =
-                            get_intra_count(s,
-                                            s->input_picture[i    ]->f->data[0],
-                                            s->input_picture[i - 1]->f->data[0],
-                                            s->linesize) + 1;
-                    }
-                }
+                s->avctx->execute2(s->avctx, b_frame_score_thread, s, NULL,
+                                   s->max_b_frames);
                 for (i = 0; i < s->max_b_frames + 1; i++) {
                     if (!s->input_picture[i] ||
                         s->input_picture[i]->b_frame_score - 1 >
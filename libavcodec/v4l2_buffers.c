@@ -32,6 +32,7 @@
 #include "libavutil/pixdesc.h"
 #include "v4l2_context.h"
 #include "v4l2_buffers.h"
+#include "v4l2_fmt.h"
 #include "v4l2_m2m.h"
 
 #define USEC_PER_SEC 1000000
@@ -218,8 +219,19 @@ static void v4l2_free_buffer(void *opaque, uint8_t *unused)
     if (atomic_fetch_sub(&avbuf->context_refcount, 1) == 1) {
         atomic_fetch_sub_explicit(&s->refcount, 1, memory_order_acq_rel);
 
+        if (atomic_fetch_add(&avbuf->orphan_sync, 1) == 1) {
+            /* the queue was released meanwhile: drop the buffer for good,
+             * the array goes away with the last orphan reference */
+            AVBufferRef *orphan_ref = avbuf->orphan_ref;
+
+            ff_v4l2_buffer_release(avbuf);
+            av_buffer_unref(&avbuf->context_ref);
+            av_buffer_unref(&orphan_ref);
+            return;
+        }
+
         if (s->reinit) {
-            if (!atomic_load(&s->refcount))
+            if (!atomic_load(&s->refcount) && !avbuf->context->orphaned_bufs)
                 sem_post(&s->refsync);
         } else {
             if (s->draining && V4L2_TYPE_IS_OUTPUT(avbuf->context->type)) {
@@ -246,6 +258,7 @@ static int v4l2_buf_increase_ref(V4L2Buffer *in)
             return AVERROR(ENOMEM);
 
         in->context_refcount = 1;
+        atomic_store(&in->orphan_sync, 0);
     }
 
     in->status = V4L2BUF_RET_USER;
@@ -338,6 +351,113 @@ static int v4l2_buffer_buf_to_swframe(AVFrame *frame, V4L2Buffer *avbuf)
     return 0;
 }
 
+/* The layout is derived from the current format on every dequeue, so that
+ * it follows a resolution change handled without reallocating the buffers. */
+static int v4l2_buffer_set_drm_layout(V4L2Buffer *avbuf)
+{
+    V4L2Context *ctx = avbuf->context;
+    AVDRMFrameDescriptor *desc = &avbuf->drm_frame;
+    AVDRMLayerDescriptor *layer = &desc->layers[0];
+    const AVPixFmtDescriptor *pixdesc = av_pix_fmt_desc_get(ctx->av_pix_fmt);
+    int height = V4L2_TYPE_IS_MULTIPLANAR(ctx->type) ?
+                 ctx->format.fmt.pix_mp.height : ctx->format.fmt.pix.height;
+    int nb_planes = av_pix_fmt_count_planes(ctx->av_pix_fmt);
+    size_t offset = 0;
+    int i;
+
+    layer->format = ff_v4l2_format_avfmt_to_drm(ctx->av_pix_fmt);
+    if (!layer->format || nb_planes <= 0 || nb_planes > AV_DRM_MAX_PLANES ||
+        (avbuf->num_planes != 1 && avbuf->num_planes != nb_planes))
+        return AVERROR(EINVAL);
+
+    /* one object per plane (e.g. NV12M), or all planes packed one after
+     * the other in a single object, matching v4l2_buffer_buf_to_swframe */
+    desc->nb_layers  = 1;
+    layer->nb_planes = nb_planes;
+    for (i = 0; i < nb_planes; i++) {
+        int pitch = avbuf->plane_info[0].bytesperline;
+        int h     = height;
+
+        if (i) {
+            h = AV_CEIL_RSHIFT(height, pixdesc->log2_chroma_h);
+            if (nb_planes > 2)
+                pitch >>= pixdesc->log2_chroma_w;
+        }
+
+        if (avbuf->num_planes > 1) {
+            layer->planes[i].object_index = i;
+            layer->planes[i].offset       = 0;
+            layer->planes[i].pitch        = avbuf->plane_info[i].bytesperline;
+        } else {
+            layer->planes[i].object_index = 0;
+            layer->planes[i].offset       = offset;
+            layer->planes[i].pitch        = pitch;
+            offset += (size_t)pitch * h;
+        }
+    }
+
+    return 0;
+}
+
+static int v4l2_buffer_buf_to_drmframe(AVFrame *frame, V4L2Buffer *avbuf)
+{
+    V4L2m2mContext *s = buf_to_m2mctx(avbuf);
+    int ret;
+
+    ret = v4l2_buffer_set_drm_layout(avbuf);
+    if (ret)
+        return ret;
+
+    frame->buf[0] = av_buffer_create((uint8_t *)&avbuf->drm_frame, sizeof(avbuf->drm_frame),
+                                     v4l2_free_buffer, avbuf, AV_BUFFER_FLAG_READONLY);
+    if (!frame->buf[0])
+        return AVERROR(ENOMEM);
+
+    ret = v4l2_buf_increase_ref(avbuf);
+    if (ret) {
+        av_buffer_unref(&frame->buf[0]);
+        return ret;
+    }
+
+    frame->hw_frames_ctx = av_buffer_ref(s->frames_ref);
+    if (!frame->hw_frames_ctx)
+        return AVERROR(ENOMEM);
+
+    frame->format  = AV_PIX_FMT_DRM_PRIME;
+    frame->data[0] = (uint8_t *)&avbuf->drm_frame;
+
+    return 0;
+}
+
+static int v4l2_buffer_export_drm(V4L2Buffer *avbuf)
+{
+    V4L2Context *ctx = avbuf->context;
+    AVDRMFrameDescriptor *desc = &avbuf->drm_frame;
+    int i;
+
+    for (i = 0; i < avbuf->num_planes; i++) {
+        struct v4l2_exportbuffer expbuf = {
+            .type  = ctx->type,
+            .index = avbuf->buf.index,
+            .plane = i,
+            .flags = O_RDONLY,
+        };
+#ifdef O_CLOEXEC
+        expbuf.flags |= O_CLOEXEC;
+#endif
+
+        if (ioctl(buf_to_m2mctx(avbuf)->fd, VIDIOC_EXPBUF, &expbuf) < 0)
+            return AVERROR(errno);
+
+        desc->objects[i].fd   = expbuf.fd;
+        desc->objects[i].size = avbuf->plane_info[i].length;
+        /* format_modifier is left to 0, i.e. DRM_FORMAT_MOD_LINEAR */
+        desc->nb_objects++;
+    }
+
+    return v4l2_buffer_set_drm_layout(avbuf);
+}
+
 static int v4l2_buffer_swframe_to_buf(const AVFrame *frame, V4L2Buffer *out)
 {
     int i, ret;
@@ -403,6 +523,67 @@ static int v4l2_buffer_swframe_to_buf(const AVFrame *frame, V4L2Buffer *out)
     return 0;
 }
 
+static int v4l2_buffer_drmframe_to_buf(const AVFrame *frame, V4L2Buffer *out)
+{
+    const AVDRMFrameDescriptor *desc = (const AVDRMFrameDescriptor *)frame->data[0];
+    const AVDRMLayerDescriptor *layer = &desc->layers[0];
+    int height = V4L2_TYPE_IS_MULTIPLANAR(out->buf.type) ?
+                 out->context->format.fmt.pix_mp.height : out->context->format.fmt.pix.height;
+    int i;
+
+    /* the planes must be laid out as negotiated with VIDIOC_S_FMT: either one
+     * object per V4L2 plane or, for single plane formats, all the planes
+     * packed in the same object */
+    if (desc->nb_layers != 1 ||
+        (out->num_planes != layer->nb_planes && out->num_planes != 1))
+        goto invalid;
+
+    if (out->num_planes == 1 && layer->nb_planes > 1 &&
+        (layer->planes[1].object_index != layer->planes[0].object_index ||
+         layer->planes[1].offset != layer->planes[0].offset +
+                                    (ptrdiff_t)layer->planes[0].pitch * height))
+        goto invalid;
+
+    for (i = 0; i < out->num_planes; i++) {
+        const AVDRMPlaneDescriptor *plane = &layer->planes[i];
+        const AVDRMObjectDescriptor *obj = &desc->objects[plane->object_index];
+        unsigned int length = obj->size ? obj->size : out->plane_info[i].length;
+
+        if (plane->pitch != out->plane_info[i].bytesperline)
+            goto invalid;
+
+        if (V4L2_TYPE_IS_MULTIPLANAR(out->buf.type)) {
+            out->planes[i].m.fd        = obj->fd;
+            out->planes[i].data_offset = plane->offset;
+            out->planes[i].length      = length;
+            out->planes[i].bytesused   = length;
+        } else {
+            /* single plane API: no data offset */
+            if (plane->offset)
+                goto invalid;
+            out->buf.m.fd      = obj->fd;
+            out->buf.length    = length;
+            out->buf.bytesused = length;
+        }
+    }
+
+    if (V4L2_TYPE_IS_MULTIPLANAR(out->buf.type)) {
+        out->buf.m.planes = out->planes;
+        out->buf.length   = out->num_planes;
+    }
+
+    out->frame = av_frame_clone(frame);
+    if (!out->frame)
+        return AVERROR(ENOMEM);
+
+    return 0;
+
+invalid:
+    av_log(logger(out), AV_LOG_ERROR, "%s: DRM frame layout does not match the buffer format\n",
+           out->context->name);
+    return AVERROR(EINVAL);
+}
+
 /******************************************************************************
  *
  *              V4L2Buffer interface
@@ -413,6 +594,12 @@ int ff_v4l2_buffer_avframe_to_buf(const AVFrame *frame, V4L2Buffer *out)
 {
     v4l2_set_pts(out, frame->pts);
 
+    if (out->context->memory == V4L2_MEMORY_DMABUF) {
+        if (frame->format != AV_PIX_FMT_DRM_PRIME)
+            return AVERROR(EINVAL);
+        return v4l2_buffer_drmframe_to_buf(frame, out);
+    }
+
     return v4l2_buffer_swframe_to_buf(frame, out);
 }
 
@@ -423,7 +610,10 @@ int ff_v4l2_buffer_buf_to_avframe(AVFrame *frame, V4L2Buffer *avbuf)
     av_frame_unref(frame);
 
     /* 1. get references to the actual data */
-    ret = v4l2_buffer_buf_to_swframe(frame, avbuf);
+    if (buf_to_m2mctx(avbuf)->output_drm)
+        ret = v4l2_buffer_buf_to_drmframe(frame, avbuf);
+    else
+        ret = v4l2_buffer_buf_to_swframe(frame, avbuf);
     if (ret)
         return ret;
 
@@ -496,7 +686,7 @@ int ff_v4l2_buffer_initialize(V4L2Buffer* avbuf, int index)
     V4L2Context *ctx = avbuf->context;
     int ret, i;
 
-    avbuf->buf.memory = V4L2_MEMORY_MMAP;
+    avbuf->buf.memory = ctx->memory;
     avbuf->buf.type = ctx->type;
     avbuf->buf.index = index;
 
@@ -525,13 +715,18 @@ int ff_v4l2_buffer_initialize(V4L2Buffer* avbuf, int index)
             ctx->format.fmt.pix_mp.plane_fmt[i].bytesperline :
             ctx->format.fmt.pix.bytesperline;
 
+        avbuf->plane_info[i].length = V4L2_TYPE_IS_MULTIPLANAR(ctx->type) ?
+            avbuf->buf.m.planes[i].length : avbuf->buf.length;
+
+        /* imported buffers are only attached when enqueued */
+        if (ctx->memory == V4L2_MEMORY_DMABUF)
+            continue;
+
         if (V4L2_TYPE_IS_MULTIPLANAR(ctx->type)) {
-            avbuf->plane_info[i].length = avbuf->buf.m.planes[i].length;
             avbuf->plane_info[i].mm_addr = mmap(NULL, avbuf->buf.m.planes[i].length,
                                            PROT_READ | PROT_WRITE, MAP_SHARED,
                                            buf_to_m2mctx(avbuf)->fd, avbuf->buf.m.planes[i].m.mem_offset);
         } else {
-            avbuf->plane_info[i].length = avbuf->buf.length;
             avbuf->plane_info[i].mm_addr = mmap(NULL, avbuf->buf.length,
                                           PROT_READ | PROT_WRITE, MAP_SHARED,
                                           buf_to_m2mctx(avbuf)->fd, avbuf->buf.m.offset);
@@ -546,6 +741,12 @@ int ff_v4l2_buffer_initialize(V4L2Buffer* avbuf, int index)
     if (V4L2_TYPE_IS_OUTPUT(ctx->type))
         return 0;
 
+    if (buf_to_m2mctx(avbuf)->output_drm) {
+        ret = v4l2_buffer_export_drm(avbuf);
+        if (ret)
+            return ret;
+    }
+
     if (V4L2_TYPE_IS_MULTIPLANAR(ctx->type)) {
         avbuf->buf.m.planes = avbuf->planes;
         avbuf->buf.length   = avbuf->num_planes;
@@ -558,6 +759,41 @@ int ff_v4l2_buffer_initialize(V4L2Buffer* avbuf, int index)
     return ff_v4l2_buffer_enqueue(avbuf);
 }
 
+void ff_v4l2_buffer_release(V4L2Buffer* avbuf)
+{
+    int i;
+
+    for (i = 0; i < avbuf->num_planes; i++) {
+        struct V4L2Plane_info *p = &avbuf->plane_info[i];
+        if (p->mm_addr && p->length)
+            if (munmap(p->mm_addr, p->length) < 0)
+                av_log(logger(avbuf), AV_LOG_ERROR, "%s unmap plane (%s))\n",
+                       avbuf->context->name, av_err2str(AVERROR(errno)));
+    }
+
+    for (i = 0; i < avbuf->drm_frame.nb_objects; i++)
+        close(avbuf->drm_frame.objects[i].fd);
+
+    av_frame_free(&avbuf->frame);
+}
+
+int ff_v4l2_buffer_orphan(V4L2Buffer* avbuf, AVBufferRef *buffers_ref)
+{
+    avbuf->orphan_ref = av_buffer_ref(buffers_ref);
+    if (!avbuf->orphan_ref) {
+        /* keep the mapping alive rather than pulling it from the user */
+        av_log(logger(avbuf), AV_LOG_ERROR, "%s: leaking a buffer held by the user\n",
+               avbuf->context->name);
+        return 1;
+    }
+
+    if (atomic_fetch_add(&avbuf->orphan_sync, 1) == 0)
+        return 1;
+
+    av_buffer_unref(&avbuf->orphan_ref);
+    return 0;
+}
+
 int ff_v4l2_buffer_enqueue(V4L2Buffer* avbuf)
 {
     int ret;
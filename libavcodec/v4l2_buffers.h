@@ -30,6 +30,7 @@
 
 #include "libavutil/buffer.h"
 #include "libavutil/frame.h"
+#include "libavutil/hwcontext_drm.h"
 #include "packet.h"
 
 enum V4L2Buffer_status {
@@ -50,6 +51,13 @@ typedef struct V4L2Buffer {
     AVBufferRef *context_ref;
     atomic_uint context_refcount;
 
+    /* When the queue is reallocated while the user still holds the buffer,
+     * the buffer keeps its mapping and a reference to the buffer array
+     * (orphan_ref) until it is returned. orphan_sync decides whether the
+     * queue release or the last unref does the cleanup. */
+    AVBufferRef *orphan_ref;
+    atomic_uint orphan_sync;
+
     /* keep track of the mmap address and mmap length */
     struct V4L2Plane_info {
         int bytesperline;
@@ -63,6 +71,14 @@ typedef struct V4L2Buffer {
     struct v4l2_buffer buf;
     struct v4l2_plane planes[VIDEO_MAX_PLANES];
 
+    /* DRM PRIME descriptor referencing the dmabuf fds exported from the
+     * planes; only set up on the capture queue when outputting DRM_PRIME */
+    AVDRMFrameDescriptor drm_frame;
+
+    /* DRM PRIME frame imported into an output buffer, held until the
+     * buffer is dequeued from the driver */
+    AVFrame *frame;
+
     int flags;
     enum V4L2Buffer_status status;
 
@@ -121,6 +137,25 @@ int ff_v4l2_buffer_avframe_to_buf(const AVFrame *frame, V4L2Buffer *out);
  */
 int ff_v4l2_buffer_initialize(V4L2Buffer* avbuf, int index);
 
+/**
+ * Unmaps a V4L2Buffer and closes the dmabuf fds exported from it
+ *
+ * @param[in] avbuf V4L2Bfuffer to release
+ */
+void ff_v4l2_buffer_release(V4L2Buffer* avbuf);
+
+/**
+ * Orphans a V4L2Buffer held by the user before its queue is released:
+ * the buffer stays mapped until the user returns it.
+ *
+ * @param[in] avbuf V4L2Bfuffer to orphan
+ * @param[in] buffers_ref reference to the array holding avbuf
+ *
+ * @returns 1 if the buffer was orphaned, 0 if it was already returned and
+ * can be released now
+ */
+int ff_v4l2_buffer_orphan(V4L2Buffer* avbuf, AVBufferRef *buffers_ref);
+
 /**
  * Enqueues a V4L2Buffer
  *
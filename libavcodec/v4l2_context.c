@@ -27,6 +27,7 @@
 #include <unistd.h>
 #include <fcntl.h>
 #include <poll.h>
+#include "libavutil/hwcontext.h"
 #include "libavcodec/avcodec.h"
 #include "libavcodec/internal.h"
 #include "v4l2_buffers.h"
@@ -168,6 +169,220 @@ static int v4l2_start_decode(V4L2Context *ctx)
     return 0;
 }
 
+/**
+ * Add buffers to a streaming queue with VIDIOC_CREATE_BUFS. Capture buffers
+ * are handed to the driver straight away.
+ * returns the number of buffers added, negative on error
+ */
+static int v4l2_grow_buffers(V4L2Context *ctx, int count)
+{
+    struct v4l2_create_buffers create = { 0 };
+    int ret, i;
+
+    count = FFMIN(count, ctx->max_buffers - ctx->num_buffers);
+    if (count <= 0)
+        return AVERROR(ENOMEM);
+
+    create.count  = count;
+    create.memory = ctx->memory;
+    create.format = ctx->format;
+    ret = ioctl(ctx_to_m2mctx(ctx)->fd, VIDIOC_CREATE_BUFS, &create);
+    if (ret < 0)
+        return AVERROR(errno);
+
+    if (create.index != ctx->num_buffers ||
+        create.count > ctx->max_buffers - ctx->num_buffers)
+        return AVERROR(EINVAL);
+
+    for (i = create.index; i < create.index + create.count; i++) {
+        ctx->buffers[i].context = ctx;
+        ret = ff_v4l2_buffer_initialize(&ctx->buffers[i], i);
+        if (ret < 0)
+            return ret;
+        ctx->num_buffers++;
+    }
+
+    av_log(logger(ctx), AV_LOG_VERBOSE, "%s: grown to %d buffers\n", ctx->name, ctx->num_buffers);
+
+    return create.count;
+}
+
+/**
+ * Check whether the capture buffers can hold the frames of a new format:
+ * same pixel format and plane count, and large enough planes.
+ */
+static int v4l2_format_fits(V4L2Context *ctx, struct v4l2_format *fmt)
+{
+    int multiplanar = V4L2_TYPE_IS_MULTIPLANAR(ctx->type);
+    int num_planes = multiplanar ? fmt->fmt.pix_mp.num_planes : 1;
+    int i;
+
+    if (!ctx->buffers || !ctx->num_buffers)
+        return 0;
+
+    if (multiplanar ? fmt->fmt.pix_mp.pixelformat != ctx->format.fmt.pix_mp.pixelformat ||
+                      num_planes != ctx->format.fmt.pix_mp.num_planes
+                    : fmt->fmt.pix.pixelformat != ctx->format.fmt.pix.pixelformat)
+        return 0;
+
+    for (i = 0; i < num_planes; i++) {
+        uint32_t sizeimage = multiplanar ? fmt->fmt.pix_mp.plane_fmt[i].sizeimage :
+                                           fmt->fmt.pix.sizeimage;
+        if (sizeimage > ctx->buffers[0].plane_info[i].length)
+            return 0;
+    }
+
+    return 1;
+}
+
+/**
+ * Replace the DRM PRIME frames context by one of the new frame size; the
+ * frames already returned keep a reference to the previous one.
+ */
+static int v4l2_update_drm_frames(V4L2m2mContext *s, struct v4l2_format *fmt)
+{
+    AVHWFramesContext *prev, *hwframes;
+    AVBufferRef *frames_ref;
+    int ret;
+
+    if (!s->frames_ref)
+        return 0;
+
+    prev = (AVHWFramesContext *)s->frames_ref->data;
+    frames_ref = av_hwframe_ctx_alloc(prev->device_ref);
+    if (!frames_ref)
+        return AVERROR(ENOMEM);
+
+    hwframes = (AVHWFramesContext *)frames_ref->data;
+    hwframes->format    = prev->format;
+    hwframes->sw_format = prev->sw_format;
+    hwframes->width     = v4l2_get_width(fmt);
+    hwframes->height    = v4l2_get_height(fmt);
+
+    ret = av_hwframe_ctx_init(frames_ref);
+    if (ret < 0) {
+        av_buffer_unref(&frames_ref);
+        return ret;
+    }
+
+    av_buffer_unref(&s->frames_ref);
+    s->frames_ref = frames_ref;
+
+    return 0;
+}
+
+/**
+ * Switch the capture queue to a new format without reallocating its buffers.
+ * Must only be called once the driver has returned every frame of the
+ * previous format.
+ * returns 1 if the format was updated, 0 if the buffers must be reallocated
+ */
+static int v4l2_update_format_in_place(V4L2Context *ctx, struct v4l2_format *fmt)
+{
+    V4L2m2mContext *s = ctx_to_m2mctx(ctx);
+    struct v4l2_selection selection = { 0 };
+    struct v4l2_control ctrl = { 0 };
+    int multiplanar = V4L2_TYPE_IS_MULTIPLANAR(ctx->type);
+    int num_planes = multiplanar ? fmt->fmt.pix_mp.num_planes : 1;
+    int i, j;
+
+    if (!v4l2_format_fits(ctx, fmt))
+        return 0;
+
+    /* the driver may need more buffers for the new stream */
+    ctrl.id = V4L2_CID_MIN_BUFFERS_FOR_CAPTURE;
+    if (!ioctl(s->fd, VIDIOC_G_CTRL, &ctrl) && ctrl.value > ctx->num_buffers &&
+        v4l2_grow_buffers(ctx, ctrl.value - ctx->num_buffers) < ctrl.value - ctx->num_buffers)
+        return 0;
+
+    if (v4l2_update_drm_frames(s, fmt) < 0)
+        return 0;
+
+    ctx->format = *fmt;
+    ctx->width  = v4l2_get_width(fmt);
+    ctx->height = v4l2_get_height(fmt);
+    ctx->sample_aspect_ratio = v4l2_get_sar(ctx);
+    for (i = 0; i < ctx->num_buffers; i++) {
+        for (j = 0; j < num_planes; j++)
+            ctx->buffers[i].plane_info[j].bytesperline = multiplanar ?
+                fmt->fmt.pix_mp.plane_fmt[j].bytesperline : fmt->fmt.pix.bytesperline;
+    }
+
+    /* frames are cropped to the visible area of the new stream */
+    selection.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
+    selection.target = V4L2_SEL_TGT_COMPOSE;
+    if (!ioctl(s->fd, VIDIOC_G_SELECTION, &selection) &&
+        selection.r.width && selection.r.height) {
+        ctx->width  = selection.r.width;
+        ctx->height = selection.r.height;
+    }
+
+    av_log(logger(ctx), AV_LOG_DEBUG, "%s: %dx%d handled without reallocation\n",
+           ctx->name, ctx->width, ctx->height);
+
+    return 1;
+}
+
+/**
+ * Reallocate the capture buffers for the format the driver reports.
+ * returns 1 if reinit was successful, negative if it failed
+ */
+static int v4l2_reinit_capture(V4L2Context *ctx, struct v4l2_format *fmt)
+{
+    V4L2m2mContext *s = ctx_to_m2mctx(ctx);
+    int ret = 0;
+
+    s->capture.height = v4l2_get_height(fmt);
+    s->capture.width = v4l2_get_width(fmt);
+    s->capture.sample_aspect_ratio = v4l2_get_sar(&s->capture);
+
+    s->reinit = 1;
+
+    if (s->avctx)
+        ret = ff_set_dimensions(s->avctx, s->capture.width, s->capture.height);
+    if (ret < 0)
+        av_log(logger(ctx), AV_LOG_WARNING, "update avcodec height and width\n");
+
+    ret = ff_v4l2_m2m_codec_reinit(s);
+    if (ret) {
+        av_log(logger(ctx), AV_LOG_ERROR, "v4l2_m2m_codec_reinit\n");
+        return AVERROR(EINVAL);
+    }
+
+    /* reinit executed */
+    return 1;
+}
+
+/**
+ * Restart decoding after the driver has returned its last buffer of the
+ * previous stream, switching to the pending format if there is one.
+ * returns 1 if reinit was successful, negative if it failed, 0 otherwise
+ */
+static int v4l2_resume_decode(V4L2Context *ctx)
+{
+    V4L2m2mContext *s = ctx_to_m2mctx(ctx);
+    int ret = 0;
+
+    ctx->last_dequeued = 0;
+
+    if (ctx->format_pending) {
+        ctx->format_pending = 0;
+
+        /* reallocating is the fallback: the buffers no longer fit, or the
+         * driver cannot provide the extra ones the new stream needs */
+        if (!v4l2_update_format_in_place(ctx, &ctx->pending_format))
+            return v4l2_reinit_capture(ctx, &ctx->pending_format);
+
+        if (s->avctx)
+            ret = ff_set_dimensions(s->avctx, ctx->width, ctx->height);
+        if (ret < 0)
+            av_log(logger(ctx), AV_LOG_WARNING, "update avcodec height and width\n");
+    }
+
+    v4l2_start_decode(ctx);
+    return 0;
+}
+
 /**
  * handle resolution change event and end of stream event
  * returns 1 if reinit was successful, negative if it failed
@@ -200,30 +415,21 @@ static int v4l2_handle_event(V4L2Context *ctx)
         return 0;
     }
 
-    if (v4l2_resolution_changed(&s->capture, &cap_fmt)) {
-        s->capture.height = v4l2_get_height(&cap_fmt);
-        s->capture.width = v4l2_get_width(&cap_fmt);
-        s->capture.sample_aspect_ratio = v4l2_get_sar(&s->capture);
-    } else {
+    if (!v4l2_resolution_changed(&s->capture, &cap_fmt)) {
         v4l2_start_decode(ctx);
         return 0;
     }
 
-    s->reinit = 1;
-
-    if (s->avctx)
-        ret = ff_set_dimensions(s->avctx, s->capture.width, s->capture.height);
-    if (ret < 0)
-        av_log(logger(ctx), AV_LOG_WARNING, "update avcodec height and width\n");
-
-    ret = ff_v4l2_m2m_codec_reinit(s);
-    if (ret) {
-        av_log(logger(ctx), AV_LOG_ERROR, "v4l2_m2m_codec_reinit\n");
-        return AVERROR(EINVAL);
+    /* the current buffers can hold the new frames: keep dequeuing the frames
+     * of the previous stream and switch format after the last one, see
+     * v4l2_resume_decode() */
+    if (v4l2_format_fits(&s->capture, &cap_fmt)) {
+        s->capture.pending_format = cap_fmt;
+        s->capture.format_pending = 1;
+        return 0;
     }
 
-    /* reinit executed */
-    return 1;
+    return v4l2_reinit_capture(ctx, &cap_fmt);
 }
 
 static int v4l2_stop_decode(V4L2Context *ctx)
@@ -275,14 +481,25 @@ static V4L2Buffer* v4l2_dequeue_v4l2buf(V4L2Context *ctx, int timeout)
         .events =  POLLIN | POLLRDNORM | POLLPRI | POLLOUT | POLLWRNORM, /* default blocking capture */
         .fd = ctx_to_m2mctx(ctx)->fd,
     };
-    int i, ret;
+    int i, ret, in_driver;
+
+    /* the frame flagged V4L2_BUF_FLAG_LAST has been returned to the user */
+    if (ctx->last_dequeued) {
+        ret = v4l2_resume_decode(ctx);
+        if (ret < 0) {
+            ctx->done = 1;
+            return NULL;
+        }
+        if (ret)
+            return NULL;
+    }
 
     if (!V4L2_TYPE_IS_OUTPUT(ctx->type) && ctx->buffers) {
         for (i = 0; i < ctx->num_buffers; i++) {
             if (ctx->buffers[i].status == V4L2BUF_IN_DRIVER)
                 break;
         }
-        if (i == ctx->num_buffers)
+        if (i == ctx->num_buffers && (!ctx->streamon || v4l2_grow_buffers(ctx, 4) <= 0))
             av_log(logger(ctx), AV_LOG_WARNING, "All capture buffers returned to "
                                                 "userspace. Increase num_capture_buffers "
                                                 "to prevent device deadlock or dropped "
@@ -372,7 +589,7 @@ start:
 
 dequeue:
         memset(&buf, 0, sizeof(buf));
-        buf.memory = V4L2_MEMORY_MMAP;
+        buf.memory = ctx->memory;
         buf.type = ctx->type;
         if (V4L2_TYPE_IS_MULTIPLANAR(ctx->type)) {
             memset(planes, 0, sizeof(planes));
@@ -382,6 +599,12 @@ dequeue:
 
         ret = ioctl(ctx_to_m2mctx(ctx)->fd, VIDIOC_DQBUF, &buf);
         if (ret) {
+            /* the driver stopped after the last frame of the previous stream */
+            if (errno == EPIPE && ctx->format_pending) {
+                if (v4l2_resume_decode(ctx) < 0)
+                    ctx->done = 1;
+                return NULL;
+            }
             if (errno != EAGAIN) {
                 ctx->done = 1;
                 if (errno != EPIPE)
@@ -404,9 +627,49 @@ dequeue:
 #endif
         }
 
+#ifdef V4L2_BUF_FLAG_LAST
+        /* outside of draining, the driver flags the last frame before a
+         * resolution change and stops until decoding is restarted */
+        if (!ctx_to_m2mctx(ctx)->draining && !V4L2_TYPE_IS_OUTPUT(ctx->type) &&
+            buf.flags & V4L2_BUF_FLAG_LAST) {
+            int bytesused = V4L2_TYPE_IS_MULTIPLANAR(buf.type) ?
+                            buf.m.planes[0].bytesused : buf.bytesused;
+
+            ctx->last_dequeued = 1;
+            if (bytesused == 0) {
+                /* no frame: restart now and give the buffer back */
+                avbuf = &ctx->buffers[buf.index];
+                avbuf->status = V4L2BUF_AVAILABLE;
+                ret = v4l2_resume_decode(ctx);
+                if (ret < 0)
+                    ctx->done = 1;
+                else if (!ret) {
+                    avbuf->buf = buf;
+                    if (V4L2_TYPE_IS_MULTIPLANAR(ctx->type)) {
+                        memcpy(avbuf->planes, planes, sizeof(planes));
+                        avbuf->buf.m.planes = avbuf->planes;
+                    }
+                    ff_v4l2_buffer_enqueue(avbuf);
+                }
+                return NULL;
+            }
+        }
+#endif
+
+        /* the dequeued buffer is still accounted as owned by the driver */
+        for (i = 0, in_driver = 0; i < ctx->num_buffers; i++) {
+            if (ctx->buffers[i].status == V4L2BUF_IN_DRIVER)
+                in_driver++;
+        }
+        ctx->nb_dequeued++;
+        ctx->occupancy_sum += in_driver;
+        ctx->occupancy_max  = FFMAX(ctx->occupancy_max, in_driver);
+
         avbuf = &ctx->buffers[buf.index];
         avbuf->status = V4L2BUF_AVAILABLE;
         avbuf->buf = buf;
+        /* the driver is done with the imported frame */
+        av_frame_free(&avbuf->frame);
         if (V4L2_TYPE_IS_MULTIPLANAR(ctx->type)) {
             memcpy(avbuf->planes, planes, sizeof(planes));
             avbuf->buf.m.planes = avbuf->planes;
@@ -422,6 +685,11 @@ static V4L2Buffer* v4l2_getfree_v4l2buf(V4L2Context *ctx)
     int timeout = 0; /* return when no more buffers to dequeue */
     int i;
 
+    /* Unlike the capture queue, the output queue is not grown at runtime:
+     * the driver returns an output buffer as soon as it has consumed its
+     * data, so running out of them only means the hardware is busy, and the
+     * caller polls until one is back. Its size is set with num_output_buffers. */
+
     /* get back as many output buffers as possible */
     if (V4L2_TYPE_IS_OUTPUT(ctx->type)) {
           do {
@@ -436,24 +704,67 @@ static V4L2Buffer* v4l2_getfree_v4l2buf(V4L2Context *ctx)
     return NULL;
 }
 
+/**
+ * Allocate the buffers with VIDIOC_CREATE_BUFS, scaling the plane sizes of
+ * the current format up to max_width x max_height, so that later resolution
+ * changes up to that size can reuse them.
+ */
+static int v4l2_create_max_buffers(V4L2Context *ctx, struct v4l2_requestbuffers *req)
+{
+    struct v4l2_create_buffers create = {
+        .count  = req->count,
+        .memory = req->memory,
+        .format = ctx->format,
+    };
+    uint64_t width  = v4l2_get_width(&ctx->format);
+    uint64_t height = v4l2_get_height(&ctx->format);
+    int ret, i;
+
+    if (width && height && (ctx->max_width > width || ctx->max_height > height)) {
+        uint64_t num = FFMAX(ctx->max_width, width) * FFMAX(ctx->max_height, height);
+        uint64_t den = width * height;
+
+        if (V4L2_TYPE_IS_MULTIPLANAR(ctx->type)) {
+            for (i = 0; i < create.format.fmt.pix_mp.num_planes; i++) {
+                struct v4l2_plane_pix_format *p = &create.format.fmt.pix_mp.plane_fmt[i];
+                p->sizeimage = FFMIN((p->sizeimage * num + den - 1) / den, UINT32_MAX);
+            }
+        } else {
+            struct v4l2_pix_format *p = &create.format.fmt.pix;
+            p->sizeimage = FFMIN((p->sizeimage * num + den - 1) / den, UINT32_MAX);
+        }
+    }
+
+    ret = ioctl(ctx_to_m2mctx(ctx)->fd, VIDIOC_CREATE_BUFS, &create);
+    if (ret < 0)
+        return ret;
+
+    req->count = create.count;
+#ifdef V4L2_BUF_CAP_SUPPORTS_ORPHANED_BUFS
+    req->capabilities = create.capabilities;
+#endif
+
+    return 0;
+}
+
 static int v4l2_release_buffers(V4L2Context* ctx)
 {
     struct v4l2_requestbuffers req = {
-        .memory = V4L2_MEMORY_MMAP,
+        .memory = ctx->memory,
         .type = ctx->type,
         .count = 0, /* 0 -> unmaps buffers from the driver */
     };
-    int i, j;
+    int i;
 
     for (i = 0; i < ctx->num_buffers; i++) {
         V4L2Buffer *buffer = &ctx->buffers[i];
 
-        for (j = 0; j < buffer->num_planes; j++) {
-            struct V4L2Plane_info *p = &buffer->plane_info[j];
-            if (p->mm_addr && p->length)
-                if (munmap(p->mm_addr, p->length) < 0)
-                    av_log(logger(ctx), AV_LOG_ERROR, "%s unmap plane (%s))\n", ctx->name, av_err2str(AVERROR(errno)));
-        }
+        /* buffers still held by the user are freed once returned */
+        if (ctx->orphaned_bufs && buffer->status == V4L2BUF_RET_USER &&
+            ff_v4l2_buffer_orphan(buffer, ctx->buffers_ref))
+            continue;
+
+        ff_v4l2_buffer_release(buffer);
     }
 
     return ioctl(ctx_to_m2mctx(ctx)->fd, VIDIOC_REQBUFS, &req);
@@ -591,7 +902,11 @@ int ff_v4l2_context_enqueue_frame(V4L2Context* ctx, const AVFrame* frame)
     if (ret)
         return ret;
 
-    return ff_v4l2_buffer_enqueue(avbuf);
+    ret = ff_v4l2_buffer_enqueue(avbuf);
+    if (ret)
+        av_frame_free(&avbuf->frame);
+
+    return ret;
 }
 
 int ff_v4l2_context_enqueue_packet(V4L2Context* ctx, const AVPacket* pkt)
@@ -702,7 +1017,8 @@ void ff_v4l2_context_release(V4L2Context* ctx)
     if (ret)
         av_log(logger(ctx), AV_LOG_WARNING, "V4L2 failed to unmap the %s buffers\n", ctx->name);
 
-    av_freep(&ctx->buffers);
+    av_buffer_unref(&ctx->buffers_ref);
+    ctx->buffers = NULL;
 }
 
 int ff_v4l2_context_init(V4L2Context* ctx)
@@ -722,16 +1038,26 @@ int ff_v4l2_context_init(V4L2Context* ctx)
 
     memset(&req, 0, sizeof(req));
     req.count = ctx->num_buffers;
-    req.memory = V4L2_MEMORY_MMAP;
+    req.memory = ctx->memory;
     req.type = ctx->type;
-    ret = ioctl(s->fd, VIDIOC_REQBUFS, &req);
+    if (ctx->max_width && ctx->max_height)
+        ret = v4l2_create_max_buffers(ctx, &req);
+    else
+        ret = ioctl(s->fd, VIDIOC_REQBUFS, &req);
     if (ret < 0) {
         av_log(logger(ctx), AV_LOG_ERROR, "%s VIDIOC_REQBUFS failed: %s\n", ctx->name, strerror(errno));
         return AVERROR(errno);
     }
 
+#ifdef V4L2_BUF_CAP_SUPPORTS_ORPHANED_BUFS
+    ctx->orphaned_bufs = !!(req.capabilities & V4L2_BUF_CAP_SUPPORTS_ORPHANED_BUFS);
+#endif
+
+    /* leave room for growing the queue at runtime */
     ctx->num_buffers = req.count;
-    ctx->buffers = av_mallocz(ctx->num_buffers * sizeof(V4L2Buffer));
+    ctx->max_buffers = FFMAX(req.count, VIDEO_MAX_FRAME);
+    ctx->buffers_ref = av_buffer_allocz(ctx->max_buffers * sizeof(V4L2Buffer));
+    ctx->buffers = ctx->buffers_ref ? (V4L2Buffer *)ctx->buffers_ref->data : NULL;
     if (!ctx->buffers) {
         av_log(logger(ctx), AV_LOG_ERROR, "%s malloc enomem\n", ctx->name);
         return AVERROR(ENOMEM);
@@ -759,7 +1085,8 @@ int ff_v4l2_context_init(V4L2Context* ctx)
 error:
     v4l2_release_buffers(ctx);
 
-    av_freep(&ctx->buffers);
+    av_buffer_unref(&ctx->buffers_ref);
+    ctx->buffers = NULL;
 
     return ret;
 }
@@ -73,15 +73,65 @@ typedef struct V4L2Context {
     AVRational sample_aspect_ratio;
 
     /**
-     * Indexed array of V4L2Buffers
+     * Memory type of the buffers: V4L2_MEMORY_MMAP, or V4L2_MEMORY_DMABUF
+     * for an output context importing DRM PRIME frames.
+     * Readonly after init.
+     */
+    enum v4l2_memory memory;
+
+    /**
+     * Indexed array of V4L2Buffers, owned by buffers_ref: buffers still held
+     * by the user when the queue is released keep the array alive.
      */
     V4L2Buffer *buffers;
+    AVBufferRef *buffers_ref;
 
     /**
-     * Readonly after init.
+     * The driver lets buffers outlive their queue (orphaned buffers), so it
+     * can be reallocated without waiting for the user to return them.
+     */
+    int orphaned_bufs;
+
+    /**
+     * If set, the buffers are allocated for frames up to this size, so that
+     * resolution changes within it do not require a reallocation.
+     */
+    int max_width, max_height;
+
+    /**
+     * Format of the new stream after a resolution change the buffers can
+     * hold. The driver still returns frames of the previous stream until it
+     * flags one with V4L2_BUF_FLAG_LAST, so the switch waits for that buffer.
+     */
+    struct v4l2_format pending_format;
+    int format_pending;
+
+    /**
+     * The driver has stopped after a buffer flagged V4L2_BUF_FLAG_LAST
+     * outside of draining: decoding must be restarted.
+     */
+    int last_dequeued;
+
+    /**
+     * Number of buffers requested from the driver. It only changes after init
+     * when the queue is grown at runtime, up to max_buffers.
      */
     int num_buffers;
 
+    /**
+     * Number of entries allocated in buffers.
+     */
+    int max_buffers;
+
+    /**
+     * Queue occupancy statistics, sampled each time a buffer is dequeued:
+     * the number of buffers still owned by the driver at that time tells
+     * how well the hardware is kept busy.
+     */
+    uint64_t nb_dequeued;
+    uint64_t occupancy_sum;
+    int occupancy_max;
+
     /**
      * Whether the stream has been started (VIDIOC_STREAMON has been sent).
      */
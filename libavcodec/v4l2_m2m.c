@@ -215,12 +215,14 @@ int ff_v4l2_m2m_codec_reinit(V4L2m2mContext *s)
         av_log(log_ctx, AV_LOG_ERROR, "capture VIDIOC_STREAMOFF\n");
 
     /* 2. unmap the capture buffers (v4l2 and ffmpeg):
-     *    we must wait for all references to be released before being allowed
-     *    to queue new buffers.
+     *    unless the driver supports orphaned buffers, we must wait for all
+     *    references to be released before being allowed to queue new buffers.
      */
-    av_log(log_ctx, AV_LOG_DEBUG, "waiting for user to release AVBufferRefs\n");
-    if (atomic_load(&s->refcount))
-        while(sem_wait(&s->refsync) == -1 && errno == EINTR);
+    if (!s->capture.orphaned_bufs) {
+        av_log(log_ctx, AV_LOG_DEBUG, "waiting for user to release AVBufferRefs\n");
+        if (atomic_load(&s->refcount))
+            while(sem_wait(&s->refsync) == -1 && errno == EINTR);
+    }
 
     ff_v4l2_context_release(&s->capture);
 
@@ -332,10 +334,23 @@ static void v4l2_m2m_destroy_context(void *opaque, uint8_t *context)
     av_frame_unref(s->frame);
     av_frame_free(&s->frame);
     av_packet_unref(&s->buf_pkt);
+    av_buffer_unref(&s->frames_ref);
+    av_buffer_unref(&s->device_ref);
 
     av_free(s);
 }
 
+static void v4l2_log_queue_stats(V4L2m2mContext *s, V4L2Context *ctx)
+{
+    if (!ctx->nb_dequeued)
+        return;
+
+    av_log(s->avctx, AV_LOG_VERBOSE, "%s queue: %"PRIu64" buffers dequeued, "
+           "%.1f of %d buffers in the driver on average, %d at most\n",
+           ctx->name, ctx->nb_dequeued, (double)ctx->occupancy_sum / ctx->nb_dequeued,
+           ctx->num_buffers, ctx->occupancy_max);
+}
+
 int ff_v4l2_m2m_codec_end(V4L2m2mPriv *priv)
 {
     V4L2m2mContext *s = priv->context;
@@ -344,6 +359,9 @@ int ff_v4l2_m2m_codec_end(V4L2m2mPriv *priv)
     if (!s)
         return 0;
 
+    v4l2_log_queue_stats(s, &s->output);
+    v4l2_log_queue_stats(s, &s->capture);
+
     if (s->fd >= 0) {
         ret = ff_v4l2_context_set_status(&s->output, VIDIOC_STREAMOFF);
         if (ret)
@@ -420,6 +438,8 @@ int ff_v4l2_m2m_create_context(V4L2m2mPriv *priv, V4L2m2mContext **s)
     /* populate it */
     priv->context->capture.num_buffers = priv->num_capture_buffers;
     priv->context->output.num_buffers  = priv->num_output_buffers;
+    priv->context->capture.memory = V4L2_MEMORY_MMAP;
+    priv->context->output.memory  = V4L2_MEMORY_MMAP;
     priv->context->self_ref = priv->context_ref;
     priv->context->fd = -1;
 
@@ -61,6 +61,11 @@ typedef struct V4L2m2mContext {
     /* Reference to a frame. Only used during encoding */
     AVFrame *frame;
 
+    /* DRM PRIME output of the capture queue, negotiated by the decoder */
+    int output_drm;
+    AVBufferRef *device_ref;
+    AVBufferRef *frames_ref;
+
     /* Reference to self; only valid while codec is active. */
     AVBufferRef *self_ref;
 
@@ -76,6 +81,8 @@ typedef struct V4L2m2mPriv {
 
     int num_output_buffers;
     int num_capture_buffers;
+    int max_width;
+    int max_height;
 } V4L2m2mPriv;
 
 /**
@@ -23,17 +23,112 @@
 
 #include <linux/videodev2.h>
 #include <sys/ioctl.h>
+#include "libavutil/hwcontext.h"
+#include "libavutil/hwcontext_drm.h"
 #include "libavutil/pixfmt.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/opt.h"
 #include "libavcodec/avcodec.h"
 #include "libavcodec/decode.h"
+#include "libavcodec/hwconfig.h"
 #include "libavcodec/internal.h"
 
 #include "v4l2_context.h"
 #include "v4l2_m2m.h"
 #include "v4l2_fmt.h"
 
+static int v4l2_init_drm_frames(AVCodecContext *avctx, V4L2m2mContext *s)
+{
+    V4L2Context *const capture = &s->capture;
+    AVHWFramesContext *hwframes;
+    int ret;
+
+    if (!s->device_ref) {
+        if (avctx->hw_device_ctx &&
+            ((AVHWDeviceContext *)avctx->hw_device_ctx->data)->type == AV_HWDEVICE_TYPE_DRM) {
+            s->device_ref = av_buffer_ref(avctx->hw_device_ctx);
+            if (!s->device_ref)
+                return AVERROR(ENOMEM);
+        } else {
+            AVHWDeviceContext *device;
+
+            s->device_ref = av_hwdevice_ctx_alloc(AV_HWDEVICE_TYPE_DRM);
+            if (!s->device_ref)
+                return AVERROR(ENOMEM);
+
+            /* the dmabufs are exported by the V4L2 device, no DRM node is needed */
+            device = (AVHWDeviceContext *)s->device_ref->data;
+            ((AVDRMDeviceContext *)device->hwctx)->fd = -1;
+
+            ret = av_hwdevice_ctx_init(s->device_ref);
+            if (ret < 0) {
+                av_buffer_unref(&s->device_ref);
+                return ret;
+            }
+        }
+    }
+
+    av_buffer_unref(&s->frames_ref);
+    s->frames_ref = av_hwframe_ctx_alloc(s->device_ref);
+    if (!s->frames_ref)
+        return AVERROR(ENOMEM);
+
+    hwframes = (AVHWFramesContext *)s->frames_ref->data;
+    hwframes->format    = AV_PIX_FMT_DRM_PRIME;
+    hwframes->sw_format = capture->av_pix_fmt;
+    hwframes->width     = V4L2_TYPE_IS_MULTIPLANAR(capture->type) ?
+                          capture->format.fmt.pix_mp.width : capture->format.fmt.pix.width;
+    hwframes->height    = V4L2_TYPE_IS_MULTIPLANAR(capture->type) ?
+                          capture->format.fmt.pix_mp.height : capture->format.fmt.pix.height;
+
+    ret = av_hwframe_ctx_init(s->frames_ref);
+    if (ret < 0)
+        av_buffer_unref(&s->frames_ref);
+
+    return ret;
+}
+
+/* Let the user pick between DRM PRIME frames referencing the capture buffers
+ * and software frames mapping them; must be called before the capture buffers
+ * are initialized, as exporting them depends on the choice. */
+static int v4l2_negotiate_format(AVCodecContext *avctx)
+{
+    V4L2m2mContext *s = ((V4L2m2mPriv*)avctx->priv_data)->context;
+    V4L2Context *const capture = &s->capture;
+    enum AVPixelFormat pix_fmts[3];
+    int nb_fmts = 0;
+    int ret;
+
+    s->output_drm = 0;
+
+    if (capture->av_pix_fmt == AV_PIX_FMT_NONE) {
+        avctx->pix_fmt = AV_PIX_FMT_NONE;
+        return 0;
+    }
+
+    if (ff_v4l2_format_avfmt_to_drm(capture->av_pix_fmt))
+        pix_fmts[nb_fmts++] = AV_PIX_FMT_DRM_PRIME;
+    pix_fmts[nb_fmts++] = capture->av_pix_fmt;
+    pix_fmts[nb_fmts]   = AV_PIX_FMT_NONE;
+
+    ret = ff_get_format(avctx, pix_fmts);
+    if (ret < 0)
+        return ret;
+
+    avctx->pix_fmt = ret;
+    if (avctx->pix_fmt != AV_PIX_FMT_DRM_PRIME)
+        return 0;
+
+    ret = v4l2_init_drm_frames(avctx, s);
+    if (ret < 0) {
+        av_log(avctx, AV_LOG_ERROR, "can't create the DRM frames context\n");
+        return ret;
+    }
+    s->output_drm = 1;
+
+    return 0;
+}
+
 static int v4l2_try_start(AVCodecContext *avctx)
 {
     V4L2m2mContext *s = ((V4L2m2mPriv*)avctx->priv_data)->context;
@@ -63,8 +158,7 @@ static int v4l2_try_start(AVCodecContext *avctx)
     }
 
     /* 2.1 update the AVCodecContext */
-    avctx->pix_fmt = ff_v4l2_format_v4l2_to_avfmt(capture->format.fmt.pix_mp.pixelformat, AV_CODEC_ID_RAWVIDEO);
-    capture->av_pix_fmt = avctx->pix_fmt;
+    capture->av_pix_fmt = ff_v4l2_format_v4l2_to_avfmt(capture->format.fmt.pix_mp.pixelformat, AV_CODEC_ID_RAWVIDEO);
 
     /* 3. set the crop parameters */
     selection.type = V4L2_BUF_TYPE_VIDEO_CAPTURE;
@@ -85,6 +179,10 @@ static int v4l2_try_start(AVCodecContext *avctx)
 
     /* 4. init the capture context now that we have the capture format */
     if (!capture->buffers) {
+        ret = v4l2_negotiate_format(avctx);
+        if (ret < 0)
+            return ret;
+
         ret = ff_v4l2_context_init(capture);
         if (ret) {
             av_log(avctx, AV_LOG_ERROR, "can't request capture buffers\n");
@@ -138,41 +236,45 @@ static int v4l2_receive_frame(AVCodecContext *avctx, AVFrame *frame)
     V4L2m2mContext *s = ((V4L2m2mPriv*)avctx->priv_data)->context;
     V4L2Context *const capture = &s->capture;
     V4L2Context *const output = &s->output;
+    int timeout = -1;
     int ret;
 
-    if (!s->buf_pkt.size) {
-        ret = ff_decode_get_packet(avctx, &s->buf_pkt);
-        if (ret < 0) {
-            if (ret == AVERROR(EAGAIN))
-                return ff_v4l2_context_dequeue_frame(capture, frame, 0);
-            else if (ret != AVERROR_EOF)
+    /* 1. keep the output queue as full as the available input allows */
+    while (!s->draining) {
+        if (!s->buf_pkt.size) {
+            ret = ff_decode_get_packet(avctx, &s->buf_pkt);
+            if (ret == AVERROR(EAGAIN)) {
+                /* starved: only return a frame if one is already decoded */
+                timeout = 0;
+                break;
+            }
+            if (ret < 0 && ret != AVERROR_EOF)
                 return ret;
         }
-    }
 
-    if (s->draining)
-        goto dequeue;
-
-    ret = ff_v4l2_context_enqueue_packet(output, &s->buf_pkt);
-    if (ret < 0 && ret != AVERROR(EAGAIN))
-        goto fail;
+        ret = ff_v4l2_context_enqueue_packet(output, &s->buf_pkt);
+        /* the queue is full: keep the packet for the next call */
+        if (ret == AVERROR(EAGAIN))
+            break;
+        if (ret < 0)
+            goto fail;
 
-    /* if EAGAIN don't unref packet and try to enqueue in the next iteration */
-    if (ret != AVERROR(EAGAIN))
         av_packet_unref(&s->buf_pkt);
 
-    if (!s->draining) {
-        ret = v4l2_try_start(avctx);
-        if (ret) {
-            /* cant recover */
-            if (ret != AVERROR(ENOMEM))
-                ret = 0;
-            goto fail;
+        if (!s->draining) {
+            ret = v4l2_try_start(avctx);
+            if (ret) {
+                /* cant recover */
+                if (ret != AVERROR(ENOMEM))
+                    ret = 0;
+                goto fail;
+            }
         }
     }
 
-dequeue:
-    return ff_v4l2_context_dequeue_frame(capture, frame, -1);
+    /* 2. wait for a decoded frame or a free output buffer, whichever
+     *    comes first; the latter returns EAGAIN so the queue is refilled */
+    return ff_v4l2_context_dequeue_frame(capture, frame, timeout);
 fail:
     av_packet_unref(&s->buf_pkt);
     return ret;
@@ -204,6 +306,8 @@ static av_cold int v4l2_decode_init(AVCodecContext *avctx)
 
     capture->av_codec_id = AV_CODEC_ID_RAWVIDEO;
     capture->av_pix_fmt = avctx->pix_fmt;
+    capture->max_width  = priv->max_width;
+    capture->max_height = priv->max_height;
 
     s->avctx = avctx;
     ret = ff_v4l2_m2m_codec_init(priv);
@@ -227,9 +331,28 @@ static const AVOption options[] = {
     V4L_M2M_DEFAULT_OPTS,
     { "num_capture_buffers", "Number of buffers in the capture context",
         OFFSET(num_capture_buffers), AV_OPT_TYPE_INT, {.i64 = 20}, 20, INT_MAX, FLAGS },
+    { "max_width", "Allocate the capture buffers for frames up to this width",
+        OFFSET(max_width), AV_OPT_TYPE_INT, {.i64 = 0}, 0, INT_MAX, FLAGS },
+    { "max_height", "Allocate the capture buffers for frames up to this height",
+        OFFSET(max_height), AV_OPT_TYPE_INT, {.i64 = 0}, 0, INT_MAX, FLAGS },
     { NULL},
 };
 
+static const AVCodecHWConfigInternal *const v4l2_m2m_hw_configs[] = {
+#if CONFIG_LIBDRM
+    &(const AVCodecHWConfigInternal) {
+        .public = {
+            .pix_fmt     = AV_PIX_FMT_DRM_PRIME,
+            .methods     = AV_CODEC_HW_CONFIG_METHOD_HW_DEVICE_CTX |
+                           AV_CODEC_HW_CONFIG_METHOD_INTERNAL,
+            .device_type = AV_HWDEVICE_TYPE_DRM,
+        },
+        .hwaccel = NULL,
+    },
+#endif
+    NULL
+};
+
 #define M2MDEC_CLASS(NAME) \
     static const AVClass v4l2_m2m_ ## NAME ## _dec_class = { \
         .class_name = #NAME "_v4l2m2m_decoder", \
@@ -251,6 +374,7 @@ static const AVOption options[] = {
         .receive_frame  = v4l2_receive_frame, \
         .close          = v4l2_decode_close, \
         .bsfs           = bsf_name, \
+        .hw_configs     = v4l2_m2m_hw_configs, \
         .capabilities   = AV_CODEC_CAP_HARDWARE | AV_CODEC_CAP_DELAY | AV_CODEC_CAP_AVOID_PROBING, \
         .caps_internal  = FF_CODEC_CAP_SETS_PKT_DTS | FF_CODEC_CAP_INIT_CLEANUP, \
         .wrapper_name   = "v4l2m2m", \
@@ -26,7 +26,9 @@
 #include <search.h>
 #include "encode.h"
 #include "libavcodec/avcodec.h"
+#include "libavcodec/hwconfig.h"
 #include "libavcodec/internal.h"
+#include "libavutil/hwcontext.h"
 #include "libavutil/pixdesc.h"
 #include "libavutil/pixfmt.h"
 #include "libavutil/opt.h"
@@ -355,6 +357,21 @@ static av_cold int v4l2_encode_init(AVCodecContext *avctx)
     output->av_codec_id = AV_CODEC_ID_RAWVIDEO;
     output->av_pix_fmt = avctx->pix_fmt;
 
+    /* DRM PRIME frames are queued by importing their dmabufs; the driver
+     * is configured with the format of the underlying data */
+    if (avctx->pix_fmt == AV_PIX_FMT_DRM_PRIME) {
+        if (avctx->hw_frames_ctx)
+            output->av_pix_fmt = ((AVHWFramesContext *)avctx->hw_frames_ctx->data)->sw_format;
+        else
+            output->av_pix_fmt = avctx->sw_pix_fmt;
+
+        if (output->av_pix_fmt == AV_PIX_FMT_NONE) {
+            av_log(avctx, AV_LOG_ERROR, "DRM PRIME input requires hw_frames_ctx or sw_pix_fmt.\n");
+            return AVERROR(EINVAL);
+        }
+        output->memory = V4L2_MEMORY_DMABUF;
+    }
+
     /* capture context */
     capture->av_codec_id = avctx->codec_id;
     capture->av_pix_fmt = AV_PIX_FMT_NONE;
@@ -372,7 +389,7 @@ static av_cold int v4l2_encode_init(AVCodecContext *avctx)
         v4l2_fmt_output = output->format.fmt.pix.pixelformat;
 
     pix_fmt_output = ff_v4l2_format_v4l2_to_avfmt(v4l2_fmt_output, AV_CODEC_ID_RAWVIDEO);
-    if (pix_fmt_output != avctx->pix_fmt) {
+    if (pix_fmt_output != output->av_pix_fmt) {
         const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(pix_fmt_output);
         av_log(avctx, AV_LOG_ERROR, "Encoder requires %s pixel format.\n", desc->name);
         return AVERROR(EINVAL);
@@ -411,6 +428,11 @@ static const AVCodecDefault v4l2_m2m_defaults[] = {
     { NULL },
 };
 
+static const AVCodecHWConfigInternal *const v4l2_m2m_hw_configs[] = {
+    HW_CONFIG_ENCODER_FRAMES(DRM_PRIME, DRM),
+    NULL
+};
+
 #define M2MENC_CLASS(NAME, OPTIONS_NAME) \
     static const AVClass v4l2_m2m_ ## NAME ## _enc_class = { \
         .class_name = #NAME "_v4l2m2m_encoder", \
@@ -432,6 +454,7 @@ static const AVCodecDefault v4l2_m2m_defaults[] = {
         .receive_packet = v4l2_receive_packet, \
         .close          = v4l2_encode_close, \
         .defaults       = v4l2_m2m_defaults, \
+        .hw_configs     = v4l2_m2m_hw_configs, \
         .capabilities   = AV_CODEC_CAP_HARDWARE | AV_CODEC_CAP_DELAY, \
         .caps_internal  = FF_CODEC_CAP_INIT_CLEANUP, \
         .wrapper_name   = "v4l2m2m", \
@@ -149,14 +149,111 @@ static void lpc_compute_autocorr_sse2(const double *data, int len, int lag,
 
 #endif /* HAVE_SSE2_INLINE */
 
+#if HAVE_AVX2_INLINE
+
+#define AUTOCORR_INIT(acc)                                      \
+        "vmovapd   %%ymm0,        %%ymm"#acc"           \n\t"
+#define AUTOCORR_SUM(acc, prod)                                 \
+        "vmulpd    "#acc"*32(%2), %%ymm7, %%ymm"#prod"  \n\t"   \
+        "vaddpd    %%ymm"#prod",  %%ymm"#acc", %%ymm"#acc"  \n\t"
+#define AUTOCORR_STORE(acc)                                     \
+        "vmovapd   %%ymm"#acc",   "#acc"*32(%3)         \n\t"
+#define AUTOCORR_SUM_X                                          \
+        "vmulpd    (%2),          %%xmm7, %%xmm4        \n\t"   \
+        "vaddpd    %%xmm4,        %%xmm0, %%xmm0        \n\t"
+#define AUTOCORR_STORE_X                                        \
+        "vmovapd   %%xmm0,        (%3)                  \n\t"
+
+#define AUTOCORR_LOOP(init, sum, store)                         \
+    __asm__ volatile(                                           \
+        "vbroadcastsd %4,         %%ymm0                \n\t"   \
+        init                                                    \
+        "test      %0,            %0                    \n\t"   \
+        "jle 2f                                         \n\t"   \
+        "1:                                             \n\t"   \
+        "vbroadcastsd (%1),       %%ymm7                \n\t"   \
+        sum                                                     \
+        "add       $8,            %1                    \n\t"   \
+        "add       $8,            %2                    \n\t"   \
+        "sub       $1,            %0                    \n\t"   \
+        "jg 1b                                          \n\t"   \
+        "2:                                             \n\t"   \
+        store                                                   \
+        : "+&r"(count), "+&r"(cur), "+&r"(win)                  \
+        : "r"(sums), "m"(pd_1[0])                               \
+        : XMM_CLOBBERS("xmm0", "xmm1", "xmm2", "xmm3",          \
+                       "xmm4", "xmm5", "xmm7",) "memory"        \
+    )
+
+/* Sums in the same order as the C version, for 16, 8, 4 or 2 lags per pass
+ * over the data. Every lag of a pass starts at the first sample of its
+ * lowest lag; the extra products read data[-lag..-1], which is zero. */
+static void lpc_compute_autocorr_avx2(const double *data, int len, int lag,
+                                      double *autoc)
+{
+    LOCAL_ALIGNED_32(double, sums, [16]);
+    int nb_lags = (lag + 1) & ~1;
+    int i, j, k;
+
+    for (j = 0; j < nb_lags; j += k) {
+        const double *cur = data + j;
+        const double *win;
+        x86_reg count = len - j;
+
+        k   = nb_lags - j >= 16 ? 16 : nb_lags - j >= 8 ? 8 :
+              nb_lags - j >=  4 ?  4 : 2;
+        win = data - (k - 1);
+        if (k == 16) {
+            AUTOCORR_LOOP(AUTOCORR_INIT(1) AUTOCORR_INIT(2) AUTOCORR_INIT(3),
+                          AUTOCORR_SUM(0, 4) AUTOCORR_SUM(1, 5)
+                          AUTOCORR_SUM(2, 4) AUTOCORR_SUM(3, 5),
+                          AUTOCORR_STORE(0) AUTOCORR_STORE(1)
+                          AUTOCORR_STORE(2) AUTOCORR_STORE(3));
+        } else if (k == 8) {
+            AUTOCORR_LOOP(AUTOCORR_INIT(1),
+                          AUTOCORR_SUM(0, 4) AUTOCORR_SUM(1, 5),
+                          AUTOCORR_STORE(0) AUTOCORR_STORE(1));
+        } else if (k == 4) {
+            AUTOCORR_LOOP(,
+                          AUTOCORR_SUM(0, 4),
+                          AUTOCORR_STORE(0));
+        } else {
+            AUTOCORR_LOOP(,
+                          AUTOCORR_SUM_X,
+                          AUTOCORR_STORE_X);
+        }
+        /* the highest lag of the pass is in the first lane */
+        for (i = 0; i < k; i++)
+            autoc[j + i] = sums[k - 1 - i];
+    }
+    __asm__ volatile("vzeroupper");
+
+    if (j == lag) {
+        double sum = 1.0;
+        for (i = j - 1; i < len; i += 2) {
+            sum += data[i    ] * data[i - j    ]
+                 + data[i + 1] * data[i - j + 1];
+        }
+        autoc[j] = sum;
+    }
+}
+
+#endif /* HAVE_AVX2_INLINE */
+
 av_cold void ff_lpc_init_x86(LPCContext *c)
 {
-#if HAVE_SSE2_INLINE
+#if HAVE_SSE2_INLINE || HAVE_AVX2_INLINE
     int cpu_flags = av_get_cpu_flags();
+#endif
 
+#if HAVE_SSE2_INLINE
     if (INLINE_SSE2(cpu_flags) || INLINE_SSE2_SLOW(cpu_flags)) {
         c->lpc_apply_welch_window = lpc_apply_welch_window_sse2;
         c->lpc_compute_autocorr   = lpc_compute_autocorr_sse2;
     }
 #endif /* HAVE_SSE2_INLINE */
+#if HAVE_AVX2_INLINE
+    if (INLINE_AVX2(cpu_flags))
+        c->lpc_compute_autocorr = lpc_compute_autocorr_avx2;
+#endif /* HAVE_AVX2_INLINE */
 }
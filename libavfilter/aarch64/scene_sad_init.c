@@ -0,0 +1,52 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include "libavutil/attributes.h"
+#include "libavutil/aarch64/cpu.h"
+#include "libavfilter/scene_sad.h"
+
+#define SCENE_SAD_FUNC(FUNC_NAME, ASM_FUNC_NAME, C_FUNC_NAME, ALIGN, BPP)     \
+void ASM_FUNC_NAME(SCENE_SAD_PARAMS);                                         \
+                                                                              \
+static void FUNC_NAME(SCENE_SAD_PARAMS) {                                     \
+    uint64_t sad;                                                             \
+    ptrdiff_t awidth = width & ~(ALIGN - 1);                                  \
+    ASM_FUNC_NAME(src1, stride1, src2, stride2, awidth, height, sum);         \
+    if (awidth == width)                                                      \
+        return;                                                               \
+    C_FUNC_NAME(src1 + awidth * BPP, stride1,                                 \
+                src2 + awidth * BPP, stride2,                                 \
+                width - awidth, height, &sad);                                \
+    *sum += sad;                                                              \
+}
+
+SCENE_SAD_FUNC(scene_sad_neon,   ff_scene_sad_neon,   ff_scene_sad_c,   16, 1)
+SCENE_SAD_FUNC(scene_sad16_neon, ff_scene_sad16_neon, ff_scene_sad16_c,  8, 2)
+
+av_cold ff_scene_sad_fn ff_scene_sad_get_fn_aarch64(int depth)
+{
+    int cpu_flags = av_get_cpu_flags();
+
+    if (have_neon(cpu_flags)) {
+        if (depth == 8)
+            return scene_sad_neon;
+        if (depth == 16)
+            return scene_sad16_neon;
+    }
+    return NULL;
+}
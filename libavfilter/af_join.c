@@ -500,6 +500,8 @@ static int activate(AVFilterContext *ctx)
             ff_inlink_request_frame(ctx->inputs[0]);
             return 0;
         }
+        if (!s->input_frames[0])
+            return 0;
     }
 
     nb_samples = s->input_frames[0]->nb_samples;
@@ -41,11 +41,12 @@ AVFrame *ff_default_get_audio_buffer(AVFilterLink *link, int nb_samples)
     AVFrame *frame = NULL;
     int channels = link->channels;
     int channel_layout_nb_channels = av_get_channel_layout_nb_channels(link->channel_layout);
+    FFSizePool *size_pool = link->graph ? link->graph->internal->buffer_pool : NULL;
 
     av_assert0(channels == channel_layout_nb_channels || !channel_layout_nb_channels);
 
     if (!link->frame_pool) {
-        link->frame_pool = ff_frame_pool_audio_init(av_buffer_allocz, channels,
+        link->frame_pool = ff_frame_pool_audio_init(av_buffer_allocz, size_pool, channels,
                                                     nb_samples, link->format, BUFFER_ALIGN);
         if (!link->frame_pool)
             return NULL;
@@ -65,7 +66,7 @@ AVFrame *ff_default_get_audio_buffer(AVFilterLink *link, int nb_samples)
             pool_format != link->format || pool_align != BUFFER_ALIGN) {
 
             ff_frame_pool_uninit((FFFramePool **)&link->frame_pool);
-            link->frame_pool = ff_frame_pool_audio_init(av_buffer_allocz, channels,
+            link->frame_pool = ff_frame_pool_audio_init(av_buffer_allocz, size_pool, channels,
                                                         nb_samples, link->format, BUFFER_ALIGN);
             if (!link->frame_pool)
                 return NULL;
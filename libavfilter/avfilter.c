@@ -27,6 +27,7 @@
 #include "libavutil/eval.h"
 #include "libavutil/frame.h"
 #include "libavutil/hwcontext.h"
+#include "libavutil/imgutils.h"
 #include "libavutil/internal.h"
 #include "libavutil/opt.h"
 #include "libavutil/pixdesc.h"
@@ -43,6 +44,7 @@
 #include "formats.h"
 #include "framepool.h"
 #include "internal.h"
+#include "thread.h"
 
 #include "libavutil/ffversion.h"
 const char av_filter_ffversion[] = "FFmpeg version " FFMPEG_VERSION;
@@ -210,6 +212,13 @@ void avfilter_link_free(AVFilterLink **link)
 
 void ff_filter_set_ready(AVFilterContext *filter, unsigned priority)
 {
+    AVFilterGraph *graph = filter->graph;
+
+    if (graph && graph->internal->batch_running &&
+        filter->internal->batch_shared_gen == graph->internal->batch_gen) {
+        ff_graph_thread_set_ready(filter, priority);
+        return;
+    }
     filter->ready = FFMAX(filter->ready, priority);
 }
 
@@ -902,7 +911,8 @@ int avfilter_init_dict(AVFilterContext *ctx, AVDictionary **options)
         return ret;
     }
 
-    if (ctx->filter->flags & AVFILTER_FLAG_SLICE_THREADS &&
+    if ((ctx->filter->flags & AVFILTER_FLAG_SLICE_THREADS ||
+         ctx->filter->flags_internal & FF_FILTER_FLAG_FRAME_THREADS) &&
         ctx->thread_type & ctx->graph->thread_type & AVFILTER_THREAD_SLICE &&
         ctx->graph->internal->thread_execute) {
         ctx->thread_type       = AVFILTER_THREAD_SLICE;
@@ -1015,6 +1025,24 @@ fail:
     return ret;
 }
 
+/* Check if a filter working in place has a frame shared with other filters
+   waiting on one of its inputs. */
+static int filter_has_shared_input(AVFilterContext *filter)
+{
+    unsigned i;
+
+    for (i = 0; i < filter->nb_inputs; i++) {
+        AVFilterLink *link = filter->inputs[i];
+
+        if (link->dstpad->flags & (AVFILTERPAD_FLAG_NEEDS_WRITABLE |
+                                   AVFILTERPAD_FLAG_IN_PLACE) &&
+            ff_framequeue_queued_frames(&link->fifo) &&
+            !av_frame_is_writable(ff_framequeue_peek(&link->fifo, 0)))
+            return 1;
+    }
+    return 0;
+}
+
 int ff_filter_frame(AVFilterLink *link, AVFrame *frame)
 {
     int ret;
@@ -1059,7 +1087,10 @@ int ff_filter_frame(AVFilterLink *link, AVFrame *frame)
         av_frame_free(&frame);
         return ret;
     }
-    ff_filter_set_ready(link->dst, 300);
+    /* A filter working in place on a frame shared with other filters would
+       have to copy it: let the others run first, they may release it. This
+       holds whichever input the new frame arrived on. */
+    ff_filter_set_ready(link->dst, filter_has_shared_input(link->dst) ? 250 : 300);
     return 0;
 
 error:
@@ -1133,28 +1164,51 @@ static int take_samples(AVFilterLink *link, unsigned min, unsigned max,
     return 0;
 }
 
+/* Maximum number of frames passed to a filter in a single activation. */
+#define FRAME_BATCH_MAX 16
+
+static int frame_batch_continue(AVFilterLink *link, int nb_frames)
+{
+    AVFrame *next;
+
+    /* Multiple inputs must be served in turn. */
+    if (nb_frames >= FRAME_BATCH_MAX || link->dst->nb_inputs != 1 ||
+        link->status_out || !samples_ready(link, link->min_samples))
+        return 0;
+    /* Let the other filters sharing the next frame run first, see
+       ff_filter_frame(). */
+    next = ff_framequeue_peek(&link->fifo, 0);
+    return !(link->dstpad->flags & (AVFILTERPAD_FLAG_NEEDS_WRITABLE |
+                                    AVFILTERPAD_FLAG_IN_PLACE)) ||
+           av_frame_is_writable(next);
+}
+
 static int ff_filter_frame_to_filter(AVFilterLink *link)
 {
     AVFrame *frame = NULL;
     AVFilterContext *dst = link->dst;
-    int ret;
+    int nb_frames = 0, ret;
 
     av_assert1(ff_framequeue_queued_frames(&link->fifo));
-    ret = link->min_samples ?
-          ff_inlink_consume_samples(link, link->min_samples, link->max_samples, &frame) :
-          ff_inlink_consume_frame(link, &frame);
-    av_assert1(ret);
-    if (ret < 0) {
-        av_assert1(!frame);
-        return ret;
-    }
-    /* The filter will soon have received a new frame, that may allow it to
-       produce one or more: unblock its outputs. */
-    filter_unblock(dst);
-    /* AVFilterPad.filter_frame() expect frame_count_out to have the value
-       before the frame; ff_filter_frame_framed() will re-increment it. */
-    link->frame_count_out--;
-    ret = ff_filter_frame_framed(link, frame);
+    /* Pass the frames queued on the link in batches, to reduce the
+       scheduling overhead with many small frames. */
+    do {
+        ret = link->min_samples ?
+              ff_inlink_consume_samples(link, link->min_samples, link->max_samples, &frame) :
+              ff_inlink_consume_frame(link, &frame);
+        av_assert1(ret);
+        if (ret < 0) {
+            av_assert1(!frame);
+            return ret;
+        }
+        /* The filter will soon have received a new frame, that may allow it to
+           produce one or more: unblock its outputs. */
+        filter_unblock(dst);
+        /* AVFilterPad.filter_frame() expect frame_count_out to have the value
+           before the frame; ff_filter_frame_framed() will re-increment it. */
+        link->frame_count_out--;
+        ret = ff_filter_frame_framed(link, frame);
+    } while (ret >= 0 && frame_batch_continue(link, ++nb_frames));
     if (ret < 0 && ret != link->status_out) {
         ff_avfilter_link_set_out_status(link, ret, AV_NOPTS_VALUE);
     } else {
@@ -1298,7 +1352,9 @@ static int ff_filter_activate_default(AVFilterContext *filter)
 
    Conditions that cause a filter to be marked ready are:
 
-   - frames added on an input link;
+   - frames added on an input link; with a lower priority if the filter works
+     in place and the frame is shared, so that the other filters holding it
+     can run and release it first;
 
    - changes in the input or output status of an input link;
 
@@ -1355,16 +1411,36 @@ static int ff_filter_activate_default(AVFilterContext *filter)
 
 int ff_filter_activate(AVFilterContext *filter)
 {
+    int64_t consumed = 0;
+    unsigned i;
     int ret;
 
     /* Generic timeline support is not yet implemented but should be easy */
     av_assert1(!(filter->filter->flags & AVFILTER_FLAG_SUPPORT_TIMELINE_GENERIC &&
                  filter->filter->activate));
     filter->ready = 0;
-    ret = filter->filter->activate ? filter->filter->activate(filter) :
-          ff_filter_activate_default(filter);
+    if (!filter->filter->activate) {
+        ret = ff_filter_activate_default(filter);
+        return ret == FFERROR_NOT_READY ? 0 : ret;
+    }
+
+    for (i = 0; i < filter->nb_inputs; i++)
+        consumed -= filter->inputs[i]->frame_count_out;
+    ret = filter->filter->activate(filter);
     if (ret == FFERROR_NOT_READY)
         ret = 0;
+
+    /* Filters consuming one frame per activation rely on each new frame to
+       run again, but the default activation passes frames in batches: run
+       once more if frames were consumed and some are still queued. */
+    for (i = 0; i < filter->nb_inputs; i++)
+        consumed += filter->inputs[i]->frame_count_out;
+    for (i = 0; ret >= 0 && consumed && i < filter->nb_inputs; i++) {
+        if (ff_framequeue_queued_frames(&filter->inputs[i]->fifo)) {
+            ff_filter_set_ready(filter, 300);
+            break;
+        }
+    }
     return ret;
 }
 
@@ -1492,12 +1568,25 @@ int ff_inlink_make_frame_writable(AVFilterLink *link, AVFrame **rframe)
         av_frame_free(&out);
         return ret;
     }
+    ff_filter_account_copy(link->dst, frame);
 
     av_frame_free(&frame);
     *rframe = out;
     return 0;
 }
 
+void ff_filter_account_copy(AVFilterContext *ctx, const AVFrame *frame)
+{
+    int size = frame->nb_samples ?
+        av_samples_get_buffer_size(NULL, frame->channels, frame->nb_samples,
+                                   frame->format, 1) :
+        av_image_get_buffer_size(frame->format, frame->width, frame->height, 1);
+
+    if (ctx->graph && size > 0)
+        atomic_fetch_add_explicit(&ctx->graph->internal->copied_bytes, size,
+                                  memory_order_relaxed);
+}
+
 int ff_inlink_process_commands(AVFilterLink *link, const AVFrame *frame)
 {
     AVFilterCommand *cmd = link->dst->command_queue;
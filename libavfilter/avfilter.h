@@ -395,6 +395,12 @@ unsigned avfilter_filter_pad_count(const AVFilter *filter, int is_output);
  * Process multiple parts of the frame concurrently.
  */
 #define AVFILTER_THREAD_SLICE (1 << 0)
+/**
+ * Activate independent filters of a graph concurrently. Only meaningful in
+ * AVFilterGraph.thread_type; the output does not depend on the number of
+ * threads.
+ */
+#define AVFILTER_THREAD_GRAPH (1 << 1)
 
 typedef struct AVFilterInternal AVFilterInternal;
 
@@ -870,7 +876,9 @@ typedef struct AVFilterGraph {
      * of AVFILTER_THREAD_* flags.
      *
      * May be set by the caller at any point, the setting will apply to all
-     * filters initialized after that. The default is allowing everything.
+     * filters initialized after that. The default is allowing everything
+     * except AVFILTER_THREAD_GRAPH, which must be set before the first
+     * filter is added to the graph.
      *
      * When a filter in this graph is initialized, this field is combined using
      * bit AND with AVFilterContext.thread_type to get the final mask used for
@@ -914,6 +922,16 @@ typedef struct AVFilterGraph {
 
     char *aresample_swr_opts; ///< swr options to use for the auto-inserted aresample filters, Access ONLY through AVOptions
 
+    /**
+     * Maximum size in bytes of the unused frame buffers the graph keeps for
+     * reuse, 0 for no limit. Frame buffers are shared by all the links of the
+     * graph and recycled across changes of the frame parameters. The default
+     * is 256 MiB.
+     *
+     * Access ONLY through AVOptions, before avfilter_graph_config().
+     */
+    int64_t frame_pool_max_idle;
+
     /**
      * Private fields
      *
@@ -1179,6 +1197,24 @@ char *avfilter_graph_dump(AVFilterGraph *graph, const char *options);
  */
 int avfilter_graph_request_oldest(AVFilterGraph *graph);
 
+/**
+ * Get the amount of frame data copied by the filters of a graph to get
+ * writable frames, e.g. because a frame was shared with other filters.
+ *
+ * @return  the number of bytes copied since the graph was allocated
+ */
+uint64_t avfilter_graph_get_copied_bytes(const AVFilterGraph *graph);
+
+/**
+ * Get how the frame buffers shared by the links of a graph were obtained.
+ *
+ * @param nb_allocated set to the number of buffers allocated from the system
+ * @param nb_reused    set to the number of buffers served from the unused
+ *                     buffers kept for reuse
+ */
+void avfilter_graph_get_buffer_stats(const AVFilterGraph *graph,
+                                     uint64_t *nb_allocated, uint64_t *nb_reused);
+
 /**
  * @}
  */
@@ -39,6 +39,7 @@
 #include "avfilter.h"
 #include "buffersink.h"
 #include "formats.h"
+#include "framepool.h"
 #include "internal.h"
 #include "thread.h"
 
@@ -50,6 +51,7 @@ static const AVOption filtergraph_options[] = {
     { "thread_type", "Allowed thread types", OFFSET(thread_type), AV_OPT_TYPE_FLAGS,
         { .i64 = AVFILTER_THREAD_SLICE }, 0, INT_MAX, F|V|A, "thread_type" },
         { "slice", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_SLICE }, .flags = F|V|A, .unit = "thread_type" },
+        { "graph", NULL, 0, AV_OPT_TYPE_CONST, { .i64 = AVFILTER_THREAD_GRAPH }, .flags = F|V|A, .unit = "thread_type" },
     { "threads",     "Maximum number of threads", OFFSET(nb_threads), AV_OPT_TYPE_INT,
         { .i64 = 0 }, 0, INT_MAX, F|V|A, "threads"},
         {"auto", "autodetect a suitable number of threads to use", 0, AV_OPT_TYPE_CONST, {.i64 = 0 }, .flags = F|V|A, .unit = "threads"},
@@ -57,6 +59,8 @@ static const AVOption filtergraph_options[] = {
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, F|V },
     {"aresample_swr_opts"   , "default aresample filter options"    , OFFSET(aresample_swr_opts)    ,
         AV_OPT_TYPE_STRING, {.str = NULL}, 0, 0, F|A },
+    { "frame_pool_max_idle", "maximum size of the unused frame buffers kept for reuse", OFFSET(frame_pool_max_idle),
+        AV_OPT_TYPE_INT64, { .i64 = 256 << 20 }, 0, INT64_MAX, F|V|A },
     { NULL },
 };
 
@@ -79,6 +83,16 @@ int ff_graph_thread_init(AVFilterGraph *graph)
     graph->nb_threads  = 1;
     return 0;
 }
+
+int ff_graph_thread_activate(AVFilterGraph *graph, AVFilterContext **filters,
+                             int nb_filters)
+{
+    return AVERROR(ENOSYS);
+}
+
+void ff_graph_thread_set_ready(AVFilterContext *filter, unsigned priority)
+{
+}
 #endif
 
 AVFilterGraph *avfilter_graph_alloc(void)
@@ -96,6 +110,14 @@ AVFilterGraph *avfilter_graph_alloc(void)
     ret->av_class = &filtergraph_class;
     av_opt_set_defaults(ret);
     ff_framequeue_global_init(&ret->internal->frame_queues);
+    atomic_init(&ret->internal->copied_bytes, 0);
+
+    ret->internal->buffer_pool = ff_size_pool_alloc(av_buffer_allocz);
+    if (!ret->internal->buffer_pool) {
+        av_freep(&ret->internal);
+        av_freep(&ret);
+        return NULL;
+    }
 
     return ret;
 }
@@ -120,9 +142,21 @@ void ff_filter_graph_remove_filter(AVFilterGraph *graph, AVFilterContext *filter
 
 void avfilter_graph_free(AVFilterGraph **graph)
 {
+    uint64_t copied_bytes, nb_allocated, nb_reused;
+
     if (!*graph)
         return;
 
+    copied_bytes = avfilter_graph_get_copied_bytes(*graph);
+    if (copied_bytes)
+        av_log(*graph, AV_LOG_VERBOSE, "%"PRIu64" bytes of frame data copied\n",
+               copied_bytes);
+    avfilter_graph_get_buffer_stats(*graph, &nb_allocated, &nb_reused);
+    if (nb_allocated)
+        av_log(*graph, AV_LOG_VERBOSE,
+               "%"PRIu64" frame buffers allocated, %"PRIu64" reused\n",
+               nb_allocated, nb_reused);
+
     while ((*graph)->nb_filters)
         avfilter_free((*graph)->filters[0]);
 
@@ -133,6 +167,7 @@ void avfilter_graph_free(AVFilterGraph **graph)
     av_opt_free(*graph);
 
     av_freep(&(*graph)->filters);
+    ff_size_pool_unref(&(*graph)->internal->buffer_pool);
     av_freep(&(*graph)->internal);
     av_freep(graph);
 }
@@ -1157,6 +1192,9 @@ int avfilter_graph_config(AVFilterGraph *graphctx, void *log_ctx)
 {
     int ret;
 
+    ff_size_pool_set_max_idle(graphctx->internal->buffer_pool,
+                              FFMIN(graphctx->frame_pool_max_idle, SIZE_MAX));
+
     if ((ret = graph_check_validity(graphctx, log_ctx)))
         return ret;
     if ((ret = graph_config_formats(graphctx, log_ctx)))
@@ -1281,6 +1319,18 @@ void ff_avfilter_graph_update_heap(AVFilterGraph *graph, AVFilterLink *link)
     heap_bubble_down(graph, link, link->age_index);
 }
 
+uint64_t avfilter_graph_get_copied_bytes(const AVFilterGraph *graph)
+{
+    return atomic_load_explicit(&graph->internal->copied_bytes,
+                                memory_order_relaxed);
+}
+
+void avfilter_graph_get_buffer_stats(const AVFilterGraph *graph,
+                                     uint64_t *nb_allocated, uint64_t *nb_reused)
+{
+    ff_size_pool_get_stats(graph->internal->buffer_pool, nb_allocated, nb_reused);
+}
+
 int avfilter_graph_request_oldest(AVFilterGraph *graph)
 {
     AVFilterLink *oldest = graph->sink_links[0];
@@ -1326,6 +1376,100 @@ int avfilter_graph_request_oldest(AVFilterGraph *graph)
     return 0;
 }
 
+/*
+ * Walk the filters whose state may be modified by activating filter: the
+ * filter itself, its neighbours, through whose links it sends frames, status
+ * and requests, and the filters further down that may allocate the buffers
+ * for its output links. If mark is set, tag them as used by the batch gen;
+ * otherwise return 1 if any of them is already used.
+ * The filters feeding its inputs are only shared: consuming frames and
+ * requesting more just raises their ready field, under a lock when several
+ * filters of the batch do it, so that the consumers of the outputs of one
+ * filter (e.g. the branches after split) can be activated together.
+ */
+static int batch_footprint(AVFilterContext *filter, unsigned gen, int mark)
+{
+    unsigned i;
+
+#define VISIT(f)                                            \
+    do {                                                    \
+        if (mark)                                           \
+            (f)->internal->batch_gen = gen;                 \
+        else if ((f)->internal->batch_gen == gen ||         \
+                 (f)->internal->batch_shared_gen == gen)    \
+            return 1;                                       \
+    } while (0)
+#define VISIT_SHARED(f)                                     \
+    do {                                                    \
+        if (mark)                                           \
+            (f)->internal->batch_shared_gen = gen;          \
+        else if ((f)->internal->batch_gen == gen)           \
+            return 1;                                       \
+    } while (0)
+
+    VISIT(filter);
+    for (i = 0; i < filter->nb_inputs; i++)
+        VISIT_SHARED(filter->inputs[i]->src);
+    for (i = 0; i < filter->nb_outputs; i++) {
+        AVFilterLink *link = filter->outputs[i];
+
+        VISIT(link->dst);
+        while (link->dstpad->get_buffer.video && link->dst->nb_outputs) {
+            link = link->dst->outputs[0];
+            VISIT(link->dst);
+        }
+    }
+#undef VISIT
+#undef VISIT_SHARED
+
+    return 0;
+}
+
+/*
+ * Activate first together with the other ready filters that have disjoint
+ * footprints, which gives the same result as activating them one after the
+ * other without looking for the next ready filter in between. Sinks update
+ * the graph-wide sink heap, so at most one of them is part of a batch.
+ * The batch only depends on the state of the graph, not on the number of
+ * threads or their timing, so the output stays deterministic. It may still
+ * differ from serial activation, where a filter may run again before the
+ * others, for filters whose output depends on how much input is queued when
+ * they are activated (e.g. consuming a variable number of samples).
+ */
+static int filter_graph_run_batch(AVFilterGraph *graph, AVFilterContext *first)
+{
+    AVFilterContext *batch[MAX_GRAPH_BATCH];
+    int nb_batch  = 1, has_sink = !first->nb_outputs;
+    unsigned gen  = ++graph->internal->batch_gen;
+    unsigned i;
+    int ret;
+
+    batch[0] = first;
+    batch_footprint(first, gen, 1);
+
+    for (i = 0; i < graph->nb_filters && nb_batch < MAX_GRAPH_BATCH; i++) {
+        AVFilterContext *filter = graph->filters[i];
+
+        if (!filter->ready ||
+            filter->filter->flags_internal & FF_FILTER_FLAG_GRAPH_GLOBAL ||
+            (has_sink && !filter->nb_outputs) ||
+            batch_footprint(filter, gen, 0))
+            continue;
+
+        batch_footprint(filter, gen, 1);
+        has_sink |= !filter->nb_outputs;
+        batch[nb_batch++] = filter;
+    }
+
+    if (nb_batch == 1)
+        return ff_filter_activate(first);
+
+    graph->internal->batch_running = 1;
+    ret = ff_graph_thread_activate(graph, batch, nb_batch);
+    graph->internal->batch_running = 0;
+    return ret;
+}
+
 int ff_filter_graph_run_once(AVFilterGraph *graph)
 {
     AVFilterContext *filter;
@@ -1338,5 +1482,8 @@ int ff_filter_graph_run_once(AVFilterGraph *graph)
             filter = graph->filters[i];
     if (!filter->ready)
         return AVERROR(EAGAIN);
+    if (graph->thread_type & AVFILTER_THREAD_GRAPH && graph->internal->thread &&
+        !(filter->filter->flags_internal & FF_FILTER_FLAG_GRAPH_GLOBAL))
+        return filter_graph_run_batch(graph, filter);
     return ff_filter_activate(filter);
 }
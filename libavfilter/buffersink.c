@@ -142,6 +142,25 @@ int attribute_align_arg av_buffersink_get_frame_flags(AVFilterContext *ctx, AVFr
     return get_frame_internal(ctx, frame, flags, ctx->inputs[0]->min_samples);
 }
 
+int attribute_align_arg av_buffersink_get_frames(AVFilterContext *ctx, AVFrame **frames,
+                                                 int nb_frames, int flags)
+{
+    int i, ret = AVERROR(EAGAIN);
+
+    if (flags & AV_BUFFERSINK_FLAG_PEEK)
+        return AVERROR(EINVAL);
+
+    /* Only run the graph until the first frame is available, then return
+       the ones already queued, so that errors are not lost. */
+    for (i = 0; i < nb_frames; i++) {
+        ret = get_frame_internal(ctx, frames[i], flags | (i ? AV_BUFFERSINK_FLAG_NO_REQUEST : 0),
+                                 ctx->inputs[0]->min_samples);
+        if (ret < 0)
+            break;
+    }
+    return i ? i : ret;
+}
+
 int attribute_align_arg av_buffersink_get_samples(AVFilterContext *ctx,
                                                   AVFrame *frame, int nb_samples)
 {
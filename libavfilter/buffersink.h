@@ -95,6 +95,30 @@ int av_buffersink_get_frame_flags(AVFilterContext *ctx, AVFrame *frame, int flag
  */
 #define AV_BUFFERSINK_FLAG_NO_REQUEST 2
 
+/**
+ * Get several frames with filtered data from sink.
+ *
+ * If no frame is available, the graph is run as with
+ * av_buffersink_get_frame_flags() until one is; the frames already queued
+ * in the sink after it are then returned as well, up to nb_frames. This
+ * avoids the per-call overhead for graphs producing many small frames,
+ * e.g. after av_buffersrc_add_frames().
+ *
+ * @param ctx        pointer to a buffersink or abuffersink filter context.
+ * @param frames     array of nb_frames allocated frames that will be filled
+ *                   with data. The data must be freed using av_frame_unref()
+ *                   / av_frame_free()
+ * @param nb_frames  maximum number of frames to get
+ * @param flags      a combination of AV_BUFFERSINK_FLAG_* flags, except
+ *                   AV_BUFFERSINK_FLAG_PEEK
+ *
+ * @return  the number of frames returned, which is > 0, or a negative
+ *          AVERROR code with the same meaning as for
+ *          av_buffersink_get_frame_flags() if no frame was returned.
+ */
+int av_buffersink_get_frames(AVFilterContext *ctx, AVFrame **frames,
+                             int nb_frames, int flags);
+
 #if FF_API_BUFFERSINK_ALLOC
 /**
  * Deprecated and unused struct to use for initializing a buffersink context.
@@ -162,13 +162,13 @@ static int push_frame(AVFilterGraph *graph)
     return 0;
 }
 
-int attribute_align_arg av_buffersrc_add_frame_flags(AVFilterContext *ctx, AVFrame *frame, int flags)
+static int add_frame_internal(AVFilterContext *ctx, AVFrame *frame, int flags)
 {
     BufferSourceContext *s = ctx->priv;
     AVFrame *copy;
     int refcounted, ret;
 
-    if (frame && frame->channel_layout &&
+    if (frame->channel_layout &&
         av_get_channel_layout_nb_channels(frame->channel_layout) != frame->channels) {
         av_log(ctx, AV_LOG_ERROR, "Layout indicates a different number of channels than actually present\n");
         return AVERROR(EINVAL);
@@ -176,8 +176,6 @@ int attribute_align_arg av_buffersrc_add_frame_flags(AVFilterContext *ctx, AVFra
 
     s->nb_failed_requests = 0;
 
-    if (!frame)
-        return av_buffersrc_close(ctx, AV_NOPTS_VALUE, flags);
     if (s->eof)
         return AVERROR(EINVAL);
 
@@ -216,7 +214,20 @@ int attribute_align_arg av_buffersrc_add_frame_flags(AVFilterContext *ctx, AVFra
         }
     }
 
-    ret = ff_filter_frame(ctx->outputs[0], copy);
+    return ff_filter_frame(ctx->outputs[0], copy);
+}
+
+int attribute_align_arg av_buffersrc_add_frame_flags(AVFilterContext *ctx, AVFrame *frame, int flags)
+{
+    int ret;
+
+    if (!frame) {
+        BufferSourceContext *s = ctx->priv;
+        s->nb_failed_requests = 0;
+        return av_buffersrc_close(ctx, AV_NOPTS_VALUE, flags);
+    }
+
+    ret = add_frame_internal(ctx, frame, flags);
     if (ret < 0)
         return ret;
 
@@ -229,6 +240,28 @@ int attribute_align_arg av_buffersrc_add_frame_flags(AVFilterContext *ctx, AVFra
     return 0;
 }
 
+int attribute_align_arg av_buffersrc_add_frames(AVFilterContext *ctx, AVFrame **frames,
+                                                int nb_frames, int flags)
+{
+    int i, ret = 0;
+
+    for (i = 0; i < nb_frames; i++) {
+        ret = add_frame_internal(ctx, frames[i], flags);
+        if (ret < 0)
+            break;
+    }
+
+    /* Run the graph once for the whole batch rather than once per frame,
+       also for the frames added before a failure. */
+    if ((flags & AV_BUFFERSRC_FLAG_PUSH) && i) {
+        int push_ret = push_frame(ctx->graph);
+        if (ret >= 0)
+            ret = push_ret;
+    }
+
+    return FFMIN(ret, 0);
+}
+
 int av_buffersrc_close(AVFilterContext *ctx, int64_t pts, unsigned flags)
 {
     BufferSourceContext *s = ctx->priv;
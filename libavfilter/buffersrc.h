@@ -193,6 +193,31 @@ av_warn_unused_result
 int av_buffersrc_add_frame_flags(AVFilterContext *buffer_src,
                                  AVFrame *frame, int flags);
 
+/**
+ * Add several frames to the buffer source.
+ *
+ * This is equivalent to calling av_buffersrc_add_frame_flags() for each
+ * frame, except that with AV_BUFFERSRC_FLAG_PUSH the filter graph is only
+ * run once, after all the frames have been added, and that the frames are
+ * then processed in batches by the filters. This reduces the per-frame
+ * overhead for graphs processing many small frames.
+ *
+ * @param buffer_src  pointer to a buffer source context
+ * @param frames      array of nb_frames frames, none of them may be NULL;
+ *                    use av_buffersrc_close() to signal the end of stream.
+ *                    Each frame is reset as with av_buffersrc_add_frame_flags()
+ *                    unless AV_BUFFERSRC_FLAG_KEEP_REF is set.
+ * @param nb_frames   number of frames to add
+ * @param flags       a combination of AV_BUFFERSRC_FLAG_*
+ * @return            >= 0 in case of success, a negative AVERROR code
+ *                    in case of failure; the frames before the one that
+ *                    failed have been added then, and pushed with
+ *                    AV_BUFFERSRC_FLAG_PUSH, the others are left untouched
+ */
+av_warn_unused_result
+int av_buffersrc_add_frames(AVFilterContext *buffer_src,
+                            AVFrame **frames, int nb_frames, int flags);
+
 /**
  * Close the buffer source after EOF.
  *
@@ -37,6 +37,12 @@ typedef struct BWDIFContext {
                         int parity, int clip_max, int spat);
 } BWDIFContext;
 
+/**
+ * Set the line filter functions for the bit depth of bwdif->yadif.csp.
+ */
+void ff_bwdif_init_filter_line(BWDIFContext *bwdif);
+
+void ff_bwdif_init_aarch64(BWDIFContext *bwdif);
 void ff_bwdif_init_x86(BWDIFContext *bwdif);
 
 #endif /* AVFILTER_BWDIF_H */
@@ -26,6 +26,185 @@
 #include "libavutil/imgutils.h"
 #include "libavutil/mem.h"
 #include "libavutil/pixfmt.h"
+#include "libavutil/thread.h"
+
+#include <stdatomic.h>
+
+/* Buffers are rounded up to sizes of the form (4..7 + 1) << shift, i.e. four
+ * size classes per power of two, wasting at most a quarter of each buffer. */
+#define SIZE_POOL_MIN_SHIFT 6
+#define SIZE_POOL_CLASSES   (4 * (32 - SIZE_POOL_MIN_SHIFT))
+/* number of larger classes that may serve a request when its own is empty */
+#define SIZE_POOL_FALLBACK  3
+
+typedef struct SizePoolEntry {
+    AVBufferRef *buf;
+    size_t size;
+    int cls;
+    FFSizePool *pool;
+    struct SizePoolEntry *next;
+} SizePoolEntry;
+
+struct FFSizePool {
+    AVBufferRef* (*alloc)(size_t size);
+
+    AVMutex mutex;
+    SizePoolEntry *free[SIZE_POOL_CLASSES];
+    size_t idle_size;
+    size_t max_idle_size;
+
+    uint64_t nb_allocated;
+    uint64_t nb_reused;
+
+    /* references from the owners and from the buffers in use */
+    atomic_uint refcount;
+};
+
+static int size_class(size_t size, size_t *class_size)
+{
+    size_t m = FFMAX(size, 1 << SIZE_POOL_MIN_SHIFT) - 1;
+    int shift = av_log2(m) - 2;
+
+    m = (m >> shift) + 1;
+    *class_size = m << shift;
+    return 4 * (shift - SIZE_POOL_MIN_SHIFT + 3) + m - 5;
+}
+
+FFSizePool *ff_size_pool_alloc(AVBufferRef* (*alloc)(size_t size))
+{
+    FFSizePool *pool = av_mallocz(sizeof(*pool));
+    if (!pool)
+        return NULL;
+
+    pool->alloc = alloc ? alloc : av_buffer_alloc;
+
+    if (ff_mutex_init(&pool->mutex, NULL)) {
+        av_free(pool);
+        return NULL;
+    }
+    atomic_init(&pool->refcount, 1);
+
+    return pool;
+}
+
+FFSizePool *ff_size_pool_ref(FFSizePool *pool)
+{
+    atomic_fetch_add_explicit(&pool->refcount, 1, memory_order_relaxed);
+    return pool;
+}
+
+static void size_pool_release_ref(FFSizePool *pool)
+{
+    int i;
+
+    if (atomic_fetch_sub_explicit(&pool->refcount, 1, memory_order_acq_rel) != 1)
+        return;
+
+    for (i = 0; i < SIZE_POOL_CLASSES; i++) {
+        while (pool->free[i]) {
+            SizePoolEntry *entry = pool->free[i];
+            pool->free[i] = entry->next;
+            av_buffer_unref(&entry->buf);
+            av_free(entry);
+        }
+    }
+    ff_mutex_destroy(&pool->mutex);
+    av_free(pool);
+}
+
+void ff_size_pool_unref(FFSizePool **pool)
+{
+    if (!pool || !*pool)
+        return;
+
+    size_pool_release_ref(*pool);
+    *pool = NULL;
+}
+
+void ff_size_pool_set_max_idle(FFSizePool *pool, size_t max_idle)
+{
+    ff_mutex_lock(&pool->mutex);
+    pool->max_idle_size = max_idle;
+    ff_mutex_unlock(&pool->mutex);
+}
+
+static void size_pool_release(void *opaque, uint8_t *data)
+{
+    SizePoolEntry *entry = opaque;
+    FFSizePool *pool = entry->pool;
+
+    ff_mutex_lock(&pool->mutex);
+    if (!pool->max_idle_size ||
+        pool->idle_size + entry->size <= pool->max_idle_size) {
+        entry->next = pool->free[entry->cls];
+        pool->free[entry->cls] = entry;
+        pool->idle_size += entry->size;
+        entry = NULL;
+    }
+    ff_mutex_unlock(&pool->mutex);
+
+    if (entry) {
+        av_buffer_unref(&entry->buf);
+        av_free(entry);
+    }
+
+    size_pool_release_ref(pool);
+}
+
+AVBufferRef *ff_size_pool_get(FFSizePool *pool, size_t size)
+{
+    SizePoolEntry *entry = NULL;
+    AVBufferRef *ret;
+    size_t class_size;
+    int i, cls;
+
+    if (size > INT_MAX)
+        return NULL;
+    cls = size_class(size, &class_size);
+
+    ff_mutex_lock(&pool->mutex);
+    for (i = cls; i <= FFMIN(cls + SIZE_POOL_FALLBACK, SIZE_POOL_CLASSES - 1); i++) {
+        if ((entry = pool->free[i])) {
+            pool->free[i] = entry->next;
+            pool->idle_size -= entry->size;
+            pool->nb_reused++;
+            break;
+        }
+    }
+    if (!entry)
+        pool->nb_allocated++;
+    ff_mutex_unlock(&pool->mutex);
+
+    if (!entry) {
+        entry = av_mallocz(sizeof(*entry));
+        if (!entry)
+            return NULL;
+        entry->buf = pool->alloc(class_size);
+        if (!entry->buf) {
+            av_free(entry);
+            return NULL;
+        }
+        entry->size = class_size;
+        entry->cls  = cls;
+        entry->pool = pool;
+    }
+
+    ff_size_pool_ref(pool);
+    ret = av_buffer_create(entry->buf->data, entry->size, size_pool_release, entry, 0);
+    if (!ret)
+        size_pool_release(entry, entry->buf->data);
+
+    return ret;
+}
+
+void ff_size_pool_get_stats(FFSizePool *pool, uint64_t *nb_allocated,
+                            uint64_t *nb_reused)
+{
+    ff_mutex_lock(&pool->mutex);
+    *nb_allocated = pool->nb_allocated;
+    *nb_reused    = pool->nb_reused;
+    ff_mutex_unlock(&pool->mutex);
+}
 
 struct FFFramePool {
 
@@ -44,11 +223,14 @@ struct FFFramePool {
     int format;
     int align;
     int linesize[4];
+    size_t sizes[4];
     AVBufferPool *pools[4];
+    FFSizePool *size_pool;
 
 };
 
 FFFramePool *ff_frame_pool_video_init(AVBufferRef* (*alloc)(size_t size),
+                                      FFSizePool *size_pool,
                                       int width,
                                       int height,
                                       enum AVPixelFormat format,
@@ -96,15 +278,20 @@ FFFramePool *ff_frame_pool_video_init(AVBufferRef* (*alloc)(size_t size),
         if (i == 1 || i == 2)
             h = AV_CEIL_RSHIFT(h, desc->log2_chroma_h);
 
-        pool->pools[i] = av_buffer_pool_init(pool->linesize[i] * h + 16 + 16 - 1,
-                                             alloc);
-        if (!pool->pools[i])
-            goto fail;
+        pool->sizes[i] = pool->linesize[i] * h + 16 + 16 - 1;
     }
 
-    if (desc->flags & AV_PIX_FMT_FLAG_PAL) {
-        pool->pools[1] = av_buffer_pool_init(AVPALETTE_SIZE, alloc);
-        if (!pool->pools[1])
+    if (desc->flags & AV_PIX_FMT_FLAG_PAL)
+        pool->sizes[1] = AVPALETTE_SIZE;
+
+    if (size_pool) {
+        pool->size_pool = ff_size_pool_ref(size_pool);
+        return pool;
+    }
+
+    for (i = 0; i < 4 && pool->sizes[i]; i++) {
+        pool->pools[i] = av_buffer_pool_init(pool->sizes[i], alloc);
+        if (!pool->pools[i])
             goto fail;
     }
 
@@ -116,6 +303,7 @@ fail:
 }
 
 FFFramePool *ff_frame_pool_audio_init(AVBufferRef* (*alloc)(size_t size),
+                                      FFSizePool *size_pool,
                                       int channels,
                                       int nb_samples,
                                       enum AVSampleFormat format,
@@ -142,7 +330,14 @@ FFFramePool *ff_frame_pool_audio_init(AVBufferRef* (*alloc)(size_t size),
     if (ret < 0)
         goto fail;
 
-    pool->pools[0] = av_buffer_pool_init(pool->linesize[0], NULL);
+    pool->sizes[0] = pool->linesize[0];
+
+    if (size_pool) {
+        pool->size_pool = ff_size_pool_ref(size_pool);
+        return pool;
+    }
+
+    pool->pools[0] = av_buffer_pool_init(pool->sizes[0], NULL);
     if (!pool->pools[0])
         goto fail;
 
@@ -191,6 +386,13 @@ int ff_frame_pool_get_audio_config(FFFramePool *pool,
     return 0;
 }
 
+static AVBufferRef *frame_pool_get_buffer(FFFramePool *pool, int i)
+{
+    if (pool->size_pool)
+        return ff_size_pool_get(pool->size_pool, pool->sizes[i]);
+    return av_buffer_pool_get(pool->pools[i]);
+}
+
 AVFrame *ff_frame_pool_get(FFFramePool *pool)
 {
     int i;
@@ -215,10 +417,10 @@ AVFrame *ff_frame_pool_get(FFFramePool *pool)
 
         for (i = 0; i < 4; i++) {
             frame->linesize[i] = pool->linesize[i];
-            if (!pool->pools[i])
+            if (!pool->sizes[i])
                 break;
 
-            frame->buf[i] = av_buffer_pool_get(pool->pools[i]);
+            frame->buf[i] = frame_pool_get_buffer(pool, i);
             if (!frame->buf[i])
                 goto fail;
 
@@ -256,13 +458,13 @@ AVFrame *ff_frame_pool_get(FFFramePool *pool)
         }
 
         for (i = 0; i < FFMIN(pool->planes, AV_NUM_DATA_POINTERS); i++) {
-            frame->buf[i] = av_buffer_pool_get(pool->pools[0]);
+            frame->buf[i] = frame_pool_get_buffer(pool, 0);
             if (!frame->buf[i])
                 goto fail;
             frame->extended_data[i] = frame->data[i] = frame->buf[i]->data;
         }
         for (i = 0; i < frame->nb_extended_buf; i++) {
-            frame->extended_buf[i] = av_buffer_pool_get(pool->pools[0]);
+            frame->extended_buf[i] = frame_pool_get_buffer(pool, 0);
             if (!frame->extended_buf[i])
                 goto fail;
             frame->extended_data[i + AV_NUM_DATA_POINTERS] = frame->extended_buf[i]->data;
@@ -289,6 +491,7 @@ void ff_frame_pool_uninit(FFFramePool **pool)
     for (i = 0; i < 4; i++) {
         av_buffer_pool_uninit(&(*pool)->pools[i]);
     }
+    ff_size_pool_unref(&(*pool)->size_pool);
 
     av_freep(pool);
 }
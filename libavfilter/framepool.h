@@ -21,10 +21,70 @@
 #ifndef AVFILTER_FRAMEPOOL_H
 #define AVFILTER_FRAMEPOOL_H
 
+#include <stdint.h>
+
 #include "libavutil/buffer.h"
 #include "libavutil/frame.h"
 #include "libavutil/internal.h"
 
+/**
+ * Size-class buffer pool. Buffers are recycled by size class rather than by
+ * exact size, so that one pool can serve frames of any dimensions and format,
+ * e.g. for all the links of a filter graph and across changes of the frame
+ * parameters. This structure is opaque and reference counted; buffers
+ * allocated from it keep it alive until they are released.
+ */
+typedef struct FFSizePool FFSizePool;
+
+/**
+ * Allocate a size-class buffer pool.
+ *
+ * @param alloc a function that will be used to allocate new buffers when
+ * no buffer of a suitable size is available. May be NULL, then the default
+ * allocator will be used (av_buffer_alloc()).
+ * @return newly created pool with a single reference on success, NULL on error.
+ */
+FFSizePool *ff_size_pool_alloc(AVBufferRef* (*alloc)(size_t size));
+
+/**
+ * Get a new reference to a size-class buffer pool.
+ */
+FFSizePool *ff_size_pool_ref(FFSizePool *pool);
+
+/**
+ * Drop a reference to a size-class buffer pool. It is safe to call this
+ * function while some of the allocated buffers are still in use.
+ *
+ * @param pool pointer to the pool reference to drop. It will be set to NULL.
+ */
+void ff_size_pool_unref(FFSizePool **pool);
+
+/**
+ * Set the high-water mark of the pool: released buffers are freed instead
+ * of being kept for reuse when the pool already holds max_idle bytes of
+ * unused buffers.
+ *
+ * @param max_idle maximum size of the unused buffers in bytes, 0 for no limit
+ */
+void ff_size_pool_set_max_idle(FFSizePool *pool, size_t max_idle);
+
+/**
+ * Get a new or recycled buffer of at least the given size.
+ * This function may be called simultaneously from multiple threads.
+ *
+ * @return a new buffer reference on success, NULL on error.
+ */
+AVBufferRef *ff_size_pool_get(FFSizePool *pool, size_t size);
+
+/**
+ * Get the usage statistics of the pool.
+ *
+ * @param nb_allocated number of buffers allocated from the system
+ * @param nb_reused    number of buffers served from recycled buffers
+ */
+void ff_size_pool_get_stats(FFSizePool *pool, uint64_t *nb_allocated,
+                            uint64_t *nb_reused);
+
 /**
  * Frame pool. This structure is opaque and not meant to be accessed
  * directly. It is allocated with ff_frame_pool_init() and freed with
@@ -38,6 +98,8 @@ typedef struct FFFramePool FFFramePool;
  * @param alloc a function that will be used to allocate new frame buffers when
  * the pool is empty. May be NULL, then the default allocator will be used
  * (av_buffer_alloc()).
+ * @param size_pool if not NULL, the frame buffers are taken from this shared
+ * pool and alloc is ignored. The frame pool keeps a reference to it.
  * @param width width of each frame in this pool
  * @param height height of each frame in this pool
  * @param format format of each frame in this pool
@@ -45,6 +107,7 @@ typedef struct FFFramePool FFFramePool;
  * @return newly created video frame pool on success, NULL on error.
  */
 FFFramePool *ff_frame_pool_video_init(AVBufferRef* (*alloc)(size_t size),
+                                      FFSizePool *size_pool,
                                       int width,
                                       int height,
                                       enum AVPixelFormat format,
@@ -56,6 +119,8 @@ FFFramePool *ff_frame_pool_video_init(AVBufferRef* (*alloc)(size_t size),
  * @param alloc a function that will be used to allocate new frame buffers when
  * the pool is empty. May be NULL, then the default allocator will be used
  * (av_buffer_alloc()).
+ * @param size_pool if not NULL, the frame buffers are taken from this shared
+ * pool and alloc is ignored. The frame pool keeps a reference to it.
  * @param channels channels of each frame in this pool
  * @param nb_samples number of samples of each frame in this pool
  * @param format format of each frame in this pool
@@ -63,6 +128,7 @@ FFFramePool *ff_frame_pool_video_init(AVBufferRef* (*alloc)(size_t size),
  * @return newly created audio frame pool on success, NULL on error.
  */
 FFFramePool *ff_frame_pool_audio_init(AVBufferRef* (*alloc)(size_t size),
+                                      FFSizePool *size_pool,
                                       int channels,
                                       int samples,
                                       enum AVSampleFormat format,
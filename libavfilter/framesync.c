@@ -249,7 +249,7 @@ int ff_framesync_get_frame(FFFrameSync *fs, unsigned in, AVFrame **rframe,
                             unsigned get)
 {
     AVFrame *frame;
-    unsigned need_copy = 0, i;
+    unsigned need_copy = 0, repeated, i;
     int64_t pts_next;
     int ret;
 
@@ -260,10 +260,15 @@ int ff_framesync_get_frame(FFFrameSync *fs, unsigned in, AVFrame **rframe,
     frame = fs->in[in].frame;
     if (get) {
         /* Find out if we need to copy the frame: is there another sync
-           stream, and do we know if its current frame will outlast this one? */
+           stream, and do we know if its current frame will outlast this one?
+           A stream with a lower sync level than this one only triggers
+           events once this one ended, so it matters only if this frame may
+           be repeated after the end. */
         pts_next = fs->in[in].have_next ? fs->in[in].pts_next : INT64_MAX;
+        repeated = fs->in[in].after == EXT_INFINITY && !fs->in[in].have_next;
         for (i = 0; i < fs->nb_in && !need_copy; i++)
             if (i != in && fs->in[i].sync &&
+                (repeated || fs->in[i].sync >= FFMIN(fs->in[in].sync, fs->sync_level)) &&
                 (!fs->in[i].have_next || fs->in[i].pts_next < pts_next))
                 need_copy = 1;
         if (need_copy) {
@@ -273,6 +278,7 @@ int ff_framesync_get_frame(FFFrameSync *fs, unsigned in, AVFrame **rframe,
                 av_frame_free(&frame);
                 return ret;
             }
+            ff_filter_account_copy(fs->parent, frame);
         } else {
             fs->in[in].frame = NULL;
         }
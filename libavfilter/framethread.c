@@ -0,0 +1,198 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <string.h>
+
+#include "libavutil/avassert.h"
+#include "libavutil/mem.h"
+
+#include "avfilter.h"
+#include "filters.h"
+#include "framethread.h"
+#include "internal.h"
+
+int ff_framethread_init(FFFrameThread *ft, AVFilterContext *parent)
+{
+    int i;
+
+    av_assert0(ft->process);
+    av_assert0(parent->nb_inputs == 1 && parent->nb_outputs == 1);
+
+    ft->parent  = parent;
+    ft->nb_jobs = parent->thread_type ? ff_filter_get_nb_threads(parent) : 1;
+    ft->jobs    = av_calloc(ft->nb_jobs, sizeof(*ft->jobs));
+    if (!ft->jobs)
+        return AVERROR(ENOMEM);
+
+    if (ft->job_priv_size) {
+        for (i = 0; i < ft->nb_jobs; i++) {
+            ft->jobs[i].priv = av_malloc(ft->job_priv_size);
+            if (!ft->jobs[i].priv)
+                return AVERROR(ENOMEM);
+        }
+    }
+
+    return 0;
+}
+
+void ff_framethread_uninit(FFFrameThread *ft)
+{
+    int i;
+
+    for (i = 0; ft->jobs && i < ft->nb_jobs; i++) {
+        FFFrameThreadJob *job = &ft->jobs[i];
+
+        if (job->out != job->in)
+            av_frame_free(&job->out);
+        av_frame_free(&job->in);
+        av_freep(&job->priv);
+    }
+    av_freep(&ft->jobs);
+    av_frame_free(&ft->prev);
+    ft->nb_jobs = ft->nb_queued = 0;
+}
+
+static int process_job(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    FFFrameThread *ft = arg;
+    FFFrameThreadJob *job = &ft->jobs[jobnr];
+
+    job->ret = ft->process(ctx, job);
+    return 0;
+}
+
+static int run_batch(FFFrameThread *ft)
+{
+    AVFilterContext *ctx = ft->parent;
+    AVFrame *last = NULL;
+    int i, nb = ft->nb_queued, ret = 0;
+
+    for (i = 0; i < nb; i++) {
+        FFFrameThreadJob *job = &ft->jobs[i];
+
+        job->prev = !ft->need_prev ? NULL : i ? ft->jobs[i - 1].in : ft->prev;
+        job->out  = NULL;
+        job->ret  = 0;
+        if (job->priv)
+            memset(job->priv, 0, ft->job_priv_size);
+    }
+
+    ff_filter_execute(ctx, process_job, ft, NULL, nb);
+
+    for (i = 0; i < nb; i++) {
+        FFFrameThreadJob *job = &ft->jobs[i];
+
+        if (job->ret >= 0 && ft->finish)
+            job->ret = ft->finish(ctx, job);
+        if (job->ret < 0) {
+            ret = job->ret;
+            break;
+        }
+    }
+
+    /* the outputs may be modified downstream once sent */
+    if (ret >= 0 && ft->need_prev) {
+        last = av_frame_clone(ft->jobs[nb - 1].in);
+        if (!last)
+            ret = AVERROR(ENOMEM);
+    }
+
+    for (i = 0; i < nb; i++) {
+        FFFrameThreadJob *job = &ft->jobs[i];
+
+        if (job->out == job->in)
+            job->in = NULL;
+        if (ret >= 0 && job->out)
+            ret = ff_filter_frame(ctx->outputs[0], job->out);
+        else
+            av_frame_free(&job->out);
+        job->out = NULL;
+        job->prev = NULL;
+        av_frame_free(&job->in);
+    }
+    ft->nb_queued = 0;
+
+    if (last) {
+        av_frame_free(&ft->prev);
+        ft->prev = last;
+    }
+
+    return ret;
+}
+
+int ff_framethread_activate(FFFrameThread *ft)
+{
+    AVFilterContext *ctx = ft->parent;
+    AVFilterLink *inlink  = ctx->inputs[0];
+    AVFilterLink *outlink = ctx->outputs[0];
+    int64_t pts;
+    int ret, status = 0, nb_new = 0;
+
+    FF_FILTER_FORWARD_STATUS_BACK(outlink, inlink);
+
+    while (ft->nb_queued < ft->nb_jobs) {
+        AVFrame *frame;
+
+        ret = ff_inlink_consume_frame(inlink, &frame);
+        if (ret < 0)
+            return ret;
+        if (!ret)
+            break;
+        ft->jobs[ft->nb_queued++].in = frame;
+        nb_new++;
+    }
+
+    /*
+     * Wait for the batch to be complete unless the input is finished, or
+     * the output is wanted and no input came since the last activation. The
+     * filter marks itself ready with the lowest priority while it waits, so
+     * that it only runs again without input when nothing else in the graph
+     * can: upstream can not deliver for now, and may be waiting for the
+     * frames held here.
+     */
+    if (ft->nb_queued < ft->nb_jobs &&
+        !ff_inlink_acknowledge_status(inlink, &status, &pts)) {
+        if (!ft->nb_queued) {
+            if (!ff_outlink_frame_wanted(outlink))
+                return FFERROR_NOT_READY;
+            ff_inlink_request_frame(inlink);
+            return 0;
+        }
+        if (nb_new) {
+            ff_inlink_request_frame(inlink);
+            ff_filter_set_ready(ctx, 1);
+            return 0;
+        }
+        if (!ff_outlink_frame_wanted(outlink))
+            return FFERROR_NOT_READY;
+    }
+
+    if (ft->nb_queued) {
+        ret = run_batch(ft);
+        if (ret < 0)
+            return ret;
+    }
+
+    if (status) {
+        ff_outlink_set_status(outlink, status, pts);
+        return 0;
+    }
+
+    ff_filter_set_ready(ctx, 100);
+    return 0;
+}
@@ -0,0 +1,124 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#ifndef AVFILTER_FRAMETHREAD_H
+#define AVFILTER_FRAMETHREAD_H
+
+#include "libavutil/frame.h"
+
+#include "avfilter.h"
+
+/**
+ * This API is intended as a helper for filters with one input and one
+ * output whose work on a frame can not be split into slices, but whose
+ * expensive part does not depend on the result of previous frames.
+ *
+ * The filter splits its work in two stages. The process stage is run
+ * concurrently on a batch of up to ff_filter_get_nb_threads() frames, using
+ * the filter graph threads. The finish stage is then run on each frame of
+ * the batch in order, from the filter thread, and can update the state that
+ * is carried from frame to frame. Output frames are sent in input order.
+ *
+ * Filters using it set FF_FILTER_FLAG_FRAME_THREADS, call
+ * ff_framethread_init() from their init callback and
+ * ff_framethread_activate() as their activate callback.
+ */
+
+typedef struct FFFrameThreadJob {
+    /**
+     * Input frame. Owned by the framework unless it is also used as out.
+     */
+    AVFrame *in;
+
+    /**
+     * Input frame preceding in, or NULL for the first frame. Only set if
+     * FFFrameThread.need_prev is set; read-only.
+     */
+    AVFrame *prev;
+
+    /**
+     * Output frame set by one of the stages, NULL if no frame is output.
+     * It can be in, in which case ownership of the input is transferred.
+     */
+    AVFrame *out;
+
+    /**
+     * Per-job storage for the filter, FFFrameThread.job_priv_size bytes,
+     * zeroed before the process stage.
+     */
+    void *priv;
+
+    int ret;
+} FFFrameThreadJob;
+
+typedef struct FFFrameThread {
+    /**
+     * Process stage, called concurrently on the jobs of a batch. It must not
+     * modify the filter context. If need_prev is set, it must not modify
+     * job->in either, since it is read as prev by the next job.
+     */
+    int (*process)(AVFilterContext *ctx, FFFrameThreadJob *job);
+
+    /**
+     * Finish stage, called on the jobs of a batch one after the other in
+     * input order. May be NULL.
+     */
+    int (*finish)(AVFilterContext *ctx, FFFrameThreadJob *job);
+
+    size_t job_priv_size;
+
+    /**
+     * Set to provide each job with the preceding input frame.
+     */
+    int need_prev;
+
+    /* The fields below are private. */
+    AVFilterContext *parent;
+    FFFrameThreadJob *jobs;
+    int nb_jobs;
+    int nb_queued;
+    AVFrame *prev;
+} FFFrameThread;
+
+/**
+ * Initialize a frame thread structure.
+ *
+ * The callbacks and parameters are expected to be already set.
+ *
+ * @param  ft      frame thread structure to initialize
+ * @param  parent  parent AVFilterContext object
+ * @return  >= 0 for success or a negative error code
+ */
+int ff_framethread_init(FFFrameThread *ft, AVFilterContext *parent);
+
+/**
+ * Free all memory currently allocated.
+ */
+void ff_framethread_uninit(FFFrameThread *ft);
+
+/**
+ * Consume the frames in the filter's input and run them through the stages
+ * once a batch is complete, the input is finished, or the output is wanted
+ * and upstream can not deliver more frames for now.
+ *
+ * This function can be the complete implementation of the activate
+ * method of a filter using frame threads.
+ */
+int ff_framethread_activate(FFFrameThread *ft);
+
+#endif /* AVFILTER_FRAMETHREAD_H */
@@ -58,5 +58,6 @@ typedef struct GBlurContext {
 } GBlurContext;
 
 void ff_gblur_init(GBlurContext *s);
+void ff_gblur_init_aarch64(GBlurContext *s);
 void ff_gblur_init_x86(GBlurContext *s);
 #endif
@@ -35,6 +35,7 @@ typedef struct FlipContext {
 } FlipContext;
 
 int ff_hflip_init(FlipContext *s, int step[4], int nb_planes);
+void ff_hflip_init_aarch64(FlipContext *s, int step[4], int nb_planes);
 void ff_hflip_init_x86(FlipContext *s, int step[4], int nb_planes);
 
 #endif /* AVFILTER_HFLIP_H */
@@ -24,6 +24,8 @@
  * internal API functions
  */
 
+#include <stdatomic.h>
+
 #include "libavutil/internal.h"
 #include "avfilter.h"
 #include "formats.h"
@@ -73,6 +75,16 @@ struct AVFilterPad {
      */
 #define AVFILTERPAD_FLAG_FREE_NAME                       (1 << 1)
 
+    /**
+     * The filter works in place on writable frames and copies them or
+     * allocates new ones otherwise. Frames shared with other filters are
+     * processed after those filters had a chance to release them.
+     * Implied by AVFILTERPAD_FLAG_NEEDS_WRITABLE.
+     *
+     * input pads only.
+     */
+#define AVFILTERPAD_FLAG_IN_PLACE                        (1 << 2)
+
     /**
      * A combination of AVFILTERPAD_FLAG_* flags.
      */
@@ -134,10 +146,27 @@ struct AVFilterGraphInternal {
     void *thread;
     avfilter_execute_func *thread_execute;
     FFFrameQueueGlobal frame_queues;
+
+    /* incremented for each batch of filters activated together */
+    unsigned batch_gen;
+    /* set while the batch is being activated */
+    int batch_running;
+
+    /* frame data copied to get writable frames, in bytes */
+    atomic_uint_least64_t copied_bytes;
+
+    /* frame buffers shared by all the links of the graph */
+    struct FFSizePool *buffer_pool;
 };
 
 struct AVFilterInternal {
     avfilter_execute_func *execute;
+
+    /* equal to the graph batch_gen when touched by the current batch */
+    unsigned batch_gen;
+    /* equal to the graph batch_gen when only feeding filters of the current
+     * batch, several of which may raise its ready field concurrently */
+    unsigned batch_shared_gen;
 };
 
 static av_always_inline int ff_filter_execute(AVFilterContext *ctx, avfilter_action_func *func,
@@ -347,6 +376,13 @@ int ff_request_frame(AVFilterLink *link);
  */
 int ff_filter_frame(AVFilterLink *link, AVFrame *frame);
 
+/**
+ * Add the data size of frame to the bytes copied by the graph of ctx.
+ * To be called by filters copying a whole input frame because it was
+ * not writable.
+ */
+void ff_filter_account_copy(AVFilterContext *ctx, const AVFrame *frame);
+
 /**
  * Allocate a new filter context and return it.
  *
@@ -370,6 +406,20 @@ void ff_filter_graph_remove_filter(AVFilterGraph *graph, AVFilterContext *filter
  */
 #define FF_FILTER_FLAG_HWFRAME_AWARE (1 << 0)
 
+/**
+ * The filter accesses filters of the graph other than its direct neighbours,
+ * e.g. to send them commands. It is never activated concurrently with other
+ * filters.
+ */
+#define FF_FILTER_FLAG_GRAPH_GLOBAL  (1 << 1)
+
+/**
+ * The filter processes several frames concurrently through
+ * ff_filter_execute(), see framethread.h. It uses the graph threads like
+ * filters supporting AVFILTER_FLAG_SLICE_THREADS.
+ */
+#define FF_FILTER_FLAG_FRAME_THREADS (1 << 2)
+
 /**
  * Run one round of processing on a filter graph.
  */
@@ -23,6 +23,7 @@
 
 #include "config.h"
 
+#include "libavutil/avassert.h"
 #include "libavutil/common.h"
 #include "libavutil/mem.h"
 #include "libavutil/thread.h"
@@ -41,12 +42,24 @@ typedef struct ThreadContext {
     AVFilterContext *ctx;
     void *arg;
     int   *rets;
+
+    /* set while a batch of filters is being activated */
+    AVFilterContext **filters;
+    /* protects the ready field of the filters shared by the batch */
+    pthread_mutex_t ready_lock;
 } ThreadContext;
 
 static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb_threads)
 {
     ThreadContext *c = priv;
-    int ret = c->func(c->ctx, c->arg, jobnr, nb_jobs);
+    int ret;
+
+    if (c->filters) {
+        c->rets[jobnr] = ff_filter_activate(c->filters[jobnr]);
+        return;
+    }
+
+    ret = c->func(c->ctx, c->arg, jobnr, nb_jobs);
     if (c->rets)
         c->rets[jobnr] = ret;
 }
@@ -54,6 +67,7 @@ static void worker_func(void *priv, int jobnr, int threadnr, int nb_jobs, int nb
 static void slice_thread_uninit(ThreadContext *c)
 {
     avpriv_slicethread_free(&c->thread);
+    pthread_mutex_destroy(&c->ready_lock);
 }
 
 static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
@@ -63,6 +77,18 @@ static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
 
     if (nb_jobs <= 0)
         return 0;
+
+    /* the threads are busy activating filters, one of which called us */
+    if (c->filters) {
+        int i;
+        for (i = 0; i < nb_jobs; i++) {
+            int r = func(ctx, arg, i, nb_jobs);
+            if (ret)
+                ret[i] = r;
+        }
+        return 0;
+    }
+
     c->ctx         = ctx;
     c->arg         = arg;
     c->func        = func;
@@ -74,9 +100,15 @@ static int thread_execute(AVFilterContext *ctx, avfilter_action_func *func,
 
 static int thread_init_internal(ThreadContext *c, int nb_threads)
 {
+    int ret = pthread_mutex_init(&c->ready_lock, NULL);
+    if (ret)
+        return AVERROR(ret);
+
     nb_threads = avpriv_slicethread_create(&c->thread, c, worker_func, NULL, nb_threads);
-    if (nb_threads <= 1)
+    if (nb_threads <= 1) {
         avpriv_slicethread_free(&c->thread);
+        pthread_mutex_destroy(&c->ready_lock);
+    }
     return FFMAX(nb_threads, 1);
 }
 
@@ -107,6 +139,35 @@ int ff_graph_thread_init(AVFilterGraph *graph)
     return 0;
 }
 
+int ff_graph_thread_activate(AVFilterGraph *graph, AVFilterContext **filters,
+                             int nb_filters)
+{
+    ThreadContext *c = graph->internal->thread;
+    int rets[MAX_GRAPH_BATCH];
+    int i;
+
+    av_assert1(nb_filters <= MAX_GRAPH_BATCH);
+
+    c->filters = filters;
+    c->rets    = rets;
+    avpriv_slicethread_execute(c->thread, nb_filters, 0);
+    c->filters = NULL;
+
+    for (i = 0; i < nb_filters; i++)
+        if (rets[i] < 0)
+            return rets[i];
+    return 0;
+}
+
+void ff_graph_thread_set_ready(AVFilterContext *filter, unsigned priority)
+{
+    ThreadContext *c = filter->graph->internal->thread;
+
+    pthread_mutex_lock(&c->ready_lock);
+    filter->ready = FFMAX(filter->ready, priority);
+    pthread_mutex_unlock(&c->ready_lock);
+}
+
 void ff_graph_thread_free(AVFilterGraph *graph)
 {
     if (graph->internal->thread)
@@ -0,0 +1,241 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Add and get frames in batches with av_buffersrc_add_frames() and
+ * av_buffersink_get_frames(), including a batch that fails halfway and
+ * the returns after the end of stream.
+ * With -s, compare the cost per frame with adding and getting the frames
+ * one by one instead.
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "libavutil/channel_layout.h"
+#include "libavutil/frame.h"
+#include "libavutil/mem.h"
+#include "libavutil/time.h"
+#include "libavfilter/avfilter.h"
+#include "libavfilter/buffersink.h"
+#include "libavfilter/buffersrc.h"
+
+#define SAMPLES      32
+#define BATCH        16
+#define SPEED_FRAMES 160000
+
+static AVFilterGraph   *graph;
+static AVFilterContext *src, *sink;
+static AVFrame *frames[BATCH];
+static int next_pts;
+
+static const char *ret_str(int ret)
+{
+    static char buf[16];
+
+    switch (ret) {
+    case AVERROR(EAGAIN): return "EAGAIN";
+    case AVERROR(EINVAL): return "EINVAL";
+    case AVERROR_EOF:     return "EOF";
+    }
+    snprintf(buf, sizeof(buf), "%d", ret);
+    return buf;
+}
+
+static int fill_frames(int nb_frames)
+{
+    int i, j, ret;
+
+    for (i = 0; i < nb_frames; i++) {
+        AVFrame *frame = frames[i];
+        int16_t *samples;
+
+        av_frame_unref(frame);
+        frame->format         = AV_SAMPLE_FMT_S16;
+        frame->channel_layout = AV_CH_LAYOUT_STEREO;
+        frame->channels       = 2;
+        frame->sample_rate    = 48000;
+        frame->nb_samples     = SAMPLES;
+        frame->pts            = next_pts;
+        ret = av_frame_get_buffer(frame, 0);
+        if (ret < 0)
+            return ret;
+        samples = (int16_t *)frame->data[0];
+        for (j = 0; j < 2 * SAMPLES; j++)
+            samples[j] = 100 * (next_pts / SAMPLES) + j;
+        next_pts += SAMPLES;
+    }
+    return 0;
+}
+
+static int get_frames(int nb_frames, int flags)
+{
+    int i, ret;
+
+    ret = av_buffersink_get_frames(sink, frames, nb_frames, flags);
+    printf("get %d:", nb_frames);
+    if (ret <= 0)
+        printf(" %s", ret_str(ret));
+    for (i = 0; i < ret; i++) {
+        const int16_t *samples = (const int16_t *)frames[i]->data[0];
+
+        printf(" %"PRId64":%d:%d", frames[i]->pts, frames[i]->nb_samples, samples[1]);
+        av_frame_unref(frames[i]);
+    }
+    printf("\n");
+    return ret;
+}
+
+static int create_graph(const char *desc)
+{
+    AVFilterInOut *inputs = NULL, *outputs = NULL;
+    int ret;
+
+    avfilter_graph_free(&graph);
+    graph = avfilter_graph_alloc();
+    if (!graph)
+        return AVERROR(ENOMEM);
+
+    ret = avfilter_graph_create_filter(&src, avfilter_get_by_name("abuffer"), "in",
+                                       "sample_rate=48000:sample_fmt=s16:"
+                                       "channel_layout=stereo:time_base=1/48000",
+                                       NULL, graph);
+    if (ret < 0)
+        return ret;
+    ret = avfilter_graph_create_filter(&sink, avfilter_get_by_name("abuffersink"), "out",
+                                       NULL, NULL, graph);
+    if (ret < 0)
+        return ret;
+
+    ret = avfilter_graph_parse2(graph, desc, &inputs, &outputs);
+    if (ret < 0)
+        goto end;
+    if ((ret = avfilter_link(src, 0, inputs->filter_ctx, inputs->pad_idx)) < 0 ||
+        (ret = avfilter_link(outputs->filter_ctx, outputs->pad_idx, sink, 0)) < 0)
+        goto end;
+    ret = avfilter_graph_config(graph, NULL);
+
+end:
+    avfilter_inout_free(&inputs);
+    avfilter_inout_free(&outputs);
+    return ret;
+}
+
+/* time per frame with one frame per call, or BATCH frames per call */
+static int64_t speed_test(int batch)
+{
+    int64_t start;
+    int i, j, ret;
+
+    if (create_graph("volume=0.5,asetpts=PTS,anull,aformat=sample_fmts=s16") < 0)
+        return -1;
+
+    start = av_gettime_relative();
+    for (i = 0; i < SPEED_FRAMES; i += BATCH) {
+        if (fill_frames(BATCH) < 0)
+            return -1;
+        if (batch) {
+            if (av_buffersrc_add_frames(src, frames, BATCH, AV_BUFFERSRC_FLAG_PUSH) < 0)
+                return -1;
+            while ((ret = av_buffersink_get_frames(sink, frames, BATCH, 0)) > 0)
+                for (j = 0; j < ret; j++)
+                    av_frame_unref(frames[j]);
+        } else {
+            for (j = 0; j < BATCH; j++) {
+                if (av_buffersrc_add_frame_flags(src, frames[j], AV_BUFFERSRC_FLAG_PUSH) < 0)
+                    return -1;
+                while ((ret = av_buffersink_get_frame(sink, frames[j])) >= 0)
+                    av_frame_unref(frames[j]);
+            }
+        }
+        if (ret != AVERROR(EAGAIN))
+            return -1;
+    }
+    return (av_gettime_relative() - start) * 1000 / SPEED_FRAMES;
+}
+
+int main(int argc, char **argv)
+{
+    int i, ret;
+
+    for (i = 0; i < BATCH; i++)
+        if (!(frames[i] = av_frame_alloc()))
+            return 1;
+
+    /* compare the cost per frame of both APIs, alternating the runs */
+    if (argc > 1 && !strcmp(argv[1], "-s")) {
+        for (i = 0; i < 5; i++) {
+            int64_t single = speed_test(0), batch = speed_test(1);
+
+            if (single < 0 || batch < 0)
+                return 1;
+            printf("run %d: %"PRId64" ns per frame, %"PRId64" ns in batches of %d\n",
+                   i, single, batch, BATCH);
+        }
+        goto end;
+    }
+
+    if (create_graph("volume=0.5:precision=fixed,asetpts=PTS+1") < 0)
+        return 1;
+
+    /* nothing queued yet */
+    get_frames(8, AV_BUFFERSINK_FLAG_NO_REQUEST);
+
+    /* a full batch, got back with a smaller limit */
+    if (fill_frames(8) < 0)
+        return 1;
+    ret = av_buffersrc_add_frames(src, frames, 8, AV_BUFFERSRC_FLAG_PUSH);
+    printf("add 8: %s\n", ret < 0 ? ret_str(ret) : "ok");
+    get_frames(5, 0);
+    get_frames(5, 0);
+    get_frames(5, 0);
+    get_frames(5, AV_BUFFERSINK_FLAG_PEEK);
+
+    /* the frames before the invalid one are added and reset,
+     * the others are left untouched */
+    if (fill_frames(4) < 0)
+        return 1;
+    frames[2]->channels = 1;
+    ret = av_buffersrc_add_frames(src, frames, 4, AV_BUFFERSRC_FLAG_PUSH);
+    printf("add 4 with an invalid third frame: %s, kept", ret_str(ret));
+    for (i = 0; i < 4; i++)
+        printf(" %d", !!frames[i]->buf[0]);
+    printf("\n");
+    get_frames(8, 0);
+
+    /* the frames queued before the end of stream are returned first */
+    if (fill_frames(3) < 0)
+        return 1;
+    ret = av_buffersrc_add_frames(src, frames, 3, 0);
+    printf("add 3 without push: %s\n", ret < 0 ? ret_str(ret) : "ok");
+    ret = av_buffersrc_close(src, next_pts, AV_BUFFERSRC_FLAG_PUSH);
+    printf("close: %s\n", ret < 0 ? ret_str(ret) : "ok");
+    if (fill_frames(1) < 0)
+        return 1;
+    ret = av_buffersrc_add_frames(src, frames, 1, AV_BUFFERSRC_FLAG_PUSH);
+    printf("add 1 after close: %s\n", ret_str(ret));
+    get_frames(2, 0);
+    get_frames(2, 0);
+    get_frames(2, 0);
+
+end:
+    for (i = 0; i < BATCH; i++)
+        av_frame_free(&frames[i]);
+    avfilter_graph_free(&graph);
+    return 0;
+}
@@ -0,0 +1,136 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+#include <stdio.h>
+
+#include "libavfilter/framepool.c"
+
+static void print_stats(FFSizePool *pool, const char *what)
+{
+    uint64_t nb_allocated, nb_reused;
+
+    ff_size_pool_get_stats(pool, &nb_allocated, &nb_reused);
+    printf("%-28s allocated %"PRIu64" reused %"PRIu64" idle %"SIZE_SPECIFIER"\n",
+           what, nb_allocated, nb_reused, pool->idle_size);
+}
+
+static int check_size_classes(void)
+{
+    static const size_t sizes[] = {
+        0, 1, 64, 65, 80, 81, 96, 112, 113, 128, 129, 1000, 4096, 4097,
+        460800, 3110400, 12441600, INT_MAX,
+    };
+    size_t size, class_size, prev_class_size = 0;
+    int cls, prev_cls = -1, ret = 0;
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(sizes); i++) {
+        cls = size_class(sizes[i], &class_size);
+        printf("size %10"SIZE_SPECIFIER" -> class %3d of %10"SIZE_SPECIFIER"\n",
+               sizes[i], cls, class_size);
+    }
+
+    /* Every size must fit in its class, waste less than a quarter of it,
+     * and the classes must be contiguous and ordered by size. */
+    for (size = 1; size <= 1 << 20; size++) {
+        cls = size_class(size, &class_size);
+        if (class_size < size || (size > 64 && class_size - size >= class_size / 4) ||
+            cls < 0 || cls >= SIZE_POOL_CLASSES ||
+            (class_size == prev_class_size) != (cls == prev_cls) ||
+            (prev_cls >= 0 && cls != prev_cls && cls != prev_cls + 1)) {
+            printf("bad class %d of %"SIZE_SPECIFIER" for size %"SIZE_SPECIFIER"\n",
+                   cls, class_size, size);
+            ret = 1;
+            break;
+        }
+        prev_cls        = cls;
+        prev_class_size = class_size;
+    }
+    return ret;
+}
+
+int main(void)
+{
+    AVBufferRef *bufs[6] = { NULL };
+    FFSizePool *pool;
+    size_t class_size;
+    uint8_t *data;
+    int cls, i;
+
+    if (check_size_classes())
+        return 1;
+
+    pool = ff_size_pool_alloc(NULL);
+    if (!pool)
+        return 1;
+
+    /* a released buffer serves its own class and up to
+     * SIZE_POOL_FALLBACK smaller ones */
+    cls = size_class(100000, &class_size);
+    bufs[0] = ff_size_pool_get(pool, 100000);
+    if (!bufs[0])
+        return 1;
+    data = bufs[0]->data;
+    av_buffer_unref(&bufs[0]);
+    print_stats(pool, "released one buffer");
+
+    for (i = 0; i <= SIZE_POOL_FALLBACK + 1; i++) {
+        size_t request = class_size;
+
+        /* the largest size of the class i below */
+        while (size_class(request, &(size_t){ 0 }) > cls - i)
+            request--;
+        bufs[0] = ff_size_pool_get(pool, request);
+        if (!bufs[0])
+            return 1;
+        printf("class %d below: %s\n", i,
+               bufs[0]->data == data ? "reused" : "new buffer");
+        if (bufs[0]->data != data) {
+            av_buffer_unref(&bufs[0]);
+            break;
+        }
+        av_buffer_unref(&bufs[0]);
+    }
+    print_stats(pool, "after the fallback requests");
+
+    /* buffers beyond max_idle are freed when released */
+    ff_size_pool_unref(&pool);
+    pool = ff_size_pool_alloc(NULL);
+    if (!pool)
+        return 1;
+    size_class(4096, &class_size);
+    ff_size_pool_set_max_idle(pool, 3 * class_size);
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bufs); i++)
+        if (!(bufs[i] = ff_size_pool_get(pool, 4096)))
+            return 1;
+    for (i = 0; i < FF_ARRAY_ELEMS(bufs); i++)
+        av_buffer_unref(&bufs[i]);
+    print_stats(pool, "released 6 with room for 3");
+
+    for (i = 0; i < FF_ARRAY_ELEMS(bufs); i++)
+        if (!(bufs[i] = ff_size_pool_get(pool, 4096)))
+            return 1;
+    print_stats(pool, "requested 6 again");
+
+    /* the buffers in use keep the pool alive */
+    ff_size_pool_unref(&pool);
+    for (i = 0; i < FF_ARRAY_ELEMS(bufs); i++)
+        av_buffer_unref(&bufs[i]);
+
+    return 0;
+}
@@ -0,0 +1,156 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Run frames through graphs with filters working in place and print how
+ * much frame data the graphs copied to get writable frames.
+ */
+
+#include <stdio.h>
+
+#include "libavutil/frame.h"
+#include "libavutil/mem.h"
+#include "libavfilter/avfilter.h"
+#include "libavfilter/buffersink.h"
+#include "libavfilter/buffersrc.h"
+
+#define WIDTH  64
+#define HEIGHT 48
+#define FRAMES 5
+
+static const char *const graphs[] = {
+    "drawbox=t=fill",
+    "split[a][b];[a]drawbox=t=fill[out0];[b]hflip[out1]",
+    "split[a][b];[b]hflip[out1];[a]drawbox=t=fill[out0]",
+    "split[a][b];[a]drawbox=t=fill[out0];[b]drawbox=t=fill:c=red[out1]",
+    "split[a][b];[b]scale=32:24[s];[a][s]overlay[out0]",
+    "split[a][b];[b]scale=32:24[s];[a][s]overlay=shortest=1[out0]",
+    "split[a][b];[b]scale=32:24[s];[a][s]overlay=eof_action=pass[out0]",
+    "split=3[a][b][c];[c]scale=32:24[s];[a][s]overlay=shortest=1[out0];[b]hflip[out1]",
+    "crop=iw:ih-16:0:16,split[a][b];[a]pad=iw:ih+8:0:8[out0];[b]hflip[out1]",
+    "split[a][b];[a]pad=iw+16:ih[out0];[b]hflip[out1]",
+};
+
+static int run_graph(const char *desc, uint64_t *copied)
+{
+    AVFilterGraph *graph = avfilter_graph_alloc();
+    AVFilterInOut *inputs = NULL, *outputs = NULL, *cur;
+    AVFilterContext *src = NULL, *sinks[2] = { NULL };
+    AVFrame *frame = NULL;
+    char args[256];
+    int nb_sinks = 0, ret, i, j;
+
+    if (!graph)
+        return AVERROR(ENOMEM);
+
+    snprintf(args, sizeof(args), "video_size=%dx%d:pix_fmt=yuv420p:time_base=1/25",
+             WIDTH, HEIGHT);
+    ret = avfilter_graph_create_filter(&src, avfilter_get_by_name("buffer"),
+                                       "in", args, NULL, graph);
+    if (ret < 0)
+        goto end;
+
+    ret = avfilter_graph_parse2(graph, desc, &inputs, &outputs);
+    if (ret < 0)
+        goto end;
+    if (!inputs || inputs->next) {
+        ret = AVERROR(EINVAL);
+        goto end;
+    }
+    ret = avfilter_link(src, 0, inputs->filter_ctx, inputs->pad_idx);
+    if (ret < 0)
+        goto end;
+    for (cur = outputs; cur; cur = cur->next) {
+        if (nb_sinks == FF_ARRAY_ELEMS(sinks)) {
+            ret = AVERROR(EINVAL);
+            goto end;
+        }
+        snprintf(args, sizeof(args), "out%d", nb_sinks);
+        ret = avfilter_graph_create_filter(&sinks[nb_sinks], avfilter_get_by_name("buffersink"),
+                                           args, NULL, NULL, graph);
+        if (ret < 0)
+            goto end;
+        ret = avfilter_link(cur->filter_ctx, cur->pad_idx, sinks[nb_sinks], 0);
+        if (ret < 0)
+            goto end;
+        nb_sinks++;
+    }
+
+    ret = avfilter_graph_config(graph, NULL);
+    if (ret < 0)
+        goto end;
+
+    frame = av_frame_alloc();
+    if (!frame) {
+        ret = AVERROR(ENOMEM);
+        goto end;
+    }
+    for (i = 0; i <= FRAMES; i++) {
+        if (i < FRAMES) {
+            frame->format = AV_PIX_FMT_YUV420P;
+            frame->width  = WIDTH;
+            frame->height = HEIGHT;
+            frame->pts    = i;
+            ret = av_frame_get_buffer(frame, 0);
+            if (ret < 0)
+                goto end;
+            for (j = 0; j < 3; j++)
+                memset(frame->data[j], 16 * (i + j), frame->linesize[j] * (j ? HEIGHT / 2 : HEIGHT));
+            ret = av_buffersrc_add_frame(src, frame);
+        } else {
+            ret = av_buffersrc_add_frame(src, NULL);
+        }
+        if (ret < 0)
+            goto end;
+
+        for (j = 0; j < nb_sinks; j++) {
+            while ((ret = av_buffersink_get_frame(sinks[j], frame)) >= 0)
+                av_frame_unref(frame);
+            if (ret != AVERROR(EAGAIN) && ret != AVERROR_EOF)
+                goto end;
+        }
+    }
+    ret = 0;
+    *copied = avfilter_graph_get_copied_bytes(graph);
+
+end:
+    av_frame_free(&frame);
+    avfilter_inout_free(&inputs);
+    avfilter_inout_free(&outputs);
+    avfilter_graph_free(&graph);
+    return ret;
+}
+
+int main(void)
+{
+    int i, ret;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(graphs); i++) {
+        uint64_t copied = 0;
+
+        ret = run_graph(graphs[i], &copied);
+        if (ret < 0) {
+            fprintf(stderr, "%s: failed: %s\n", graphs[i], av_err2str(ret));
+            return 1;
+        }
+        printf("%s: %"PRIu64" bytes copied for %d frames of %d bytes\n",
+               graphs[i], copied, FRAMES, WIDTH * HEIGHT * 3 / 2);
+    }
+
+    return 0;
+}
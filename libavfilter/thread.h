@@ -21,8 +21,27 @@
 
 #include "avfilter.h"
 
+/* maximum number of filters activated concurrently */
+#define MAX_GRAPH_BATCH 16
+
 int ff_graph_thread_init(AVFilterGraph *graph);
 
 void ff_graph_thread_free(AVFilterGraph *graph);
 
+/**
+ * Activate the given filters concurrently on the graph threads.
+ * The filters must not share any state, see ff_filter_graph_run_once().
+ *
+ * @return the first error returned by ff_filter_activate(), in array order,
+ *         or 0
+ */
+int ff_graph_thread_activate(AVFilterGraph *graph, AVFilterContext **filters,
+                             int nb_filters);
+
+/**
+ * Raise the ready priority of a filter feeding several filters of the batch
+ * being activated, which may all do it at the same time.
+ */
+void ff_graph_thread_set_ready(AVFilterContext *filter, unsigned priority);
+
 #endif /* AVFILTER_THREAD_H */
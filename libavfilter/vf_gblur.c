@@ -245,6 +245,8 @@ void ff_gblur_init(GBlurContext *s)
     s->horiz_slice = horiz_slice_c;
     s->verti_slice = verti_slice_c;
     s->postscale_slice = postscale_c;
+    if (ARCH_AARCH64)
+        ff_gblur_init_aarch64(s);
     if (ARCH_X86)
         ff_gblur_init_x86(s);
 }
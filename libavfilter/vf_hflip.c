@@ -162,6 +162,8 @@ int ff_hflip_init(FlipContext *s, int step[4], int nb_planes)
             return AVERROR_BUG;
         }
     }
+    if (ARCH_AARCH64)
+        ff_hflip_init_aarch64(s, step, nb_planes);
     if (ARCH_X86)
         ff_hflip_init_x86(s, step, nb_planes);
 
@@ -866,6 +866,15 @@ static int blend_slice_rgba_pm(AVFilterContext *ctx, void *arg, int jobnr, int n
     return 0;
 }
 
+av_cold void ff_overlay_init_blend_row(OverlayContext *s, int format, int pix_format,
+                                      int alpha_format, int main_has_alpha)
+{
+    if (ARCH_AARCH64)
+        ff_overlay_init_aarch64(s, format, pix_format, alpha_format, main_has_alpha);
+    if (ARCH_X86)
+        ff_overlay_init_x86(s, format, pix_format, alpha_format, main_has_alpha);
+}
+
 static int config_input_main(AVFilterLink *inlink)
 {
     OverlayContext *s = inlink->dst->priv;
@@ -983,9 +992,8 @@ static int config_input_main(AVFilterLink *inlink)
     }
 
 end:
-    if (ARCH_X86)
-        ff_overlay_init_x86(s, s->format, inlink->format,
-                            s->alpha_format, s->main_has_alpha);
+    ff_overlay_init_blend_row(s, s->format, inlink->format,
+                              s->alpha_format, s->main_has_alpha);
 
     return 0;
 }
@@ -1088,6 +1096,7 @@ static const AVFilterPad avfilter_vf_overlay_inputs[] = {
     {
         .name         = "main",
         .type         = AVMEDIA_TYPE_VIDEO,
+        .flags        = AVFILTERPAD_FLAG_IN_PLACE,
         .config_props = config_input_main,
     },
     {
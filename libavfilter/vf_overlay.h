@@ -82,6 +82,15 @@ typedef struct OverlayContext {
     int (*blend_slice)(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs);
 } OverlayContext;
 
+/**
+ * Set the SIMD blend_row functions, if any. The rows they leave out, and
+ * all rows without one, are blended in C.
+ */
+void ff_overlay_init_blend_row(OverlayContext *s, int format, int pix_format,
+                               int alpha_format, int main_has_alpha);
+
+void ff_overlay_init_aarch64(OverlayContext *s, int format, int pix_format,
+                             int alpha_format, int main_has_alpha);
 void ff_overlay_init_x86(OverlayContext *s, int format, int pix_format,
                          int alpha_format, int main_has_alpha);
 
@@ -398,6 +398,7 @@ static int filter_frame(AVFilterLink *inlink, AVFrame *in)
         ff_copy_rectangle2(&s->draw,
                           out->data, out->linesize, in->data, in->linesize,
                           s->x, s->y, 0, 0, in->width, in->height);
+        ff_filter_account_copy(inlink->dst, in);
     }
 
     /* right border */
@@ -437,6 +438,7 @@ static const AVFilterPad avfilter_vf_pad_inputs[] = {
     {
         .name             = "default",
         .type             = AVMEDIA_TYPE_VIDEO,
+        .flags            = AVFILTERPAD_FLAG_IN_PLACE,
         .config_props     = config_input,
         .get_buffer.video = get_video_buffer,
         .filter_frame     = filter_frame,
@@ -107,6 +107,13 @@ typedef struct ScaleContext {
     const AVClass *class;
     struct SwsContext *sws;     ///< software scaler context
     struct SwsContext *isws[2]; ///< software scaler context for interlaced material
+    /**
+     * Contexts of the output slices after the first one when slice
+     * threading, indexed like in sws_context()
+     */
+    struct SwsContext *(*slice_sws)[3];
+    int *slice_ret;
+    int nb_slices;
     AVDictionary *opts;
 
     /**
@@ -325,16 +332,38 @@ static av_cold int init_dict(AVFilterContext *ctx, AVDictionary **opts)
     return 0;
 }
 
+/**
+ * Return the context used for output slice slice, of the whole frame for
+ * idx 0 and of field idx - 1 otherwise.
+ */
+static struct SwsContext **sws_context(ScaleContext *scale, int slice, int idx)
+{
+    if (!slice)
+        return idx ? &scale->isws[idx - 1] : &scale->sws;
+    return &scale->slice_sws[slice - 1][idx];
+}
+
+static void free_sws_contexts(ScaleContext *scale)
+{
+    for (int slice = 0; slice < FFMAX(scale->nb_slices, 1); slice++) {
+        for (int i = 0; i < 3; i++) {
+            struct SwsContext **s = sws_context(scale, slice, i);
+            sws_freeContext(*s);
+            *s = NULL;
+        }
+    }
+    av_freep(&scale->slice_sws);
+    av_freep(&scale->slice_ret);
+    scale->nb_slices = 0;
+}
+
 static av_cold void uninit(AVFilterContext *ctx)
 {
     ScaleContext *scale = ctx->priv;
     av_expr_free(scale->w_pexpr);
     av_expr_free(scale->h_pexpr);
     scale->w_pexpr = scale->h_pexpr = NULL;
-    sws_freeContext(scale->sws);
-    sws_freeContext(scale->isws[0]);
-    sws_freeContext(scale->isws[1]);
-    scale->sws = NULL;
+    free_sws_contexts(scale);
     av_dict_free(&scale->opts);
 }
 
@@ -507,13 +536,7 @@ static int config_props(AVFilterLink *outlink)
     if (outfmt == AV_PIX_FMT_PAL8) outfmt = AV_PIX_FMT_BGR8;
     scale->output_is_pal = av_pix_fmt_desc_get(outfmt)->flags & AV_PIX_FMT_FLAG_PAL;
 
-    if (scale->sws)
-        sws_freeContext(scale->sws);
-    if (scale->isws[0])
-        sws_freeContext(scale->isws[0]);
-    if (scale->isws[1])
-        sws_freeContext(scale->isws[1]);
-    scale->isws[0] = scale->isws[1] = scale->sws = NULL;
+    free_sws_contexts(scale);
     if (inlink0->w == outlink->w &&
         inlink0->h == outlink->h &&
         !scale->out_color_matrix &&
@@ -521,60 +544,86 @@ static int config_props(AVFilterLink *outlink)
         inlink0->format == outlink->format)
         ;
     else {
-        struct SwsContext **swscs[3] = {&scale->sws, &scale->isws[0], &scale->isws[1]};
-        int i;
-
-        for (i = 0; i < 3; i++) {
-            int in_v_chr_pos = scale->in_v_chr_pos, out_v_chr_pos = scale->out_v_chr_pos;
-            struct SwsContext *const s = sws_alloc_context();
-            if (!s)
+        /* When slice threading, every output slice is scaled by its own
+         * single-threaded context on the filter graph threads. */
+        int nb_slices = ctx->thread_type ? ff_filter_get_nb_threads(ctx) : 1;
+        int slice, i;
+
+        if (nb_slices > 1) {
+            scale->slice_sws = av_calloc(nb_slices - 1, sizeof(*scale->slice_sws));
+            scale->slice_ret = av_calloc(nb_slices, sizeof(*scale->slice_ret));
+            if (!scale->slice_sws || !scale->slice_ret)
                 return AVERROR(ENOMEM);
-            *swscs[i] = s;
-
-            av_opt_set_int(s, "srcw", inlink0 ->w, 0);
-            av_opt_set_int(s, "srch", inlink0 ->h >> !!i, 0);
-            av_opt_set_int(s, "src_format", inlink0->format, 0);
-            av_opt_set_int(s, "dstw", outlink->w, 0);
-            av_opt_set_int(s, "dsth", outlink->h >> !!i, 0);
-            av_opt_set_int(s, "dst_format", outfmt, 0);
-            av_opt_set_int(s, "sws_flags", scale->flags, 0);
-            av_opt_set_int(s, "param0", scale->param[0], 0);
-            av_opt_set_int(s, "param1", scale->param[1], 0);
-            av_opt_set_int(s, "threads", ff_filter_get_nb_threads(ctx), 0);
-            if (scale->in_range != AVCOL_RANGE_UNSPECIFIED)
-                av_opt_set_int(s, "src_range",
-                               scale->in_range == AVCOL_RANGE_JPEG, 0);
-            if (scale->out_range != AVCOL_RANGE_UNSPECIFIED)
-                av_opt_set_int(s, "dst_range",
-                               scale->out_range == AVCOL_RANGE_JPEG, 0);
-
-            if (scale->opts) {
-                AVDictionaryEntry *e = NULL;
-                while ((e = av_dict_get(scale->opts, "", e, AV_DICT_IGNORE_SUFFIX))) {
-                    if ((ret = av_opt_set(s, e->key, e->value, 0)) < 0)
-                        return ret;
+        }
+        scale->nb_slices = nb_slices;
+
+        for (slice = 0; slice < nb_slices; slice++) {
+            for (i = 0; i < 3; i++) {
+                int in_v_chr_pos = scale->in_v_chr_pos, out_v_chr_pos = scale->out_v_chr_pos;
+                struct SwsContext *const s = sws_alloc_context();
+                if (!s)
+                    return AVERROR(ENOMEM);
+                *sws_context(scale, slice, i) = s;
+
+                av_opt_set_int(s, "srcw", inlink0 ->w, 0);
+                av_opt_set_int(s, "srch", inlink0 ->h >> !!i, 0);
+                av_opt_set_int(s, "src_format", inlink0->format, 0);
+                av_opt_set_int(s, "dstw", outlink->w, 0);
+                av_opt_set_int(s, "dsth", outlink->h >> !!i, 0);
+                av_opt_set_int(s, "dst_format", outfmt, 0);
+                av_opt_set_int(s, "sws_flags", scale->flags, 0);
+                av_opt_set_int(s, "param0", scale->param[0], 0);
+                av_opt_set_int(s, "param1", scale->param[1], 0);
+                av_opt_set_int(s, "threads", ctx->thread_type ? 1 : ff_filter_get_nb_threads(ctx), 0);
+                if (scale->in_range != AVCOL_RANGE_UNSPECIFIED)
+                    av_opt_set_int(s, "src_range",
+                                   scale->in_range == AVCOL_RANGE_JPEG, 0);
+                if (scale->out_range != AVCOL_RANGE_UNSPECIFIED)
+                    av_opt_set_int(s, "dst_range",
+                                   scale->out_range == AVCOL_RANGE_JPEG, 0);
+
+                if (scale->opts) {
+                    AVDictionaryEntry *e = NULL;
+                    while ((e = av_dict_get(scale->opts, "", e, AV_DICT_IGNORE_SUFFIX))) {
+                        if ((ret = av_opt_set(s, e->key, e->value, 0)) < 0)
+                            return ret;
+                    }
+                }
+                /* Override YUV420P default settings to have the correct (MPEG-2) chroma positions
+                 * MPEG-2 chroma positions are used by convention
+                 * XXX: support other 4:2:0 pixel formats */
+                if (inlink0->format == AV_PIX_FMT_YUV420P && scale->in_v_chr_pos == -513) {
+                    in_v_chr_pos = (i == 0) ? 128 : (i == 1) ? 64 : 192;
                 }
-            }
-            /* Override YUV420P default settings to have the correct (MPEG-2) chroma positions
-             * MPEG-2 chroma positions are used by convention
-             * XXX: support other 4:2:0 pixel formats */
-            if (inlink0->format == AV_PIX_FMT_YUV420P && scale->in_v_chr_pos == -513) {
-                in_v_chr_pos = (i == 0) ? 128 : (i == 1) ? 64 : 192;
-            }
 
-            if (outlink->format == AV_PIX_FMT_YUV420P && scale->out_v_chr_pos == -513) {
-                out_v_chr_pos = (i == 0) ? 128 : (i == 1) ? 64 : 192;
-            }
+                if (outlink->format == AV_PIX_FMT_YUV420P && scale->out_v_chr_pos == -513) {
+                    out_v_chr_pos = (i == 0) ? 128 : (i == 1) ? 64 : 192;
+                }
 
-            av_opt_set_int(s, "src_h_chr_pos", scale->in_h_chr_pos, 0);
-            av_opt_set_int(s, "src_v_chr_pos", in_v_chr_pos, 0);
-            av_opt_set_int(s, "dst_h_chr_pos", scale->out_h_chr_pos, 0);
-            av_opt_set_int(s, "dst_v_chr_pos", out_v_chr_pos, 0);
+                av_opt_set_int(s, "src_h_chr_pos", scale->in_h_chr_pos, 0);
+                av_opt_set_int(s, "src_v_chr_pos", in_v_chr_pos, 0);
+                av_opt_set_int(s, "dst_h_chr_pos", scale->out_h_chr_pos, 0);
+                av_opt_set_int(s, "dst_v_chr_pos", out_v_chr_pos, 0);
 
-            if ((ret = sws_init_context(s, NULL, NULL)) < 0)
-                return ret;
-            if (!scale->interlaced)
-                break;
+                if ((ret = sws_init_context(s, NULL, NULL)) < 0)
+                    return ret;
+                if (!scale->interlaced)
+                    break;
+            }
+
+            /* error diffusion carries state from line to line */
+            if (!slice && nb_slices > 1) {
+                const AVOption *ed = av_opt_find(scale->sws, "ed", "sws_dither", 0, 0);
+                int64_t dither;
+
+                if (ed && av_opt_get_int(scale->sws, "sws_dither", 0, &dither) >= 0 &&
+                    dither == ed->default_val.i64) {
+                    av_log(ctx, AV_LOG_VERBOSE,
+                           "Error-diffusion dither is in use, scaling will be single-threaded.\n");
+                    scale->nb_slices = 1;
+                    break;
+                }
+            }
         }
     }
 
@@ -627,9 +676,64 @@ static void frame_offset(AVFrame *frame, int dir, int is_pal)
     }
 }
 
-static int scale_field(ScaleContext *scale, AVFrame *dst, AVFrame *src,
+typedef struct ScaleThreadData {
+    AVFrame *in, *out;
+    int idx;
+    int slice_height;
+} ScaleThreadData;
+
+static int scale_slice(AVFilterContext *ctx, void *arg, int jobnr, int nb_jobs)
+{
+    ScaleContext *scale = ctx->priv;
+    ScaleThreadData *td = arg;
+    struct SwsContext *c = *sws_context(scale, jobnr, td->idx);
+    const int slice_start = jobnr * td->slice_height;
+    const int slice_end   = FFMIN(slice_start + td->slice_height, td->out->height);
+    int ret;
+
+    ret = sws_frame_start(c, td->out, td->in);
+    if (ret < 0)
+        return ret;
+
+    ret = sws_send_slice(c, 0, td->in->height);
+    if (ret >= 0)
+        ret = sws_receive_slice(c, slice_start, slice_end - slice_start);
+
+    sws_frame_end(c);
+
+    return ret;
+}
+
+/**
+ * Scale src into dst with the contexts of index idx, splitting the output
+ * into slices that are processed in parallel.
+ */
+static int scale_slices(AVFilterContext *ctx, AVFrame *dst, AVFrame *src, int idx)
+{
+    ScaleContext *scale = ctx->priv;
+    ScaleThreadData td = { .in = src, .out = dst, .idx = idx };
+    unsigned align;
+    int nb_jobs;
+
+    if (scale->nb_slices <= 1)
+        return sws_scale_frame(*sws_context(scale, 0, idx), dst, src);
+
+    align = sws_receive_slice_alignment(*sws_context(scale, 0, idx));
+    td.slice_height = FFALIGN((dst->height + scale->nb_slices - 1) / scale->nb_slices, align);
+    nb_jobs = (dst->height + td.slice_height - 1) / td.slice_height;
+
+    ff_filter_execute(ctx, scale_slice, &td, scale->slice_ret, nb_jobs);
+
+    for (int i = 0; i < nb_jobs; i++)
+        if (scale->slice_ret[i] < 0)
+            return scale->slice_ret[i];
+    return 0;
+}
+
+static int scale_field(AVFilterContext *ctx, AVFrame *dst, AVFrame *src,
                        int field)
 {
+    ScaleContext *scale = ctx->priv;
     int orig_h_src = src->height;
     int orig_h_dst = dst->height;
     int ret;
@@ -648,7 +752,7 @@ static int scale_field(ScaleContext *scale, AVFrame *dst, AVFrame *src,
     src->height /= 2;
     dst->height /= 2;
 
-    ret = sws_scale_frame(scale->isws[field], dst, src);
+    ret = scale_slices(ctx, dst, src, 1 + field);
     if (ret < 0)
         return ret;
 
@@ -803,17 +907,15 @@ scale:
         if (scale->out_range != AVCOL_RANGE_UNSPECIFIED)
             out_full = (scale->out_range == AVCOL_RANGE_JPEG);
 
-        sws_setColorspaceDetails(scale->sws, inv_table, in_full,
-                                 table, out_full,
-                                 brightness, contrast, saturation);
-        if (scale->isws[0])
-            sws_setColorspaceDetails(scale->isws[0], inv_table, in_full,
-                                     table, out_full,
-                                     brightness, contrast, saturation);
-        if (scale->isws[1])
-            sws_setColorspaceDetails(scale->isws[1], inv_table, in_full,
-                                     table, out_full,
-                                     brightness, contrast, saturation);
+        for (int slice = 0; slice < FFMAX(scale->nb_slices, 1); slice++) {
+            for (int i = 0; i < 3; i++) {
+                struct SwsContext *s = *sws_context(scale, slice, i);
+                if (s)
+                    sws_setColorspaceDetails(s, inv_table, in_full,
+                                             table, out_full,
+                                             brightness, contrast, saturation);
+            }
+        }
 
         out->color_range = out_full ? AVCOL_RANGE_JPEG : AVCOL_RANGE_MPEG;
     }
@@ -824,11 +926,11 @@ scale:
               INT_MAX);
 
     if (scale->interlaced>0 || (scale->interlaced<0 && in->interlaced_frame)) {
-        ret = scale_field(scale, out, in, 0);
+        ret = scale_field(ctx, out, in, 0);
         if (ret >= 0)
-            ret = scale_field(scale, out, in, 1);
+            ret = scale_field(ctx, out, in, 1);
     } else {
-        ret = sws_scale_frame(scale->sws, out, in);
+        ret = scale_slices(ctx, out, in, 0);
     }
 
     av_frame_free(&in);
@@ -996,6 +1098,7 @@ const AVFilter ff_vf_scale = {
     .uninit          = uninit,
     .priv_size       = sizeof(ScaleContext),
     .priv_class      = &scale_class,
+    .flags           = AVFILTER_FLAG_SLICE_THREADS,
     FILTER_INPUTS(avfilter_vf_scale_inputs),
     FILTER_OUTPUTS(avfilter_vf_scale_outputs),
     FILTER_QUERY_FUNC(query_formats),
@@ -1037,6 +1140,7 @@ const AVFilter ff_vf_scale2ref = {
     .uninit          = uninit,
     .priv_size       = sizeof(ScaleContext),
     .priv_class      = &scale_class,
+    .flags           = AVFILTER_FLAG_SLICE_THREADS,
     FILTER_INPUTS(avfilter_vf_scale2ref_inputs),
     FILTER_OUTPUTS(avfilter_vf_scale2ref_outputs),
     FILTER_QUERY_FUNC(query_formats),
@@ -28,6 +28,8 @@
 
 #include "avfilter.h"
 #include "filters.h"
+#include "framethread.h"
+#include "internal.h"
 #include "scene_sad.h"
 
 typedef struct SCDetContext {
@@ -40,11 +42,16 @@ typedef struct SCDetContext {
     ff_scene_sad_fn sad;
     double prev_mafd;
     double scene_score;
-    AVFrame *prev_picref;
     double threshold;
     int sc_pass;
+    FFFrameThread ft;
 } SCDetContext;
 
+typedef struct SCDetJob {
+    int valid;
+    uint64_t sad;
+} SCDetJob;
+
 #define OFFSET(x) offsetof(SCDetContext, x)
 #define V AV_OPT_FLAG_VIDEO_PARAM
 #define F AV_OPT_FLAG_FILTERING_PARAM
@@ -101,88 +108,99 @@ static av_cold void uninit(AVFilterContext *ctx)
 {
     SCDetContext *s = ctx->priv;
 
-    av_frame_free(&s->prev_picref);
+    ff_framethread_uninit(&s->ft);
 }
 
-static double get_scene_score(AVFilterContext *ctx, AVFrame *frame)
+static int set_meta(SCDetContext *s, AVFrame *frame, const char *key, const char *value)
+{
+    return av_dict_set(&frame->metadata, key, value, 0);
+}
+
+/* The SAD against the previous frame does not depend on the other frames
+ * and is computed for a batch of frames concurrently. */
+static int compute_sad(AVFilterContext *ctx, FFFrameThreadJob *job)
 {
-    double ret = 0;
     SCDetContext *s = ctx->priv;
-    AVFrame *prev_picref = s->prev_picref;
+    SCDetJob *j = job->priv;
+    const AVFrame *prev_picref = job->prev;
+    const AVFrame *frame = job->in;
 
     if (prev_picref && frame->height == prev_picref->height
                     && frame->width  == prev_picref->width) {
-        uint64_t sad = 0;
-        double mafd, diff;
-        uint64_t count = 0;
-
         for (int plane = 0; plane < s->nb_planes; plane++) {
             uint64_t plane_sad;
             s->sad(prev_picref->data[plane], prev_picref->linesize[plane],
                     frame->data[plane], frame->linesize[plane],
                     s->width[plane], s->height[plane], &plane_sad);
-            sad += plane_sad;
-            count += s->width[plane] * s->height[plane];
+            j->sad += plane_sad;
         }
-
         emms_c();
-        mafd = (double)sad * 100. / count / (1ULL << s->bitdepth);
+        j->valid = 1;
+    }
+    return 0;
+}
+
+static double get_scene_score(AVFilterContext *ctx, const SCDetJob *j)
+{
+    double ret = 0;
+    SCDetContext *s = ctx->priv;
+
+    if (j->valid) {
+        double mafd, diff;
+        uint64_t count = 0;
+
+        for (int plane = 0; plane < s->nb_planes; plane++)
+            count += s->width[plane] * s->height[plane];
+
+        mafd = (double)j->sad * 100. / count / (1ULL << s->bitdepth);
         diff = fabs(mafd - s->prev_mafd);
         ret  = av_clipf(FFMIN(mafd, diff), 0, 100.);
         s->prev_mafd = mafd;
-        av_frame_free(&prev_picref);
     }
-    s->prev_picref = av_frame_clone(frame);
     return ret;
 }
 
-static int set_meta(SCDetContext *s, AVFrame *frame, const char *key, const char *value)
+static int finish(AVFilterContext *ctx, FFFrameThreadJob *job)
 {
-    return av_dict_set(&frame->metadata, key, value, 0);
+    AVFilterLink *inlink = ctx->inputs[0];
+    SCDetContext *s = ctx->priv;
+    AVFrame *frame = job->in;
+    char buf[64];
+
+    s->scene_score = get_scene_score(ctx, job->priv);
+    snprintf(buf, sizeof(buf), "%0.3f", s->prev_mafd);
+    set_meta(s, frame, "lavfi.scd.mafd", buf);
+    snprintf(buf, sizeof(buf), "%0.3f", s->scene_score);
+    set_meta(s, frame, "lavfi.scd.score", buf);
+
+    if (s->scene_score > s->threshold) {
+        av_log(s, AV_LOG_INFO, "lavfi.scd.score: %.3f, lavfi.scd.time: %s\n",
+                s->scene_score, av_ts2timestr(frame->pts, &inlink->time_base));
+        set_meta(s, frame, "lavfi.scd.time",
+                av_ts2timestr(frame->pts, &inlink->time_base));
+    }
+    if (!s->sc_pass || s->scene_score > s->threshold)
+        job->out = frame;
+
+    return 0;
 }
 
-static int activate(AVFilterContext *ctx)
+static av_cold int init(AVFilterContext *ctx)
 {
-    int ret;
-    AVFilterLink *inlink = ctx->inputs[0];
-    AVFilterLink *outlink = ctx->outputs[0];
     SCDetContext *s = ctx->priv;
-    AVFrame *frame;
-
-    FF_FILTER_FORWARD_STATUS_BACK(outlink, inlink);
-
-    ret = ff_inlink_consume_frame(inlink, &frame);
-    if (ret < 0)
-        return ret;
-
-    if (frame) {
-        char buf[64];
-        s->scene_score = get_scene_score(ctx, frame);
-        snprintf(buf, sizeof(buf), "%0.3f", s->prev_mafd);
-        set_meta(s, frame, "lavfi.scd.mafd", buf);
-        snprintf(buf, sizeof(buf), "%0.3f", s->scene_score);
-        set_meta(s, frame, "lavfi.scd.score", buf);
-
-        if (s->scene_score > s->threshold) {
-            av_log(s, AV_LOG_INFO, "lavfi.scd.score: %.3f, lavfi.scd.time: %s\n",
-                    s->scene_score, av_ts2timestr(frame->pts, &inlink->time_base));
-            set_meta(s, frame, "lavfi.scd.time",
-                    av_ts2timestr(frame->pts, &inlink->time_base));
-        }
-        if (s->sc_pass) {
-            if (s->scene_score > s->threshold)
-                return ff_filter_frame(outlink, frame);
-            else {
-                av_frame_free(&frame);
-            }
-        } else
-            return ff_filter_frame(outlink, frame);
-    }
 
-    FF_FILTER_FORWARD_STATUS(inlink, outlink);
-    FF_FILTER_FORWARD_WANTED(outlink, inlink);
+    s->ft.process       = compute_sad;
+    s->ft.finish        = finish;
+    s->ft.job_priv_size = sizeof(SCDetJob);
+    s->ft.need_prev     = 1;
+    return ff_framethread_init(&s->ft, ctx);
+}
+
+static int activate(AVFilterContext *ctx)
+{
+    SCDetContext *s = ctx->priv;
 
-    return FFERROR_NOT_READY;
+    return ff_framethread_activate(&s->ft);
 }
 
 static const AVFilterPad scdet_inputs[] = {
@@ -205,8 +223,10 @@ const AVFilter ff_vf_scdet = {
     .description   = NULL_IF_CONFIG_SMALL("Detect video scene change"),
     .priv_size     = sizeof(SCDetContext),
     .priv_class    = &scdet_class,
+    .init          = init,
     .uninit        = uninit,
     .flags         = AVFILTER_FLAG_METADATA_ONLY,
+    .flags_internal = FF_FILTER_FLAG_FRAME_THREADS,
     FILTER_INPUTS(scdet_inputs),
     FILTER_OUTPUTS(scdet_outputs),
     FILTER_PIXFMTS_ARRAY(pix_fmts),
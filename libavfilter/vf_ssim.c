@@ -218,6 +218,16 @@ static double ssim_endn_8bit(const int (*sum0)[4], const int (*sum1)[4], int wid
     return ssim;
 }
 
+void ff_ssim_init(SSIMDSPContext *dsp)
+{
+    dsp->ssim_4x4_line = ssim_4x4xn_8bit;
+    dsp->ssim_end_line = ssim_endn_8bit;
+    if (ARCH_AARCH64)
+        ff_ssim_init_aarch64(dsp);
+    if (ARCH_X86)
+        ff_ssim_init_x86(dsp);
+}
+
 #define SUM_LEN(w) (((w) >> 2) + 3)
 
 typedef struct ThreadData {
@@ -476,10 +486,7 @@ static int config_input_ref(AVFilterLink *inlink)
     s->max = (1 << desc->comp[0].depth) - 1;
 
     s->ssim_plane = desc->comp[0].depth > 8 ? ssim_plane_16bit : ssim_plane;
-    s->dsp.ssim_4x4_line = ssim_4x4xn_8bit;
-    s->dsp.ssim_end_line = ssim_endn_8bit;
-    if (ARCH_X86)
-        ff_ssim_init_x86(&s->dsp);
+    ff_ssim_init(&s->dsp);
 
     s->score = av_calloc(s->nb_threads, sizeof(*s->score));
     if (!s->score)
@@ -47,6 +47,7 @@ AVFrame *ff_default_get_video_buffer(AVFilterLink *link, int w, int h)
     int pool_height = 0;
     int pool_align = 0;
     enum AVPixelFormat pool_format = AV_PIX_FMT_NONE;
+    FFSizePool *size_pool = link->graph ? link->graph->internal->buffer_pool : NULL;
 
     if (link->hw_frames_ctx &&
         ((AVHWFramesContext*)link->hw_frames_ctx->data)->format == link->format) {
@@ -64,7 +65,7 @@ AVFrame *ff_default_get_video_buffer(AVFilterLink *link, int w, int h)
     }
 
     if (!link->frame_pool) {
-        link->frame_pool = ff_frame_pool_video_init(av_buffer_allocz, w, h,
+        link->frame_pool = ff_frame_pool_video_init(av_buffer_allocz, size_pool, w, h,
                                                     link->format, BUFFER_ALIGN);
         if (!link->frame_pool)
             return NULL;
@@ -79,7 +80,7 @@ AVFrame *ff_default_get_video_buffer(AVFilterLink *link, int w, int h)
             pool_format != link->format || pool_align != BUFFER_ALIGN) {
 
             ff_frame_pool_uninit((FFFramePool **)&link->frame_pool);
-            link->frame_pool = ff_frame_pool_video_init(av_buffer_allocz, w, h,
+            link->frame_pool = ff_frame_pool_video_init(av_buffer_allocz, size_pool, w, h,
                                                         link->format, BUFFER_ALIGN);
             if (!link->frame_pool)
                 return NULL;
@@ -86,6 +86,12 @@ typedef struct YADIFContext {
     int current_field;  ///< YADIFCurrentField
 } YADIFContext;
 
+/**
+ * Set the line filter functions for the bit depth of yadif->csp.
+ */
+void ff_yadif_init_filter_line(YADIFContext *yadif);
+
+void ff_yadif_init_aarch64(YADIFContext *yadif);
 void ff_yadif_init_x86(YADIFContext *yadif);
 
 int ff_yadif_filter_frame(AVFilterLink *link, AVFrame *frame);
@@ -16,16 +16,41 @@
  * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
  */
 
+#include "config.h"
+
+#define _DEFAULT_SOURCE
+#define _SVID_SOURCE // needed for MAP_ANONYMOUS
+#define _DARWIN_C_SOURCE // needed for MAP_ANON
 #include <stdatomic.h>
 #include <stdint.h>
 #include <string.h>
+#if HAVE_MMAP
+#include <sys/mman.h>
+#if defined(MAP_ANON) && !defined(MAP_ANONYMOUS)
+#define MAP_ANONYMOUS MAP_ANON
+#endif
+#endif
 
 #include "avassert.h"
 #include "buffer_internal.h"
 #include "common.h"
 #include "mem.h"
+#include "mem_internal.h"
 #include "thread.h"
 
+/* buffers at least this large are candidates for a hugepage mapping */
+#define HUGEPAGE_SHIFT 21
+#define HUGEPAGE_SIZE  (1 << HUGEPAGE_SHIFT)
+
+/* The default hugepage size of the system may be another one (1 GiB, or
+ * 512 MiB with 64k pages), which the mapping size would not be a multiple
+ * of, so ask for HUGEPAGE_SIZE explicitly. */
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+#define MAP_HUGETLB_2MB (MAP_HUGETLB | (HUGEPAGE_SHIFT << MAP_HUGE_SHIFT))
+#endif
+
+static atomic_int hugepages_flags = ATOMIC_VAR_INIT(0);
+
 static AVBufferRef *buffer_create(AVBuffer *buf, uint8_t *data, size_t size,
                                   void (*free)(void *opaque, uint8_t *data),
                                   void *opaque, int flags)
@@ -74,12 +99,79 @@ void av_buffer_default_free(void *opaque, uint8_t *data)
     av_free(data);
 }
 
-AVBufferRef *av_buffer_alloc(size_t size)
+void av_buffer_set_hugepages(int flags)
+{
+    atomic_store_explicit(&hugepages_flags, flags, memory_order_relaxed);
+}
+
+#if HAVE_MMAP && defined(MAP_ANONYMOUS)
+static void buffer_hugepages_free(void *opaque, uint8_t *data)
+{
+    munmap(data, (size_t)(uintptr_t)opaque);
+}
+
+/*
+ * Map a large buffer directly from the kernel, so that it can be backed by
+ * hugepages. The pages are not touched here: with the default first-touch
+ * policy they end up on the NUMA node of the thread that first writes to
+ * them, i.e. the one producing the frame, rather than the allocating one.
+ * Anonymous mappings are zero-filled, which av_buffer_allocz() relies on.
+ */
+static AVBufferRef *buffer_alloc_hugepages(size_t size, int flags)
+{
+    size_t map_size = FFALIGN(size, HUGEPAGE_SIZE);
+    void *data = MAP_FAILED;
+    AVBufferRef *ret;
+
+    /* Honour av_max_alloc() like av_malloc(), which is used when this fails. */
+    if (map_size < size || size > ff_max_alloc_size())
+        return NULL;
+
+#ifdef MAP_HUGETLB_2MB
+    if (flags & AV_BUFFER_HUGEPAGES_EXPLICIT)
+        data = mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB_2MB, -1, 0);
+#endif
+    if (data == MAP_FAILED) {
+        if (!(flags & AV_BUFFER_HUGEPAGES_TRANSPARENT))
+            return NULL;
+        data = mmap(NULL, map_size, PROT_READ | PROT_WRITE,
+                    MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (data == MAP_FAILED)
+            return NULL;
+#if HAVE_MADVISE && defined(MADV_HUGEPAGE)
+        madvise(data, map_size, MADV_HUGEPAGE);
+#endif
+    }
+
+    ret = av_buffer_create(data, size, buffer_hugepages_free,
+                           (void *)(uintptr_t)map_size, 0);
+    if (!ret)
+        munmap(data, map_size);
+
+    return ret;
+}
+#endif
+
+static AVBufferRef *buffer_alloc(size_t size, int zero)
 {
     AVBufferRef *ret = NULL;
     uint8_t    *data = NULL;
 
-    data = av_malloc(size);
+#if HAVE_MMAP && defined(MAP_ANONYMOUS)
+    int flags = atomic_load_explicit(&hugepages_flags, memory_order_relaxed);
+
+    if (flags && size >= HUGEPAGE_SIZE) {
+        ret = buffer_alloc_hugepages(size, flags);
+        if (ret) {
+            if (CONFIG_MEMORY_POISONING && !zero)
+                memset(ret->data, FF_MEMORY_POISON, size);
+            return ret;
+        }
+    }
+#endif
+
+    data = zero ? av_mallocz(size) : av_malloc(size);
     if (!data)
         return NULL;
 
@@ -90,14 +182,14 @@ AVBufferRef *av_buffer_alloc(size_t size)
     return ret;
 }
 
-AVBufferRef *av_buffer_allocz(size_t size)
+AVBufferRef *av_buffer_alloc(size_t size)
 {
-    AVBufferRef *ret = av_buffer_alloc(size);
-    if (!ret)
-        return NULL;
+    return buffer_alloc(size, 0);
+}
 
-    memset(ret->data, 0, size);
-    return ret;
+AVBufferRef *av_buffer_allocz(size_t size)
+{
+    return buffer_alloc(size, 1);
 }
 
 AVBufferRef *av_buffer_ref(const AVBufferRef *buf)
@@ -256,6 +348,14 @@ int av_buffer_replace(AVBufferRef **pdst, const AVBufferRef *src)
     return 0;
 }
 
+static void buffer_pool_init_cache(AVBufferPool *pool)
+{
+    int i;
+
+    for (i = 0; i < BUFFER_POOL_CACHE_SIZE; i++)
+        atomic_init(&pool->cache[i], 0);
+}
+
 AVBufferPool *av_buffer_pool_init2(size_t size, void *opaque,
                                    AVBufferRef* (*alloc)(void *opaque, size_t size),
                                    void (*pool_free)(void *opaque))
@@ -273,6 +373,7 @@ AVBufferPool *av_buffer_pool_init2(size_t size, void *opaque,
     pool->pool_free = pool_free;
 
     atomic_init(&pool->refcount, 1);
+    buffer_pool_init_cache(pool);
 
     return pool;
 }
@@ -289,12 +390,58 @@ AVBufferPool *av_buffer_pool_init(size_t size, AVBufferRef* (*alloc)(size_t size
     pool->alloc    = alloc ? alloc : av_buffer_alloc;
 
     atomic_init(&pool->refcount, 1);
+    buffer_pool_init_cache(pool);
 
     return pool;
 }
 
+static BufferPoolEntry *buffer_pool_cache_get(AVBufferPool *pool)
+{
+    int i;
+
+    for (i = 0; i < BUFFER_POOL_CACHE_SIZE; i++) {
+        /* only write to the slots that look occupied */
+        if (atomic_load_explicit(&pool->cache[i], memory_order_relaxed)) {
+            uintptr_t buf = atomic_exchange_explicit(&pool->cache[i], 0,
+                                                     memory_order_acquire);
+            if (buf)
+                return (BufferPoolEntry *)buf;
+        }
+    }
+
+    return NULL;
+}
+
+static int buffer_pool_cache_put(AVBufferPool *pool, BufferPoolEntry *buf)
+{
+    /* start from a slot depending on the entry so that concurrent
+     * releases do not all compete for the same one */
+    unsigned start = ((uintptr_t)buf / sizeof(*buf)) % BUFFER_POOL_CACHE_SIZE;
+    int i;
+
+    for (i = 0; i < BUFFER_POOL_CACHE_SIZE; i++) {
+        atomic_uintptr_t *slot = &pool->cache[(start + i) % BUFFER_POOL_CACHE_SIZE];
+        uintptr_t expected = 0;
+
+        if (!atomic_load_explicit(slot, memory_order_relaxed) &&
+            atomic_compare_exchange_strong_explicit(slot, &expected, (uintptr_t)buf,
+                                                    memory_order_release,
+                                                    memory_order_relaxed))
+            return 1;
+    }
+
+    return 0;
+}
+
 static void buffer_pool_flush(AVBufferPool *pool)
 {
+    BufferPoolEntry *entry;
+
+    while ((entry = buffer_pool_cache_get(pool))) {
+        entry->free(entry->opaque, entry->data);
+        av_free(entry);
+    }
+
     while (pool->pool) {
         BufferPoolEntry *buf = pool->pool;
         pool->pool = buf->next;
@@ -344,10 +491,12 @@ static void pool_release_buffer(void *opaque, uint8_t *data)
     if(CONFIG_MEMORY_POISONING)
         memset(buf->data, FF_MEMORY_POISON, pool->size);
 
-    ff_mutex_lock(&pool->mutex);
-    buf->next = pool->pool;
-    pool->pool = buf;
-    ff_mutex_unlock(&pool->mutex);
+    if (!buffer_pool_cache_put(pool, buf)) {
+        ff_mutex_lock(&pool->mutex);
+        buf->next = pool->pool;
+        pool->pool = buf;
+        ff_mutex_unlock(&pool->mutex);
+    }
 
     if (atomic_fetch_sub_explicit(&pool->refcount, 1, memory_order_acq_rel) == 1)
         buffer_pool_free(pool);
@@ -389,6 +538,23 @@ AVBufferRef *av_buffer_pool_get(AVBufferPool *pool)
     AVBufferRef *ret;
     BufferPoolEntry *buf;
 
+    buf = buffer_pool_cache_get(pool);
+    if (buf) {
+        memset(&buf->buffer, 0, sizeof(buf->buffer));
+        ret = buffer_create(&buf->buffer, buf->data, pool->size,
+                            pool_release_buffer, buf, 0);
+        if (ret) {
+            buf->buffer.flags_internal |= BUFFER_FLAG_NO_FREE;
+            atomic_fetch_add_explicit(&pool->refcount, 1, memory_order_relaxed);
+            return ret;
+        }
+        /* hand the entry back and let the locked path deal with the error */
+        ff_mutex_lock(&pool->mutex);
+        buf->next = pool->pool;
+        pool->pool = buf;
+        ff_mutex_unlock(&pool->mutex);
+    }
+
     ff_mutex_lock(&pool->mutex);
     buf = pool->pool;
     if (buf) {
@@ -107,6 +107,32 @@ AVBufferRef *av_buffer_alloc(size_t size);
  */
 AVBufferRef *av_buffer_allocz(size_t size);
 
+/**
+ * Advise the kernel to back large buffers with transparent hugepages.
+ */
+#define AV_BUFFER_HUGEPAGES_TRANSPARENT (1 << 0)
+/**
+ * Map large buffers from the explicitly reserved hugepage pool (MAP_HUGETLB).
+ * When the pool is exhausted, transparent hugepages are used instead if
+ * AV_BUFFER_HUGEPAGES_TRANSPARENT is also set, or av_malloc() otherwise.
+ */
+#define AV_BUFFER_HUGEPAGES_EXPLICIT    (1 << 1)
+
+/**
+ * Set how av_buffer_alloc() and av_buffer_allocz() allocate large buffers,
+ * such as frame data and the default buffer pool entries.
+ *
+ * Buffers of at least 2 MiB are then mapped directly from the system, if
+ * supported, instead of going through av_malloc(). Their pages are not
+ * touched on allocation, so they are placed on the NUMA node of the thread
+ * that first writes to them. This can be changed at any time and affects
+ * subsequent allocations only.
+ *
+ * @param flags a combination of AV_BUFFER_HUGEPAGES_* flags, 0 (the default)
+ *              to always use av_malloc()
+ */
+void av_buffer_set_hugepages(int flags);
+
 /**
  * Always treat the buffer as read-only, even when it has only one
  * reference.
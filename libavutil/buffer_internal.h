@@ -86,10 +86,23 @@ typedef struct BufferPoolEntry {
     AVBuffer buffer;
 } BufferPoolEntry;
 
+/**
+ * Number of released entries kept in the lock-free cache of a pool.
+ */
+#define BUFFER_POOL_CACHE_SIZE 16
+
 struct AVBufferPool {
     AVMutex mutex;
     BufferPoolEntry *pool;
 
+    /*
+     * Lock-free cache of released entries, used before falling back to the
+     * mutex-protected list above. Each slot holds either 0 or a pointer to a
+     * BufferPoolEntry; entries are only taken out with an atomic exchange,
+     * so a given entry cannot be handed out twice.
+     */
+    atomic_uintptr_t cache[BUFFER_POOL_CACHE_SIZE];
+
     /*
      * This is used to track when the pool is to be freed.
      * The pointer to the pool itself held by the caller is considered to
@@ -108,4 +121,10 @@ struct AVBufferPool {
     void         (*pool_free)(void *opaque);
 };
 
+/**
+ * Get the maximum block size set with av_max_alloc(), for buffers that
+ * bypass av_malloc(). Defined in mem.c.
+ */
+size_t ff_max_alloc_size(void);
+
 #endif /* AVUTIL_BUFFER_INTERNAL_H */
@@ -59,6 +59,7 @@ void  free(void *ptr);
 
 #endif /* MALLOC_PREFIX */
 
+#include "buffer_internal.h"
 #include "mem_internal.h"
 
 #define ALIGN (HAVE_AVX512 ? 64 : (HAVE_AVX ? 32 : 16))
@@ -74,6 +75,11 @@ void av_max_alloc(size_t max){
     atomic_store_explicit(&max_alloc_size, max, memory_order_relaxed);
 }
 
+size_t ff_max_alloc_size(void)
+{
+    return atomic_load_explicit(&max_alloc_size, memory_order_relaxed);
+}
+
 static int size_mult(size_t a, size_t b, size_t *r)
 {
     size_t t;
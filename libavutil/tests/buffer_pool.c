@@ -0,0 +1,125 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * This test program gets and releases buffers from a single AVBufferPool
+ * in several threads at once and checks that no buffer is handed out to
+ * two users at the same time.
+ *
+ * Usage: buffer_pool [threads [iterations]]
+ * When any argument is given, the get/release throughput is printed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "libavutil/buffer.h"
+#include "libavutil/macros.h"
+#include "libavutil/thread.h"
+#include "libavutil/time.h"
+
+#define MAX_THREADS 64
+#define BUF_SIZE    4096
+/* number of buffers held at the same time by each thread */
+#define HELD        4
+
+typedef struct ThreadData {
+    AVBufferPool *pool;
+    int index;
+    int iterations;
+    int failed;
+} ThreadData;
+
+static void *thread_main(void *arg)
+{
+    ThreadData *td = arg;
+    AVBufferRef *held[HELD] = { NULL };
+    int i, j;
+
+    for (i = 0; i < td->iterations; i++) {
+        int idx = i % HELD;
+
+        if (held[idx]) {
+            /* another thread writing to our buffer would show up here */
+            for (j = 0; j < BUF_SIZE; j += 64)
+                if (held[idx]->data[j] != (uint8_t)(td->index + idx))
+                    td->failed = 1;
+            av_buffer_unref(&held[idx]);
+        }
+
+        held[idx] = av_buffer_pool_get(td->pool);
+        if (!held[idx]) {
+            td->failed = 1;
+            break;
+        }
+        for (j = 0; j < BUF_SIZE; j += 64)
+            held[idx]->data[j] = td->index + idx;
+    }
+
+    for (i = 0; i < HELD; i++)
+        av_buffer_unref(&held[i]);
+
+    return NULL;
+}
+
+int main(int argc, char **argv)
+{
+    ThreadData td[MAX_THREADS];
+    pthread_t threads[MAX_THREADS];
+    AVBufferPool *pool;
+    int nb_threads = argc > 1 ? atoi(argv[1]) : 4;
+    int iterations = argc > 2 ? atoi(argv[2]) : 20000;
+    int64_t t0, t1;
+    int i, ret, failed = 0;
+
+    if (nb_threads < 1 || nb_threads > MAX_THREADS || iterations < 1) {
+        fprintf(stderr, "Usage: %s [threads (1-%d) [iterations]]\n",
+                argv[0], MAX_THREADS);
+        return 1;
+    }
+
+    pool = av_buffer_pool_init(BUF_SIZE, NULL);
+    if (!pool)
+        return 1;
+
+    t0 = av_gettime_relative();
+    for (i = 0; i < nb_threads; i++) {
+        td[i].pool       = pool;
+        td[i].index      = i * HELD;
+        td[i].iterations = iterations;
+        td[i].failed     = 0;
+        if ((ret = pthread_create(&threads[i], NULL, thread_main, &td[i]))) {
+            fprintf(stderr, "pthread_create failed: %s.\n", strerror(ret));
+            return 1;
+        }
+    }
+    for (i = 0; i < nb_threads; i++) {
+        pthread_join(threads[i], NULL);
+        failed |= td[i].failed;
+    }
+    t1 = av_gettime_relative();
+
+    av_buffer_pool_uninit(&pool);
+
+    if (argc > 1)
+        printf("%d threads: %.2f Mget+release/s\n", nb_threads,
+               (double)nb_threads * iterations / FFMAX(t1 - t0, 1));
+
+    return failed ? 2 : 0;
+}
@@ -26,15 +26,71 @@ void ff_hscale_8_to_15_neon(SwsContext *c, int16_t *dst, int dstW,
                             const uint8_t *src, const int16_t *filter,
                             const int32_t *filterPos, int filterSize);
 
+void ff_hscale_float_neon(SwsContext *c, int16_t *dst, int dstW,
+                          const uint8_t *src, const int16_t *filter,
+                          const int32_t *filterPos, int filterSize);
+
 void ff_yuv2planeX_8_neon(const int16_t *filter, int filterSize,
                           const int16_t **src, uint8_t *dest, int dstW,
                           const uint8_t *dither, int offset);
 
+void ff_yuv2planeX_float_neon(const int16_t *filter, int filterSize,
+                              const int16_t **src, uint8_t *dest, int dstW,
+                              const uint8_t *dither, int offset);
+
+#define YUV2NV12CX_FUNC(name) \
+void ff_ ## name ## cX_neon(enum AVPixelFormat format, const uint8_t *dither, \
+                            const int16_t *filter, int filterSize, \
+                            const int16_t **u, const int16_t **v, \
+                            uint8_t *dst, int dstWidth)
+
+YUV2NV12CX_FUNC(yuv2nv12);
+YUV2NV12CX_FUNC(yuv2nv21);
+
+#define INPUT_Y_FUNC(fmt) \
+void ff_ ## fmt ## ToY_neon(uint8_t *dst, const uint8_t *src, \
+                            const uint8_t *unused1, const uint8_t *unused2, \
+                            int width, uint32_t *rgb2yuv)
+#define INPUT_UV_FUNC(fmt, suffix) \
+void ff_ ## fmt ## ToUV ## suffix ## _neon(uint8_t *dstU, uint8_t *dstV, \
+                                           const uint8_t *unused0, \
+                                           const uint8_t *src1, \
+                                           const uint8_t *src2, \
+                                           int width, uint32_t *rgb2yuv)
+#define INPUT_FUNC(fmt) \
+    INPUT_Y_FUNC(fmt); \
+    INPUT_UV_FUNC(fmt, ); \
+    INPUT_UV_FUNC(fmt, _half)
+
+INPUT_FUNC(rgb24);
+INPUT_FUNC(bgr24);
+INPUT_FUNC(rgba);
+INPUT_FUNC(bgra);
+INPUT_FUNC(argb);
+INPUT_FUNC(abgr);
+
+#define case_rgb(x, X) \
+    case AV_PIX_FMT_ ## X: \
+        c->lumToYV12 = ff_ ## x ## ToY_neon; \
+        if (c->chrSrcHSubSample) \
+            c->chrToYV12 = ff_ ## x ## ToUV_half_neon; \
+        else \
+            c->chrToYV12 = ff_ ## x ## ToUV_neon; \
+        break
+
 av_cold void ff_sws_init_swscale_aarch64(SwsContext *c)
 {
     int cpu_flags = av_get_cpu_flags();
 
     if (have_neon(cpu_flags)) {
+        if (c->float_path) {
+            if ((c->hLumFilterSize % 4) == 0 &&
+                (c->hChrFilterSize % 4) == 0)
+                c->hyScale = c->hcScale = ff_hscale_float_neon;
+            if (!isBE(c->dstFormat) && !c->gamma_flag)
+                c->yuv2planeX = ff_yuv2planeX_float_neon;
+            return;
+        }
         if (c->srcBpc == 8 && c->dstBpc <= 14 &&
             (c->hLumFilterSize % 8) == 0 &&
             (c->hChrFilterSize % 8) == 0)
@@ -43,6 +99,28 @@ av_cold void ff_sws_init_swscale_aarch64(SwsContext *c)
         }
         if (c->dstBpc == 8) {
             c->yuv2planeX = ff_yuv2planeX_8_neon;
+            switch (c->dstFormat) {
+            case AV_PIX_FMT_NV12:
+            case AV_PIX_FMT_NV24:
+                c->yuv2nv12cX = ff_yuv2nv12cX_neon;
+                break;
+            case AV_PIX_FMT_NV21:
+            case AV_PIX_FMT_NV42:
+                c->yuv2nv12cX = ff_yuv2nv21cX_neon;
+                break;
+            default:
+                break;
+            }
+        }
+        switch (c->srcFormat) {
+        case_rgb(rgb24, RGB24);
+        case_rgb(bgr24, BGR24);
+        case_rgb(rgba,  RGBA);
+        case_rgb(bgra,  BGRA);
+        case_rgb(argb,  ARGB);
+        case_rgb(abgr,  ABGR);
+        default:
+            break;
         }
     }
 }
@@ -1091,6 +1091,121 @@ static void grayf32##endian_name##ToY16_c(uint8_t *dst, const uint8_t *src,
 rgbf32_planar_funcs_endian(le, 0)
 rgbf32_planar_funcs_endian(be, 1)
 
+/*
+ * Readers for the float intermediates, see SwsContext.float_path. Integer
+ * samples are MSB aligned to 16 bits and divided by 65535 like on the
+ * integer path, so that they map to the same floats as there, and float
+ * samples are kept as they are so that values outside of [0,1] survive
+ * scaling. The _lin variants convert to linear light, with the same
+ * hardcoded gamma of 2.2 as gamma_value.
+ */
+static av_always_inline float read_float_sample(const uint8_t *src, int i, int bits, int is_be)
+{
+    if (bits == 32)
+        return av_int2float(is_be ? AV_RB32(src + 4 * i) : AV_RL32(src + 4 * i));
+    return (is_be ? AV_RB16(src + 2 * i) : AV_RL16(src + 2 * i)) *
+           ((1 << (16 - bits)) / 65535.0f);
+}
+
+static av_always_inline void read_float_line(uint8_t *_dst, const uint8_t *src, int width,
+                                             int bits, int is_be, int linear)
+{
+    float *dst = (float *)_dst;
+    int i;
+
+    for (i = 0; i < width; i++) {
+        float v = read_float_sample(src, i, bits, is_be);
+        if (linear)
+            v = v < 0.0f ? -powf(-v, 2.2f) : powf(v, 2.2f);
+        dst[i] = v;
+    }
+}
+
+#define float_read_funcs(name, bits, endian, linear)                                                \
+static void gray##name##ToFloat_c(uint8_t *dst, const uint8_t *src, const uint8_t *unused1,          \
+                                  const uint8_t *unused2, int width, uint32_t *unused)              \
+{                                                                                                   \
+    read_float_line(dst, src, width, bits, endian, linear);                                         \
+}                                                                                                   \
+static void planar_##name##_to_float_y(uint8_t *dst, const uint8_t *src[4],                          \
+                                       int w, int32_t *rgb2yuv)                                     \
+{                                                                                                   \
+    read_float_line(dst, src[0], w, bits, endian, linear);                                          \
+}                                                                                                   \
+static void planar_##name##_to_float_uv(uint8_t *dstU, uint8_t *dstV,                               \
+                                        const uint8_t *src[4], int w, int32_t *rgb2yuv)             \
+{                                                                                                   \
+    read_float_line(dstU, src[1], w, bits, endian, linear);                                         \
+    read_float_line(dstV, src[2], w, bits, endian, linear);                                         \
+}
+
+#define float_alpha_funcs(name, bits, endian)                                                       \
+static void planar_##name##_to_float_a(uint8_t *dst, const uint8_t *src[4],                          \
+                                       int w, int32_t *rgb2yuv)                                     \
+{                                                                                                   \
+    read_float_line(dst, src[3], w, bits, endian, 0);                                               \
+}
+
+#define float_input_funcs(bits)                         \
+    float_read_funcs(bits##le,     bits, 0, 0)          \
+    float_read_funcs(bits##be,     bits, 1, 0)          \
+    float_read_funcs(bits##le_lin, bits, 0, 1)          \
+    float_read_funcs(bits##be_lin, bits, 1, 1)          \
+    float_alpha_funcs(bits##le, bits, 0)                \
+    float_alpha_funcs(bits##be, bits, 1)
+
+float_input_funcs(9)
+float_input_funcs(10)
+float_input_funcs(12)
+float_input_funcs(14)
+float_input_funcs(16)
+float_input_funcs(32)
+
+#define assign_float_input_funcs(name, alpha_name)                  \
+    do {                                                            \
+        if (isGray(srcFormat)) {                                    \
+            c->lumToYV12     = gray##name##ToFloat_c;               \
+        } else {                                                    \
+            c->readLumPlanar = planar_##name##_to_float_y;          \
+            c->readChrPlanar = planar_##name##_to_float_uv;         \
+            c->readAlpPlanar = planar_##alpha_name##_to_float_a;    \
+        }                                                           \
+    } while (0)
+
+#define case_float_input(bits)                                                  \
+    case bits:                                                                  \
+        if (isBE(srcFormat)) {                                                  \
+            if (c->gamma_flag) assign_float_input_funcs(bits##be_lin, bits##be);\
+            else               assign_float_input_funcs(bits##be,     bits##be);\
+        } else {                                                                \
+            if (c->gamma_flag) assign_float_input_funcs(bits##le_lin, bits##le);\
+            else               assign_float_input_funcs(bits##le,     bits##le);\
+        }                                                                       \
+        break
+
+static av_cold void init_float_input_funcs(SwsContext *c)
+{
+    enum AVPixelFormat srcFormat = c->srcFormat;
+
+    c->lumToYV12     = NULL;
+    c->alpToYV12     = NULL;
+    c->chrToYV12     = NULL;
+    c->readLumPlanar = NULL;
+    c->readChrPlanar = NULL;
+    c->readAlpPlanar = NULL;
+
+    switch (av_pix_fmt_desc_get(srcFormat)->comp[0].depth) {
+    case_float_input(9);
+    case_float_input(10);
+    case_float_input(12);
+    case_float_input(14);
+    case_float_input(16);
+    case_float_input(32);
+    default:
+        av_assert0(0);
+    }
+}
+
 av_cold void ff_sws_init_input_funcs(SwsContext *c)
 {
     enum AVPixelFormat srcFormat = c->srcFormat;
@@ -1759,4 +1874,7 @@ av_cold void ff_sws_init_input_funcs(SwsContext *c)
             break;
         }
     }
+
+    if (c->float_path)
+        init_float_input_funcs(c);
 }
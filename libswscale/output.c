@@ -311,6 +311,65 @@ yuv2planeX_float(yuv2planeX_float_bswap_c_template, uint32_t, BE)
 
 #undef output_pixel
 
+/*
+ * Writers for the float intermediates, see SwsContext.float_path. The _lin
+ * variants convert back from linear light.
+ */
+static av_always_inline void
+write_f32(uint8_t *dest, int i, float v, int is_be, int linear)
+{
+    if (linear)
+        v = v < 0.0f ? -powf(-v, 1.0f / 2.2f) : powf(v, 1.0f / 2.2f);
+    if (is_be)
+        AV_WB32(dest + 4 * i, av_float2int(v));
+    else
+        AV_WL32(dest + 4 * i, av_float2int(v));
+}
+
+static av_always_inline void
+yuv2plane1_f32_c_template(const float *src, uint8_t *dest, int dstW,
+                          int is_be, int linear)
+{
+    int i;
+
+    for (i = 0; i < dstW; i++)
+        write_f32(dest, i, src[i], is_be, linear);
+}
+
+static av_always_inline void
+yuv2planeX_f32_c_template(const int16_t *filter, int filterSize, const float **src,
+                          uint8_t *dest, int dstW, int is_be, int linear)
+{
+    int i, j;
+
+    for (i = 0; i < dstW; i++) {
+        float val = 0;
+
+        for (j = 0; j < filterSize; j++)
+            val += src[j][i] * filter[j];
+        // filter=12 bit
+        write_f32(dest, i, val * (1.0f / (1 << 12)), is_be, linear);
+    }
+}
+
+#define yuv2f32_funcs(BE_LE, is_be, suffix, linear) \
+static void yuv2plane1_f32 ## BE_LE ## suffix ## _c(const int16_t *src, uint8_t *dest, int dstW, \
+                                                    const uint8_t *dither, int offset) \
+{ \
+    yuv2plane1_f32_c_template((const float *)src, dest, dstW, is_be, linear); \
+} \
+static void yuv2planeX_f32 ## BE_LE ## suffix ## _c(const int16_t *filter, int filterSize, \
+                                                    const int16_t **src, uint8_t *dest, int dstW, \
+                                                    const uint8_t *dither, int offset) \
+{ \
+    yuv2planeX_f32_c_template(filter, filterSize, (const float **)src, dest, dstW, is_be, linear); \
+}
+
+yuv2f32_funcs(LE, 0,     , 0)
+yuv2f32_funcs(BE, 1,     , 0)
+yuv2f32_funcs(LE, 0, _lin, 1)
+yuv2f32_funcs(BE, 1, _lin, 1)
+
 #define output_pixel(pos, val) \
     if (big_endian) { \
         AV_WB16(pos, av_clip_uintp2(val >> shift, output_bits)); \
@@ -2596,6 +2655,17 @@ av_cold void ff_sws_init_output_funcs(SwsContext *c,
     enum AVPixelFormat dstFormat = c->dstFormat;
     const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(dstFormat);
 
+    if (c->float_path) {
+        if (c->gamma_flag) {
+            *yuv2plane1 = isBE(dstFormat) ? yuv2plane1_f32BE_lin_c : yuv2plane1_f32LE_lin_c;
+            *yuv2planeX = isBE(dstFormat) ? yuv2planeX_f32BE_lin_c : yuv2planeX_f32LE_lin_c;
+        } else {
+            *yuv2plane1 = isBE(dstFormat) ? yuv2plane1_f32BE_c : yuv2plane1_f32LE_c;
+            *yuv2planeX = isBE(dstFormat) ? yuv2planeX_f32BE_c : yuv2planeX_f32LE_c;
+        }
+        return;
+    }
+
     if (isSemiPlanarYUV(dstFormat) && isDataInHighBits(dstFormat)) {
         av_assert0(desc->comp[0].depth == 10);
         *yuv2plane1 = isBE(dstFormat) ? yuv2p010l1_BE_c : yuv2p010l1_LE_c;
@@ -251,7 +251,7 @@ int ff_init_filters(SwsContext * c)
     int index;
     int num_ydesc;
     int num_cdesc;
-    int num_vdesc = isPlanarYUV(c->dstFormat) && !isGray(c->dstFormat) ? 2 : 1;
+    int num_vdesc = usePlanarVScale(c) && !isGray(c->dstFormat) ? 2 : 1;
     int need_lum_conv = c->lumToYV12 || c->readLumPlanar || c->alpToYV12 || c->readAlpPlanar;
     int need_chr_conv = c->chrToYV12 || c->readChrPlanar;
     int need_gamma = c->is_internal_gamma;
@@ -298,7 +298,7 @@ int ff_init_filters(SwsContext * c)
     for (i = 1; i < c->numSlice-2; ++i) {
         res = alloc_slice(&c->slice[i], c->srcFormat, lumBufSize, chrBufSize, c->chrSrcHSubSample, c->chrSrcVSubSample, 0);
         if (res < 0) goto cleanup;
-        res = alloc_lines(&c->slice[i], FFALIGN(c->srcW*2+78, 16), c->srcW);
+        res = alloc_lines(&c->slice[i], FFALIGN(c->srcW*(c->srcBpc == 32 ? 4 : 2)+78, 16), c->srcW);
         if (res < 0) goto cleanup;
     }
     // horizontal scaler output
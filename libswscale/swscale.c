@@ -122,6 +122,27 @@ static void hScale16To15_c(SwsContext *c, int16_t *dst, int dstW,
     }
 }
 
+static void hScaleFloat_c(SwsContext *c, int16_t *_dst, int dstW,
+                          const uint8_t *_src, const int16_t *filter,
+                          const int32_t *filterPos, int filterSize)
+{
+    int i;
+    float *dst       = (float *) _dst;
+    const float *src = (const float *) _src;
+
+    for (i = 0; i < dstW; i++) {
+        int j;
+        int srcPos = filterPos[i];
+        float val  = 0;
+
+        for (j = 0; j < filterSize; j++) {
+            val += src[srcPos + j] * filter[filterSize * i + j];
+        }
+        // filter=14 bit
+        dst[i] = val * (1.0f / (1 << 14));
+    }
+}
+
 // bilinear / bicubic scaling
 static void hScale8To15_c(SwsContext *c, int16_t *dst, int dstW,
                           const uint8_t *src, const int16_t *filter,
@@ -537,7 +558,7 @@ av_cold void ff_sws_init_range_convert(SwsContext *c)
 {
     c->lumConvertRange = NULL;
     c->chrConvertRange = NULL;
-    if (c->srcRange != c->dstRange && !isAnyRGB(c->dstFormat)) {
+    if (c->srcRange != c->dstRange && !isAnyRGB(c->dstFormat) && !c->float_path) {
         if (c->dstBpc <= 14) {
             if (c->srcRange) {
                 c->lumConvertRange = lumRangeFromJpeg_c;
@@ -568,7 +589,9 @@ static av_cold void sws_init_swscale(SwsContext *c)
 
     ff_sws_init_input_funcs(c);
 
-    if (c->srcBpc == 8) {
+    if (c->float_path) {
+        c->hyScale = c->hcScale = hScaleFloat_c;
+    } else if (c->srcBpc == 8) {
         if (c->dstBpc <= 14) {
             c->hyScale = c->hcScale = hScale8To15_c;
             if (c->flags & SWS_FAST_BILINEAR) {
@@ -594,6 +617,15 @@ void ff_sws_init_scale(SwsContext *c)
 {
     sws_init_swscale(c);
 
+    if (c->float_path) {
+        /* The float intermediates are only supported by C, AVX2 and NEON code. */
+        if (ARCH_X86)
+            ff_sws_init_swscale_x86(c);
+        if (ARCH_AARCH64)
+            ff_sws_init_swscale_aarch64(c);
+        return;
+    }
+
     if (ARCH_PPC)
         ff_sws_init_swscale_ppc(c);
     if (ARCH_X86)
@@ -1142,7 +1174,8 @@ int sws_receive_slice(struct SwsContext *c, unsigned int slice_start,
         return AVERROR(EAGAIN);
 
     if ((slice_start > 0 || slice_height < c->dstH) &&
-        (slice_start % align || slice_height % align)) {
+        (slice_start % align ||
+         (slice_height % align && slice_start + slice_height != c->dstH))) {
         av_log(c, AV_LOG_ERROR,
                "Incorrectly aligned output: %u/%u not multiples of %u\n",
                slice_start, slice_height, align);
@@ -1171,7 +1204,8 @@ int sws_receive_slice(struct SwsContext *c, unsigned int slice_start,
     }
 
     for (int i = 0; i < FF_ARRAY_ELEMS(dst); i++) {
-        ptrdiff_t offset = c->frame_dst->linesize[i] * (slice_start >> c->chrDstVSubSample);
+        const int vshift = (i == 1 || i == 2) ? c->chrDstVSubSample : 0;
+        ptrdiff_t offset = c->frame_dst->linesize[i] * (ptrdiff_t)(slice_start >> vshift);
         dst[i] = FF_PTR_ADD(c->frame_dst->data[i], offset);
     }
 
@@ -28,6 +28,7 @@
 
 #include "libavutil/avassert.h"
 #include "libavutil/avutil.h"
+#include "libavutil/buffer.h"
 #include "libavutil/common.h"
 #include "libavutil/frame.h"
 #include "libavutil/intreadwrite.h"
@@ -676,6 +677,24 @@ typedef struct SwsContext {
     unsigned int dst_slice_align;
     atomic_int   stride_unaligned_warned;
     atomic_int   data_unaligned_warned;
+
+    /**
+     * References to the filter cache entries owning the h/v filter and
+     * filter position arrays, or NULL when the context owns them. Shared
+     * arrays must not be modified.
+     */
+    AVBufferRef *hLumFilterRef;
+    AVBufferRef *hChrFilterRef;
+    AVBufferRef *vLumFilterRef;
+    AVBufferRef *vChrFilterRef;
+
+    /**
+     * Set if the intermediate samples are native floats in [0,1] instead of
+     * 15 or 19 bit integers, for planar RGB and gray float output. srcBpc
+     * and dstBpc are 32 then, and the input and output functions convert
+     * between the formats and the float samples.
+     */
+    int float_path;
 } SwsContext;
 //FIXME check init (where 0)
 
@@ -877,6 +896,17 @@ static av_always_inline int isPlanarRGB(enum AVPixelFormat pix_fmt)
             (AV_PIX_FMT_FLAG_PLANAR | AV_PIX_FMT_FLAG_RGB));
 }
 
+/*
+ * Whether the vertical scaler writes each plane separately, through
+ * yuv2plane1/yuv2planeX, instead of through the packed/any output functions.
+ */
+static av_always_inline int usePlanarVScale(const SwsContext *c)
+{
+    return isPlanarYUV(c->dstFormat) ||
+           (isGray(c->dstFormat) && !isALPHA(c->dstFormat)) ||
+           c->float_path;
+}
+
 static av_always_inline int usePal(enum AVPixelFormat pix_fmt)
 {
     switch (pix_fmt) {
@@ -0,0 +1,250 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU Lesser General Public
+ * License as published by the Free Software Foundation; either
+ * version 2.1 of the License, or (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+ * Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public
+ * License along with FFmpeg; if not, write to the Free Software
+ * Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+ */
+
+/*
+ * Scale float and high bit depth images to float formats, once on the float
+ * intermediates and once on the integer ones (selected with SWS_BITEXACT).
+ * Check that the float path keeps samples outside of [0,1] and agrees with
+ * the integer path on SDR input. With -bench, time both paths.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include "libavutil/avutil.h"
+#include "libavutil/imgutils.h"
+#include "libavutil/intfloat.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/lfg.h"
+#include "libavutil/mem.h"
+#include "libavutil/parseutils.h"
+#include "libavutil/pixdesc.h"
+#include "libavutil/time.h"
+
+#include "libswscale/swscale.h"
+
+#define SRC_W 96
+#define SRC_H 96
+#define DST_W 160
+#define DST_H 120
+
+/* Largest difference to the integer path, which quantizes to 15 bits
+ * before and after scaling. */
+#define MAX_DIFF 5e-4
+
+static const struct {
+    enum AVPixelFormat src, dst;
+} tests[] = {
+    { AV_PIX_FMT_GBRPF32LE,  AV_PIX_FMT_GBRPF32LE  },
+    { AV_PIX_FMT_GBRPF32BE,  AV_PIX_FMT_GBRPF32LE  },
+    { AV_PIX_FMT_GBRAPF32LE, AV_PIX_FMT_GBRAPF32LE },
+    { AV_PIX_FMT_GRAYF32LE,  AV_PIX_FMT_GRAYF32BE  },
+    { AV_PIX_FMT_GBRP10LE,   AV_PIX_FMT_GBRPF32LE  },
+    { AV_PIX_FMT_GBRP12BE,   AV_PIX_FMT_GBRPF32LE  },
+    { AV_PIX_FMT_GBRP16LE,   AV_PIX_FMT_GBRPF32LE  },
+};
+
+static const char *usage = "float_scale [-bench <iterations>] [-size <image_size>]\n";
+
+/* Fill the planes with smooth gradients plus noise in [0,1). With hdr set,
+ * float images cover [-0.25,1.75) to have samples outside of the SDR range. */
+static void fill_image(uint8_t *data[4], const int linesize[4], int w, int h,
+                       enum AVPixelFormat fmt, int hdr, AVLFG *lfg)
+{
+    const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(fmt);
+    int is_float = desc->flags & AV_PIX_FMT_FLAG_FLOAT;
+    int is_be    = desc->flags & AV_PIX_FMT_FLAG_BE;
+    int max      = (1 << desc->comp[0].depth) - 1;
+    int p, x, y;
+
+    for (p = 0; p < desc->nb_components; p++) {
+        for (y = 0; y < h; y++) {
+            uint8_t *line = data[p] + y * linesize[p];
+            for (x = 0; x < w; x++) {
+                float v = (float)(x + y) * 0.7f / (w + h) + p * 0.01f +
+                          (av_lfg_get(lfg) & 0xff) * (1.0f / 1024);
+                if (is_float) {
+                    uint32_t bits = av_float2int(hdr ? v * 2.0f - 0.25f : v);
+                    if (is_be)
+                        AV_WB32(line + 4 * x, bits);
+                    else
+                        AV_WL32(line + 4 * x, bits);
+                } else {
+                    int i = av_clip(lrintf(v * max), 0, max);
+                    if (is_be)
+                        AV_WB16(line + 2 * x, i);
+                    else
+                        AV_WL16(line + 2 * x, i);
+                }
+            }
+        }
+    }
+}
+
+static float read_sample(const uint8_t *data, int x, int is_be)
+{
+    return av_int2float(is_be ? AV_RB32(data + 4 * x) : AV_RL32(data + 4 * x));
+}
+
+static int scale(enum AVPixelFormat src_fmt, enum AVPixelFormat dst_fmt,
+                 int src_w, int src_h, int dst_w, int dst_h, int flags,
+                 uint8_t *src[4], int src_linesize[4],
+                 uint8_t *dst[4], int dst_linesize[4],
+                 int iterations, int64_t *time)
+{
+    struct SwsContext *sws;
+    int64_t start;
+    int i;
+
+    sws = sws_getContext(src_w, src_h, src_fmt, dst_w, dst_h, dst_fmt,
+                         flags, NULL, NULL, NULL);
+    if (!sws)
+        return AVERROR(EINVAL);
+
+    start = av_gettime_relative();
+    for (i = 0; i < iterations; i++)
+        sws_scale(sws, (const uint8_t * const *)src, src_linesize, 0, src_h,
+                  dst, dst_linesize);
+    *time = av_gettime_relative() - start;
+
+    sws_freeContext(sws);
+    return 0;
+}
+
+int main(int argc, char **argv)
+{
+    int src_w = SRC_W, src_h = SRC_H, dst_w = DST_W, dst_h = DST_H;
+    int iterations = 1, bench = 0;
+    int i, t, res = 0;
+    AVLFG lfg;
+
+    for (i = 1; i < argc; i += 2) {
+        if (i + 1 >= argc) {
+            fprintf(stderr, "%s", usage);
+            return 1;
+        }
+        if (!strcmp(argv[i], "-bench")) {
+            iterations = atoi(argv[i + 1]);
+            bench = 1;
+            if (iterations <= 0) {
+                fprintf(stderr, "invalid iteration count %s\n", argv[i + 1]);
+                return 1;
+            }
+        } else if (!strcmp(argv[i], "-size")) {
+            if (av_parse_video_size(&dst_w, &dst_h, argv[i + 1]) < 0) {
+                fprintf(stderr, "invalid image size %s\n", argv[i + 1]);
+                return 1;
+            }
+            src_w = dst_w * 3 / 2;
+            src_h = dst_h * 3 / 2;
+        } else {
+            fprintf(stderr, "%s", usage);
+            return 1;
+        }
+    }
+
+    av_lfg_init(&lfg, 1);
+
+    for (t = 0; t < FF_ARRAY_ELEMS(tests); t++) {
+        const AVPixFmtDescriptor *src_desc = av_pix_fmt_desc_get(tests[t].src);
+        const AVPixFmtDescriptor *dst_desc = av_pix_fmt_desc_get(tests[t].dst);
+        int dst_be = !!(dst_desc->flags & AV_PIX_FMT_FLAG_BE);
+        uint8_t *src[4] = { NULL }, *dst_float[4] = { NULL }, *dst_int[4] = { NULL };
+        int src_linesize[4], dst_linesize[4];
+        int64_t time_float, time_int;
+        float min = INFINITY, max = -INFINITY;
+        double diff = 0;
+        int count = 0, p, x, y;
+
+        if (av_image_alloc(src, src_linesize, src_w, src_h, tests[t].src, 32) < 0 ||
+            av_image_alloc(dst_float, dst_linesize, dst_w, dst_h, tests[t].dst, 32) < 0 ||
+            av_image_alloc(dst_int, dst_linesize, dst_w, dst_h, tests[t].dst, 32) < 0) {
+            res = 1;
+            goto end;
+        }
+
+        fill_image(src, src_linesize, src_w, src_h, tests[t].src, 1, &lfg);
+        if (scale(tests[t].src, tests[t].dst, src_w, src_h, dst_w, dst_h,
+                  SWS_BICUBIC, src, src_linesize, dst_float, dst_linesize,
+                  1, &time_float) < 0)
+            goto fail;
+        for (p = 0; p < dst_desc->nb_components; p++) {
+            for (y = 0; y < dst_h; y++) {
+                const uint8_t *line = dst_float[p] + y * dst_linesize[p];
+                for (x = 0; x < dst_w; x++) {
+                    float v = read_sample(line, x, dst_be);
+                    min = FFMIN(min, v);
+                    max = FFMAX(max, v);
+                }
+            }
+        }
+
+        // the integer path clips to [0,1], compare both on SDR input
+        fill_image(src, src_linesize, src_w, src_h, tests[t].src, 0, &lfg);
+        if (scale(tests[t].src, tests[t].dst, src_w, src_h, dst_w, dst_h,
+                  SWS_BICUBIC, src, src_linesize, dst_float, dst_linesize,
+                  iterations, &time_float) < 0 ||
+            scale(tests[t].src, tests[t].dst, src_w, src_h, dst_w, dst_h,
+                  SWS_BICUBIC | SWS_BITEXACT | SWS_ACCURATE_RND,
+                  src, src_linesize, dst_int, dst_linesize,
+                  iterations, &time_int) < 0)
+            goto fail;
+
+        for (p = 0; p < dst_desc->nb_components; p++) {
+            for (y = 0; y < dst_h; y++) {
+                const uint8_t *lf = dst_float[p] + y * dst_linesize[p];
+                const uint8_t *li = dst_int[p]   + y * dst_linesize[p];
+                for (x = 0; x < dst_w; x++) {
+                    float vf = read_sample(lf, x, dst_be);
+                    float vi = read_sample(li, x, dst_be);
+                    // bicubic overshoots are clipped by the integer path
+                    if (vf > 0.0f && vf < 1.0f) {
+                        diff = FFMAX(diff, fabs(vf - vi));
+                        count++;
+                    }
+                }
+            }
+        }
+
+        printf("%s -> %s: range %s, %s\n", src_desc->name, dst_desc->name,
+               min < 0.0f && max > 1.0f ? "extended" : "sdr",
+               count && diff < MAX_DIFF ? "matches the integer path" : "MISMATCH");
+        if (!count || diff >= MAX_DIFF ||
+            ((src_desc->flags & AV_PIX_FMT_FLAG_FLOAT) && !(min < 0.0f && max > 1.0f)))
+            res = 1;
+        if (bench)
+            printf("    float path %"PRId64" us, integer path %"PRId64" us (%d iterations)\n",
+                   time_float, time_int, iterations);
+        goto end;
+
+fail:
+        fprintf(stderr, "failed to create the scaler for %s -> %s\n",
+                src_desc->name, dst_desc->name);
+        res = 1;
+end:
+        av_freep(&src[0]);
+        av_freep(&dst_float[0]);
+        av_freep(&dst_int[0]);
+        if (res)
+            break;
+    }
+
+    return res;
+}
@@ -213,7 +213,7 @@ bad_option:
 
         // srcFormat -> dstFormat
         sws = sws_getContext(w, h, inFormat, w, h,
-                            dstFormat, SWS_BILINEAR, NULL, NULL, NULL);
+                            dstFormat, SWS_BILINEAR | SWS_BITEXACT, NULL, NULL, NULL);
         if (!sws) {
             fprintf(stderr, "Failed to get %s -> %s\n", av_get_pix_fmt_name(inFormat), av_get_pix_fmt_name(dstFormat) );
             goto end;
@@ -229,7 +229,7 @@ bad_option:
 
         // dstFormat -> srcFormat
         sws = sws_getContext(w, h, dstFormat, w, h,
-                            inFormat, SWS_BILINEAR, NULL, NULL, NULL);
+                            inFormat, SWS_BILINEAR | SWS_BITEXACT, NULL, NULL, NULL);
         if(!sws) {
             fprintf(stderr, "Failed to get %s -> %s\n", av_get_pix_fmt_name(dstFormat), av_get_pix_fmt_name(inFormat) );
             goto end;
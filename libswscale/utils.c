@@ -773,6 +773,178 @@ done:
     return ret;
 }
 
+/* Number of filters kept in the cache while no context uses them. */
+#define FILTER_CACHE_SIZE 32
+
+typedef struct FilterCacheKey {
+    int xInc, srcW, dstW, filterAlign, one, flags, cpu_flags;
+    int srcPos, dstPos;
+    int srcBpc, dstBpc; ///< only set for shuffled horizontal filters
+    double param[2];
+} FilterCacheKey;
+
+typedef struct FilterCacheEntry {
+    FilterCacheKey key;
+    int16_t *filter;
+    int32_t *filterPos;
+    int filterSize;
+} FilterCacheEntry;
+
+static AVMutex filter_cache_mutex = AV_MUTEX_INITIALIZER;
+static AVBufferRef *filter_cache[FILTER_CACHE_SIZE];
+
+static void free_filter_cache_entry(void *opaque, uint8_t *data)
+{
+    FilterCacheEntry *entry = (FilterCacheEntry *)data;
+
+    av_free(entry->filter);
+    av_free(entry->filterPos);
+    av_free(entry);
+}
+
+/* Must be called with filter_cache_mutex held. */
+static AVBufferRef *filter_cache_find(const FilterCacheKey *key)
+{
+    for (int i = 0; i < FILTER_CACHE_SIZE; i++) {
+        const FilterCacheEntry *entry;
+
+        if (!filter_cache[i])
+            continue;
+        entry = (const FilterCacheEntry *)filter_cache[i]->data;
+        if (!memcmp(&entry->key, key, sizeof(*key)))
+            return filter_cache[i];
+    }
+    return NULL;
+}
+
+/* Must be called with filter_cache_mutex held. */
+static void filter_cache_insert(AVBufferRef *buf)
+{
+    int slot = -1;
+
+    for (int i = 0; i < FILTER_CACHE_SIZE; i++) {
+        if (!filter_cache[i]) {
+            slot = i;
+            break;
+        }
+        /* New references are only taken under the lock, so an entry only
+         * referenced by the cache stays unused. */
+        if (slot < 0 && av_buffer_get_ref_count(filter_cache[i]) == 1)
+            slot = i;
+    }
+    if (slot < 0)
+        return;
+
+    av_buffer_unref(&filter_cache[slot]);
+    filter_cache[slot] = av_buffer_ref(buf);
+}
+
+/**
+ * Same as initFilter(), followed by ff_shuffle_filter_coefficients() if
+ * shuffle is set, but shares the resulting arrays with the other contexts
+ * built with the same parameters. If *ref is set on return, the arrays
+ * belong to it and must not be modified.
+ */
+static av_cold int init_cached_filter(SwsContext *c, AVBufferRef **ref,
+                                      int16_t **outFilter, int32_t **filterPos,
+                                      int *outFilterSize, int xInc, int srcW,
+                                      int dstW, int filterAlign, int one,
+                                      int flags, int cpu_flags,
+                                      SwsVector *srcFilter, SwsVector *dstFilter,
+                                      double param[2], int srcPos, int dstPos,
+                                      int shuffle)
+{
+    FilterCacheKey key;
+    FilterCacheEntry *entry;
+    AVBufferRef *buf;
+    int ret;
+
+    /* user supplied filters are not part of the key */
+    if (srcFilter || dstFilter) {
+        ret = initFilter(outFilter, filterPos, outFilterSize, xInc, srcW, dstW,
+                         filterAlign, one, flags, cpu_flags, srcFilter,
+                         dstFilter, param, srcPos, dstPos);
+        if (ret >= 0 && shuffle)
+            ff_shuffle_filter_coefficients(c, *filterPos, *outFilterSize,
+                                           *outFilter, dstW);
+        return ret;
+    }
+
+    memset(&key, 0, sizeof(key));
+    key.xInc        = xInc;
+    key.srcW        = srcW;
+    key.dstW        = dstW;
+    key.filterAlign = filterAlign;
+    key.one         = one;
+    key.flags       = flags;
+    key.cpu_flags   = cpu_flags;
+    key.srcPos      = srcPos;
+    key.dstPos      = dstPos;
+    key.param[0]    = param[0];
+    key.param[1]    = param[1];
+    if (shuffle) {
+        key.srcBpc = c->srcBpc;
+        key.dstBpc = c->dstBpc;
+    }
+
+    ff_mutex_lock(&filter_cache_mutex);
+    buf = filter_cache_find(&key);
+    if (buf)
+        *ref = av_buffer_ref(buf);
+    ff_mutex_unlock(&filter_cache_mutex);
+
+    if (!*ref) {
+        ret = initFilter(outFilter, filterPos, outFilterSize, xInc, srcW, dstW,
+                         filterAlign, one, flags, cpu_flags, srcFilter,
+                         dstFilter, param, srcPos, dstPos);
+        if (ret < 0)
+            return ret;
+        if (shuffle)
+            ff_shuffle_filter_coefficients(c, *filterPos, *outFilterSize,
+                                           *outFilter, dstW);
+
+        /* on allocation failure, the context simply keeps its own copy */
+        entry = av_mallocz(sizeof(*entry));
+        if (!entry)
+            return 0;
+        *ref = av_buffer_create((uint8_t *)entry, sizeof(*entry),
+                                free_filter_cache_entry, NULL, 0);
+        if (!*ref) {
+            av_free(entry);
+            return 0;
+        }
+        entry->key        = key;
+        entry->filter     = *outFilter;
+        entry->filterPos  = *filterPos;
+        entry->filterSize = *outFilterSize;
+
+        ff_mutex_lock(&filter_cache_mutex);
+        /* another context may have built the same filter meanwhile */
+        buf = filter_cache_find(&key);
+        if (buf && (buf = av_buffer_ref(buf)))
+            av_buffer_unref(ref);
+        else
+            filter_cache_insert(buf = *ref);
+        ff_mutex_unlock(&filter_cache_mutex);
+        *ref = buf;
+    }
+
+    entry          = (FilterCacheEntry *)(*ref)->data;
+    *outFilter     = entry->filter;
+    *filterPos     = entry->filterPos;
+    *outFilterSize = entry->filterSize;
+    return 0;
+}
+
+static void unref_filter(AVBufferRef **ref, int16_t **filter, int32_t **filterPos)
+{
+    if (*ref) {
+        *filter    = NULL;
+        *filterPos = NULL;
+        av_buffer_unref(ref);
+    }
+}
+
 static void fill_rgb2yuv_table(SwsContext *c, const int table[4], int dstRange)
 {
     int64_t W, V, Z, Cy, Cu, Cv;
@@ -1572,6 +1744,16 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     if (c->dstBpc == 16)
         dst_stride <<= 1;
 
+    /* Scale to float output on float intermediates, to keep the range and
+     * precision of float and high bit depth input. The float rounding
+     * depends on the platform, so bitexact output keeps the integer path.
+     * Gray range conversion is left to the integer path as well. */
+    c->float_path = isFloat(dstFormat) && desc_src->comp[0].depth > 8 &&
+                    (isPlanarRGB(srcFormat) || (isGray(srcFormat) && !isALPHA(srcFormat))) &&
+                    isGray(srcFormat) == isGray(dstFormat) &&
+                    (!isGray(srcFormat) || c->srcRange == c->dstRange) &&
+                    !(flags & SWS_BITEXACT);
+
     if (INLINE_MMXEXT(cpu_flags) && c->srcBpc == 8 && c->dstBpc <= 14) {
         c->canMMXEXTBeUsed = dstW >= srcW && (dstW & 31) == 0 &&
                              c->chrDstW >= c->chrSrcW &&
@@ -1615,7 +1797,8 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
     tmpFmt = AV_PIX_FMT_RGBA64LE;
 
 
-    if (!unscaled && c->gamma_flag && (srcFormat != tmpFmt || dstFormat != tmpFmt)) {
+    if (!unscaled && c->gamma_flag && !c->float_path &&
+        (srcFormat != tmpFmt || dstFormat != tmpFmt)) {
         SwsContext *c2;
         c->cascaded_context[0] = NULL;
 
@@ -1710,6 +1893,9 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
         c->srcBpc = 16;
     }
 
+    if (c->float_path)
+        c->srcBpc = c->dstBpc = 32;
+
     if (CONFIG_SWSCALE_ALPHA && isALPHA(srcFormat) && !isALPHA(dstFormat)) {
         enum AVPixelFormat tmpFormat = alphaless_fmt(srcFormat);
 
@@ -1827,26 +2013,26 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
                                     PPC_ALTIVEC(cpu_flags) ? 8 :
                                     have_neon(cpu_flags)   ? 8 : 1;
 
-            if ((ret = initFilter(&c->hLumFilter, &c->hLumFilterPos,
+            if ((ret = init_cached_filter(c, &c->hLumFilterRef,
+                           &c->hLumFilter, &c->hLumFilterPos,
                            &c->hLumFilterSize, c->lumXInc,
                            srcW, dstW, filterAlign, 1 << 14,
                            (flags & SWS_BICUBLIN) ? (flags | SWS_BICUBIC) : flags,
                            cpu_flags, srcFilter->lumH, dstFilter->lumH,
                            c->param,
                            get_local_pos(c, 0, 0, 0),
-                           get_local_pos(c, 0, 0, 0))) < 0)
+                           get_local_pos(c, 0, 0, 0), 1)) < 0)
                 goto fail;
-            ff_shuffle_filter_coefficients(c, c->hLumFilterPos, c->hLumFilterSize, c->hLumFilter, dstW);
-            if ((ret = initFilter(&c->hChrFilter, &c->hChrFilterPos,
+            if ((ret = init_cached_filter(c, &c->hChrFilterRef,
+                           &c->hChrFilter, &c->hChrFilterPos,
                            &c->hChrFilterSize, c->chrXInc,
                            c->chrSrcW, c->chrDstW, filterAlign, 1 << 14,
                            (flags & SWS_BICUBLIN) ? (flags | SWS_BILINEAR) : flags,
                            cpu_flags, srcFilter->chrH, dstFilter->chrH,
                            c->param,
                            get_local_pos(c, c->chrSrcHSubSample, c->src_h_chr_pos, 0),
-                           get_local_pos(c, c->chrDstHSubSample, c->dst_h_chr_pos, 0))) < 0)
+                           get_local_pos(c, c->chrDstHSubSample, c->dst_h_chr_pos, 0), 1)) < 0)
                 goto fail;
-            ff_shuffle_filter_coefficients(c, c->hChrFilterPos, c->hChrFilterSize, c->hChrFilter, c->chrDstW);
         }
     } // initialize horizontal stuff
 
@@ -1856,22 +2042,24 @@ av_cold int sws_init_context(SwsContext *c, SwsFilter *srcFilter,
                                 PPC_ALTIVEC(cpu_flags) ? 8 :
                                 have_neon(cpu_flags)   ? 2 : 1;
 
-        if ((ret = initFilter(&c->vLumFilter, &c->vLumFilterPos, &c->vLumFilterSize,
+        if ((ret = init_cached_filter(c, &c->vLumFilterRef,
+                       &c->vLumFilter, &c->vLumFilterPos, &c->vLumFilterSize,
                        c->lumYInc, srcH, dstH, filterAlign, (1 << 12),
                        (flags & SWS_BICUBLIN) ? (flags | SWS_BICUBIC) : flags,
                        cpu_flags, srcFilter->lumV, dstFilter->lumV,
                        c->param,
                        get_local_pos(c, 0, 0, 1),
-                       get_local_pos(c, 0, 0, 1))) < 0)
+                       get_local_pos(c, 0, 0, 1), 0)) < 0)
             goto fail;
-        if ((ret = initFilter(&c->vChrFilter, &c->vChrFilterPos, &c->vChrFilterSize,
+        if ((ret = init_cached_filter(c, &c->vChrFilterRef,
+                       &c->vChrFilter, &c->vChrFilterPos, &c->vChrFilterSize,
                        c->chrYInc, c->chrSrcH, c->chrDstH,
                        filterAlign, (1 << 12),
                        (flags & SWS_BICUBLIN) ? (flags | SWS_BILINEAR) : flags,
                        cpu_flags, srcFilter->chrV, dstFilter->chrV,
                        c->param,
                        get_local_pos(c, c->chrSrcVSubSample, c->src_v_chr_pos, 1),
-                       get_local_pos(c, c->chrDstVSubSample, c->dst_v_chr_pos, 1))) < 0)
+                       get_local_pos(c, c->chrDstVSubSample, c->dst_v_chr_pos, 1), 0)) < 0)
 
             goto fail;
 
@@ -2401,6 +2589,11 @@ void sws_freeContext(SwsContext *c)
 
     av_freep(&c->src_ranges.ranges);
 
+    unref_filter(&c->vLumFilterRef, &c->vLumFilter, &c->vLumFilterPos);
+    unref_filter(&c->vChrFilterRef, &c->vChrFilter, &c->vChrFilterPos);
+    unref_filter(&c->hLumFilterRef, &c->hLumFilter, &c->hLumFilterPos);
+    unref_filter(&c->hChrFilterRef, &c->hChrFilter, &c->hChrFilterPos);
+
     av_freep(&c->vLumFilter);
     av_freep(&c->vChrFilter);
     av_freep(&c->hLumFilter);
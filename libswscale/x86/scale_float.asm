@@ -0,0 +1,185 @@
+;******************************************************************************
+;* x86-optimized scaling functions for the float intermediates
+;*
+;* This file is part of FFmpeg.
+;*
+;* FFmpeg is free software; you can redistribute it and/or
+;* modify it under the terms of the GNU Lesser General Public
+;* License as published by the Free Software Foundation; either
+;* version 2.1 of the License, or (at your option) any later version.
+;*
+;* FFmpeg is distributed in the hope that it will be useful,
+;* but WITHOUT ANY WARRANTY; without even the implied warranty of
+;* MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU
+;* Lesser General Public License for more details.
+;*
+;* You should have received a copy of the GNU Lesser General Public
+;* License along with FFmpeg; if not, write to the Free Software
+;* Foundation, Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA
+;******************************************************************************
+
+%include "libavutil/x86/x86util.asm"
+
+SECTION_RODATA
+
+hscale_scale: dd 0x38800000 ; 1.0f / (1 << 14)
+vscale_scale: dd 0x39800000 ; 1.0f / (1 << 12)
+
+SECTION .text
+
+;-----------------------------------------------------------------------------
+; void hscale_float_<opt>(SwsContext *c, int16_t *dst, int dstW,
+;                         const uint8_t *src, const int16_t *filter,
+;                         const int32_t *filterPos, int filterSize);
+;
+; Scale one line of floats, see SwsContext.float_path. Four output pixels are
+; computed at a time, so filterSize must be a multiple of 4, and up to 3
+; pixels are written past dstW, which the filterPos/filter padding allows.
+;-----------------------------------------------------------------------------
+
+; m<acc> += src[j..] * filter[j..], 8 taps in ymm or 4 taps in xmm
+%macro HSCALE_TAPS 4 ; tmp, src, filter, acc
+    pmovsxwd        %1, [%3 + jq * 2]
+    cvtdq2ps        %1, %1
+    mulps           %1, %1, [%2 + jq * 4]
+    addps           m%4, m%4, m4
+%endmacro
+
+%macro HSCALE_FLOAT_FN 0
+cglobal hscale_float, 7, 14, 6, j, dst, w, src, filter, fltpos, fltsize, \
+                                src0, src1, src2, src3, filter1, filter2, filter3
+    movsxd          fltsizeq, fltsized
+    vbroadcastss    m5, [hscale_scale]
+.loop:
+    movsxd          src0q, dword [fltposq]
+    movsxd          src1q, dword [fltposq + 4]
+    movsxd          src2q, dword [fltposq + 8]
+    movsxd          src3q, dword [fltposq + 12]
+    lea             src0q, [srcq + src0q * 4]
+    lea             src1q, [srcq + src1q * 4]
+    lea             src2q, [srcq + src2q * 4]
+    lea             src3q, [srcq + src3q * 4]
+    ; point at the end of the source and coefficients of each pixel
+    lea             src0q, [src0q + fltsizeq * 4]
+    lea             src1q, [src1q + fltsizeq * 4]
+    lea             src2q, [src2q + fltsizeq * 4]
+    lea             src3q, [src3q + fltsizeq * 4]
+    lea             filterq,  [filterq  + fltsizeq * 2]
+    lea             filter1q, [filterq  + fltsizeq * 2]
+    lea             filter2q, [filter1q + fltsizeq * 2]
+    lea             filter3q, [filter2q + fltsizeq * 2]
+    mov             jq, fltsizeq
+    neg             jq
+    xorps           m0, m0
+    xorps           m1, m1
+    xorps           m2, m2
+    xorps           m3, m3
+    cmp             jq, -8
+    jg .taps4
+.taps8:
+    HSCALE_TAPS     m4, src0q, filterq,  0
+    HSCALE_TAPS     m4, src1q, filter1q, 1
+    HSCALE_TAPS     m4, src2q, filter2q, 2
+    HSCALE_TAPS     m4, src3q, filter3q, 3
+    add             jq, 8
+    cmp             jq, -8
+    jle .taps8
+.taps4:
+    test            jq, jq
+    jz .sum
+    ; the xmm operations clear the upper half of m4
+    HSCALE_TAPS     xm4, src0q, filterq,  0
+    HSCALE_TAPS     xm4, src1q, filter1q, 1
+    HSCALE_TAPS     xm4, src2q, filter2q, 2
+    HSCALE_TAPS     xm4, src3q, filter3q, 3
+.sum:
+    haddps          m0, m0, m1
+    haddps          m2, m2, m3
+    haddps          m0, m0, m2
+    vextractf128    xm1, m0, 1
+    addps           xm0, xm0, xm1
+    mulps           xm0, xm0, xm5
+    movu            [dstq], xm0
+    mov             filterq, filter3q
+    add             fltposq, 16
+    add             dstq, 16
+    sub             wd, 4
+    jg .loop
+    RET
+%endmacro
+
+;-----------------------------------------------------------------------------
+; void yuv2planeX_float_<opt>(const int16_t *filter, int filterSize,
+;                             const int16_t **src, uint8_t *dest, int dstW,
+;                             const uint8_t *dither, int offset);
+;
+; Vertically scale lines of floats, see SwsContext.float_path. The taps are
+; summed in the same order as the C version, so the output is identical.
+;-----------------------------------------------------------------------------
+
+%macro YUV2PLANEX_FLOAT_FN 0
+cglobal yuv2planeX_float, 5, 9, 5, filter, fltsize, src, dst, w, i, j, line, coef
+    movsxd          fltsizeq, fltsized
+    movsxd          wq, wd
+    ; index the coefficients and lines from their end
+    lea             filterq, [filterq + fltsizeq * 2]
+    lea             srcq, [srcq + fltsizeq * gprsize]
+    neg             fltsizeq
+    vbroadcastss    m4, [vscale_scale]
+    xor             iq, iq
+    sub             wq, 16
+    jl .tail
+.loop:
+    xorps           m0, m0
+    xorps           m1, m1
+    mov             jq, fltsizeq
+.taps:
+    movsx           coefd, word [filterq + jq * 2]
+    cvtsi2ss        xm2, xm2, coefd
+    vbroadcastss    m2, xm2
+    mov             lineq, [srcq + jq * gprsize]
+    mulps           m3, m2, [lineq + iq * 4]
+    mulps           m2, m2, [lineq + iq * 4 + 32]
+    addps           m0, m0, m3
+    addps           m1, m1, m2
+    inc             jq
+    jl .taps
+    mulps           m0, m0, m4
+    mulps           m1, m1, m4
+    movu            [dstq + iq * 4], m0
+    movu            [dstq + iq * 4 + 32], m1
+    add             iq, 16
+    cmp             iq, wq
+    jle .loop
+.tail:
+    add             wq, 16
+    cmp             iq, wq
+    jge .end
+.pixel:
+    xorps           xm0, xm0
+    mov             jq, fltsizeq
+.tap:
+    movsx           coefd, word [filterq + jq * 2]
+    cvtsi2ss        xm2, xm2, coefd
+    mov             lineq, [srcq + jq * gprsize]
+    mulss           xm2, xm2, [lineq + iq * 4]
+    addss           xm0, xm0, xm2
+    inc             jq
+    jl .tap
+    mulss           xm0, xm0, xm4
+    movss           [dstq + iq * 4], xm0
+    inc             iq
+    cmp             iq, wq
+    jl .pixel
+.end:
+    RET
+%endmacro
+
+; Both need more general purpose registers than x86-32 has.
+%if ARCH_X86_64
+%if HAVE_AVX2_EXTERNAL
+INIT_YMM avx2
+HSCALE_FLOAT_FN
+YUV2PLANEX_FLOAT_FN
+%endif
+%endif
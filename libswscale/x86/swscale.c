@@ -466,10 +466,31 @@ INPUT_PLANAR_RGB_UV_ALL_DECL(avx2);
 INPUT_PLANAR_RGB_A_ALL_DECL(avx2);
 #endif
 
+/* Scalers for the float intermediates, see SwsContext.float_path. */
+void ff_hscale_float_avx2(SwsContext *c, int16_t *dst, int dstW,
+                          const uint8_t *src, const int16_t *filter,
+                          const int32_t *filterPos, int filterSize);
+void ff_yuv2planeX_float_avx2(const int16_t *filter, int filterSize,
+                              const int16_t **src, uint8_t *dest, int dstW,
+                              const uint8_t *dither, int offset);
+
 av_cold void ff_sws_init_swscale_x86(SwsContext *c)
 {
     int cpu_flags = av_get_cpu_flags();
 
+    if (c->float_path) {
+#if HAVE_AVX2_EXTERNAL && ARCH_X86_64
+        if (EXTERNAL_AVX2_FAST(cpu_flags)) {
+            if ((c->hLumFilterSize % 4) == 0 &&
+                (c->hChrFilterSize % 4) == 0)
+                c->hyScale = c->hcScale = ff_hscale_float_avx2;
+            if (!isBE(c->dstFormat) && !c->gamma_flag)
+                c->yuv2planeX = ff_yuv2planeX_float_avx2;
+        }
+#endif
+        return;
+    }
+
 #if HAVE_MMX_INLINE
     if (INLINE_MMX(cpu_flags))
         sws_init_swscale_mmx(c);
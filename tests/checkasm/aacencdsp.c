@@ -0,0 +1,117 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <math.h>
+#include <string.h>
+
+#include "libavcodec/aacenc.h"
+#include "libavcodec/aacenc_utils.h"
+#include "libavutil/mem.h"
+#include "libavutil/mem_internal.h"
+
+#include "checkasm.h"
+
+#define BUF_SIZE 1024
+
+#define randomize_float(buf, len, scale) do {                   \
+    const float mul = scale;                                    \
+    int n;                                                      \
+    for (n = 0; n < len; n++)                                   \
+        (buf)[n] = ((float)rnd() / UINT_MAX * 2 - 1) * mul;     \
+} while (0)
+
+static void test_abs_pow34(AACEncContext *s)
+{
+    LOCAL_ALIGNED_32(float, in,   [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, out0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(float, out1, [BUF_SIZE]);
+
+    declare_func(void, float *out, const float *in, const int size);
+
+    if (check_func(s->abs_pow34, "abs_pow34")) {
+        randomize_float(in, BUF_SIZE, 32768.0f);
+
+        call_ref(out0, in, BUF_SIZE);
+        call_new(out1, in, BUF_SIZE);
+        if (!float_near_ulp_array(out0, out1, 1, BUF_SIZE))
+            fail();
+        bench_new(out1, in, BUF_SIZE);
+    }
+}
+
+static void test_quantize_bands(AACEncContext *s)
+{
+    /* the band sizes and the largest value of some codebooks */
+    static const int sizes[]   = { 4, 16, 32, 96 };
+    static const int maxvals[] = { 1, 2, 4, 7, 12, 16, 8191 };
+    LOCAL_ALIGNED_16(float, in,     [BUF_SIZE]);
+    LOCAL_ALIGNED_16(float, scaled, [BUF_SIZE]);
+    LOCAL_ALIGNED_16(int,   out0,   [BUF_SIZE]);
+    LOCAL_ALIGNED_16(int,   out1,   [BUF_SIZE]);
+    int i, j, is_signed;
+
+    declare_func(void, int *out, const float *in, const float *scaled,
+                 int size, int is_signed, int maxval, const float Q34,
+                 const float rounding);
+
+    if (check_func(s->quant_bands, "quantize_bands")) {
+        for (i = 0; i < FF_ARRAY_ELEMS(maxvals); i++) {
+            for (j = 0; j < FF_ARRAY_ELEMS(sizes); j++) {
+                for (is_signed = 0; is_signed <= 1; is_signed++) {
+                    const float rounding = (i & 1) ? ROUND_TO_ZERO : ROUND_STANDARD;
+                    const float Q34 = 0.25f + (float)rnd() / UINT_MAX;
+                    int k;
+
+                    /* exceed maxval sometimes to test the clipping */
+                    randomize_float(in, sizes[j], maxvals[i] * 1.5f / Q34);
+                    for (k = 0; k < sizes[j]; k++)
+                        scaled[k] = fabsf(in[k]);
+
+                    call_ref(out0, in, scaled, sizes[j], is_signed, maxvals[i],
+                             Q34, rounding);
+                    call_new(out1, in, scaled, sizes[j], is_signed, maxvals[i],
+                             Q34, rounding);
+                    if (memcmp(out0, out1, sizes[j] * sizeof(*out0))) {
+                        fprintf(stderr, "size %d, maxval %d, is_signed %d\n",
+                                sizes[j], maxvals[i], is_signed);
+                        fail();
+                    }
+                }
+            }
+        }
+        bench_new(out1, in, scaled, 96, 1, 8191, 1.0f, ROUND_STANDARD);
+    }
+}
+
+void checkasm_check_aacencdsp(void)
+{
+    AACEncContext *s = av_mallocz(sizeof(*s));
+
+    if (!s)
+        return;
+
+    ff_aac_dsp_init(s);
+
+    test_abs_pow34(s);
+    report("abs_pow34");
+
+    test_quantize_bands(s);
+    report("quantize_bands");
+
+    av_free(s);
+}
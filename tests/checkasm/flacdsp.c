@@ -54,6 +54,43 @@ static void check_decorrelate(uint8_t **ref_dst, uint8_t **ref_src, uint8_t **ne
     bench_new(new_dst, (int32_t **)new_src, channels, BUF_SIZE / sizeof(int32_t), 8);
 }
 
+#define LPC_LEN 4093
+
+static void check_lpc_encode(void (*func)(int32_t *, const int32_t *, int, int,
+                                          const int32_t *, int),
+                             const char *name)
+{
+    LOCAL_ALIGNED_16(int32_t, smp,     [LPC_LEN + 32]);
+    LOCAL_ALIGNED_16(int32_t, ref_res, [LPC_LEN + 32]);
+    LOCAL_ALIGNED_16(int32_t, new_res, [LPC_LEN + 32]);
+    int32_t coefs[32];
+    int i, order;
+
+    declare_func(void, int32_t *res, const int32_t *smp, int len, int order,
+                 const int32_t coefs[32], int shift);
+
+    if (!check_func(func, "%s", name))
+        return;
+
+    for (i = 0; i < LPC_LEN + 32; i++)
+        smp[i] = (int)(rnd() & 0x1fff) - 0x1000;
+
+    for (order = 1; order <= 32; order++) {
+        int shift = rnd() % 16;
+
+        for (i = 0; i < 32; i++)
+            coefs[i] = (int)(rnd() & 0xfff) - 0x800;
+        memset(ref_res, 0, (LPC_LEN + 32) * sizeof(*ref_res));
+        memset(new_res, 0, (LPC_LEN + 32) * sizeof(*new_res));
+
+        call_ref(ref_res, smp, LPC_LEN, order, coefs, shift);
+        call_new(new_res, smp, LPC_LEN, order, coefs, shift);
+        if (memcmp(ref_res, new_res, LPC_LEN * sizeof(*ref_res)))
+            fail();
+    }
+    bench_new(new_res, smp, LPC_LEN, 32, coefs, 12);
+}
+
 void checkasm_check_flacdsp(void)
 {
     LOCAL_ALIGNED_16(uint8_t, ref_dst, [BUF_SIZE*MAX_CHANNELS]);
@@ -88,4 +125,11 @@ void checkasm_check_flacdsp(void)
     }
 
     report("decorrelate");
+
+    ff_flacdsp_init(&h, AV_SAMPLE_FMT_S16, 2, 16);
+    check_lpc_encode(h.lpc16_encode, "flac_lpc16_encode");
+    ff_flacdsp_init(&h, AV_SAMPLE_FMT_S32, 2, 24);
+    check_lpc_encode(h.lpc32_encode, "flac_lpc32_encode");
+
+    report("lpc_encode");
 }
@@ -0,0 +1,152 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+
+#include "libavutil/common.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem_internal.h"
+
+#include "libavcodec/avcodec.h"
+
+#include "libavcodec/hevcdsp.h"
+
+#include "checkasm.h"
+
+#define SIZEOF_PIXEL ((bit_depth + 7) / 8)
+#define BUF_STRIDE (16 * 2)
+#define BUF_SIZE (BUF_STRIDE * 16)
+/* the edge starts at row 8, column 8 of a 16x16 block */
+#define BUF_OFFSET (BUF_STRIDE * 8 + 8 * SIZEOF_PIXEL)
+#define ITERATIONS 64
+
+static void randomize_params(int *beta, int32_t *tc, uint8_t *no_p, uint8_t *no_q)
+{
+    int i;
+
+    *beta = rnd() % 65;
+    for (i = 0; i < 2; i++) {
+        tc[i]   = rnd() % 25;
+        no_p[i] = (rnd() & 7) == 0;
+        no_q[i] = (rnd() & 7) == 0;
+    }
+}
+
+/* Fill the block with a flat area plus some noise on both sides of the
+ * edge and a step across it, so that all the filter decisions (no filter,
+ * normal and strong filtering) are taken for some of the segments. The
+ * filters scale beta and tc by the bit depth before comparing them with
+ * the pixels, so the noise and the step are sized the same way. */
+static void randomize_buffers(uint8_t *buf0, uint8_t *buf1, int bit_depth,
+                              int vertical, int beta, const int32_t *tc)
+{
+    const int max    = (1 << bit_depth) - 1;
+    const int shift  = bit_depth - 8;
+    const int beta_s = beta << shift;
+    const int tc_s   = FFMAX(tc[0], tc[1]) << shift;
+    const int base   = rnd() & max;
+    const int noise  = rnd() % (beta_s / 16 + 2);
+    const int step   = ((int)(rnd() % 65) - 32) * (tc_s + (1 << shift));
+    int x, y;
+
+    for (y = 0; y < 16; y++) {
+        for (x = 0; x < 16; x++) {
+            int v = base + (int)(rnd() % (2 * noise + 1)) - noise;
+            if ((vertical ? x : y) >= 8)
+                v += step;
+            v = av_clip(v, 0, max);
+            if (bit_depth == 8) {
+                buf0[y * BUF_STRIDE + x] = v;
+            } else {
+                AV_WN16A(buf0 + y * BUF_STRIDE + 2 * x, v);
+            }
+        }
+    }
+    memcpy(buf1, buf0, BUF_SIZE);
+}
+
+static void check_deblock_luma(HEVCDSPContext *h, int bit_depth, int vertical)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, buf1, [BUF_SIZE]);
+    int32_t tc[2];
+    uint8_t no_p[2], no_q[2];
+    int beta, i;
+    declare_func(void, uint8_t *pix, ptrdiff_t stride, int beta, int32_t *tc,
+                 uint8_t *no_p, uint8_t *no_q);
+
+    if (check_func(vertical ? h->hevc_v_loop_filter_luma : h->hevc_h_loop_filter_luma,
+                   "hevc_%c_loop_filter_luma_%d", vertical ? 'v' : 'h', bit_depth)) {
+        for (i = 0; i < ITERATIONS; i++) {
+            randomize_params(&beta, tc, no_p, no_q);
+            randomize_buffers(buf0, buf1, bit_depth, vertical, beta, tc);
+            call_ref(buf0 + BUF_OFFSET, BUF_STRIDE, beta, tc, no_p, no_q);
+            call_new(buf1 + BUF_OFFSET, BUF_STRIDE, beta, tc, no_p, no_q);
+            if (memcmp(buf0, buf1, BUF_SIZE))
+                fail();
+        }
+        bench_new(buf1 + BUF_OFFSET, BUF_STRIDE, beta, tc, no_p, no_q);
+    }
+}
+
+static void check_deblock_chroma(HEVCDSPContext *h, int bit_depth, int vertical)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf0, [BUF_SIZE]);
+    LOCAL_ALIGNED_32(uint8_t, buf1, [BUF_SIZE]);
+    int32_t tc[2];
+    uint8_t no_p[2], no_q[2];
+    int beta, i;
+    declare_func(void, uint8_t *pix, ptrdiff_t stride, int32_t *tc,
+                 uint8_t *no_p, uint8_t *no_q);
+
+    if (check_func(vertical ? h->hevc_v_loop_filter_chroma : h->hevc_h_loop_filter_chroma,
+                   "hevc_%c_loop_filter_chroma_%d", vertical ? 'v' : 'h', bit_depth)) {
+        for (i = 0; i < ITERATIONS; i++) {
+            randomize_params(&beta, tc, no_p, no_q);
+            randomize_buffers(buf0, buf1, bit_depth, vertical, beta, tc);
+            call_ref(buf0 + BUF_OFFSET, BUF_STRIDE, tc, no_p, no_q);
+            call_new(buf1 + BUF_OFFSET, BUF_STRIDE, tc, no_p, no_q);
+            if (memcmp(buf0, buf1, BUF_SIZE))
+                fail();
+        }
+        bench_new(buf1 + BUF_OFFSET, BUF_STRIDE, tc, no_p, no_q);
+    }
+}
+
+void checkasm_check_hevc_deblock(void)
+{
+    int bit_depth;
+
+    for (bit_depth = 8; bit_depth <= 12; bit_depth += 2) {
+        HEVCDSPContext h;
+
+        ff_hevc_dsp_init(&h, bit_depth);
+        check_deblock_luma(&h, bit_depth, 0);
+        check_deblock_luma(&h, bit_depth, 1);
+    }
+    report("loop_filter_luma");
+
+    for (bit_depth = 8; bit_depth <= 12; bit_depth += 2) {
+        HEVCDSPContext h;
+
+        ff_hevc_dsp_init(&h, bit_depth);
+        check_deblock_chroma(&h, bit_depth, 0);
+        check_deblock_chroma(&h, bit_depth, 1);
+    }
+    report("loop_filter_chroma");
+}
@@ -0,0 +1,83 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <float.h>
+
+#include "libavcodec/lpc.h"
+#include "libavutil/mem_internal.h"
+
+#include "checkasm.h"
+
+#define BLOCKSIZE 4608
+
+static void test_compute_autocorr(LPCContext *ctx, int lag)
+{
+    LOCAL_ALIGNED_32(double, autoc_ref, [MAX_LPC_ORDER + 1]);
+    LOCAL_ALIGNED_32(double, autoc_new, [MAX_LPC_ORDER + 1]);
+    /* laid out by ff_lpc_init(): zeros before the samples and room for
+     * two zeros after the last one */
+    double *data = ctx->windowed_samples;
+    int len, i, k;
+
+    declare_func(void, const double *data, int len, int lag, double *autoc);
+
+    if (!check_func(ctx->lpc_compute_autocorr, "lpc_compute_autocorr_%d", lag))
+        return;
+
+    for (len = BLOCKSIZE - 7; len <= BLOCKSIZE; len++) {
+        double tolerance;
+
+        for (i = 0; i < len; i++)
+            data[i] = (int)rnd() / 65536.0;
+        data[len] = data[len + 1] = 0.0;
+
+        call_ref(data, len, lag, autoc_ref);
+        call_new(data, len, lag, autoc_new);
+
+        /* The SIMD versions may sum in another order. autoc[0] is the
+         * signal energy plus 1.0 and bounds the sum of the absolute
+         * values of the products of every lag. */
+        tolerance = autoc_ref[0] * len * DBL_EPSILON;
+        for (k = 0; k <= lag; k++) {
+            if (!double_near_abs_eps(autoc_ref[k], autoc_new[k], tolerance)) {
+                fprintf(stderr, "len %d lag %d: %.17g - %.17g = %g\n",
+                        len, k, autoc_ref[k], autoc_new[k],
+                        autoc_ref[k] - autoc_new[k]);
+                fail();
+                break;
+            }
+        }
+    }
+    bench_new(data, BLOCKSIZE, lag, autoc_new);
+}
+
+void checkasm_check_lpc(void)
+{
+    static const int lags[] = { 1, 2, 7, 8, 12, 16, 21, 31, 32 };
+    LPCContext ctx;
+    int i;
+
+    if (ff_lpc_init(&ctx, BLOCKSIZE, MAX_LPC_ORDER, FF_LPC_TYPE_LEVINSON) < 0)
+        return;
+
+    for (i = 0; i < FF_ARRAY_ELEMS(lags); i++)
+        test_compute_autocorr(&ctx, lags[i]);
+    report("compute_autocorr");
+
+    ff_lpc_end(&ctx);
+}
@@ -22,8 +22,11 @@
 #include "libavutil/common.h"
 #include "libavutil/intreadwrite.h"
 #include "libavutil/mem_internal.h"
+#include "libavutil/pixdesc.h"
 
 #include "libswscale/rgb2rgb.h"
+#include "libswscale/swscale.h"
+#include "libswscale/swscale_internal.h"
 
 #include "checkasm.h"
 
@@ -179,6 +182,111 @@ static void check_interleave_bytes(void)
     }
 }
 
+static const enum AVPixelFormat rgb_formats[] = {
+    AV_PIX_FMT_RGB24,
+    AV_PIX_FMT_BGR24,
+    AV_PIX_FMT_RGBA,
+    AV_PIX_FMT_BGRA,
+    AV_PIX_FMT_ARGB,
+    AV_PIX_FMT_ABGR,
+};
+
+static const int input_sizes[] = {1, 7, 12, 16, 36, 128};
+
+static void check_rgb_to_y(void)
+{
+    struct SwsContext *ctx;
+    LOCAL_ALIGNED_16(uint8_t, src, [MAX_STRIDE * 4]);
+    LOCAL_ALIGNED_16(uint8_t, dst0_y, [MAX_STRIDE * 2]);
+    LOCAL_ALIGNED_16(uint8_t, dst1_y, [MAX_STRIDE * 2]);
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, uint8_t *dst, const uint8_t *src,
+                      const uint8_t *unused1, const uint8_t *unused2, int width,
+                      uint32_t *rgb2yuv);
+
+    randomize_buffers(src, MAX_STRIDE * 4);
+
+    for (int i = 0; i < FF_ARRAY_ELEMS(rgb_formats); i++) {
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(rgb_formats[i]);
+
+        ctx = sws_getContext(MAX_STRIDE, MAX_HEIGHT, rgb_formats[i],
+                             MAX_STRIDE, MAX_HEIGHT, AV_PIX_FMT_YUV420P,
+                             SWS_BILINEAR, NULL, NULL, NULL);
+        if (!ctx)
+            fail();
+
+        if (check_func(ctx->lumToYV12, "%s_to_y", desc->name)) {
+            for (int j = 0; j < FF_ARRAY_ELEMS(input_sizes); j++) {
+                int w = input_sizes[j];
+
+                memset(dst0_y, 0xFF, MAX_STRIDE * 2);
+                memset(dst1_y, 0xFF, MAX_STRIDE * 2);
+
+                call_ref(dst0_y, src, NULL, NULL, w, ctx->input_rgb2yuv_table);
+                call_new(dst1_y, src, NULL, NULL, w, ctx->input_rgb2yuv_table);
+
+                if (memcmp(dst0_y, dst1_y, MAX_STRIDE * 2))
+                    fail();
+            }
+            bench_new(dst1_y, src, NULL, NULL, MAX_STRIDE, ctx->input_rgb2yuv_table);
+        }
+        sws_freeContext(ctx);
+    }
+}
+
+static void check_rgb_to_uv(void)
+{
+    struct SwsContext *ctx;
+    LOCAL_ALIGNED_16(uint8_t, src, [MAX_STRIDE * 2 * 4]);
+    LOCAL_ALIGNED_16(uint8_t, dst0_u, [MAX_STRIDE * 2]);
+    LOCAL_ALIGNED_16(uint8_t, dst0_v, [MAX_STRIDE * 2]);
+    LOCAL_ALIGNED_16(uint8_t, dst1_u, [MAX_STRIDE * 2]);
+    LOCAL_ALIGNED_16(uint8_t, dst1_v, [MAX_STRIDE * 2]);
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, uint8_t *dstU, uint8_t *dstV,
+                      const uint8_t *unused0, const uint8_t *src1,
+                      const uint8_t *src2, int width, uint32_t *rgb2yuv);
+
+    randomize_buffers(src, MAX_STRIDE * 2 * 4);
+
+    for (int i = 0; i < 2 * FF_ARRAY_ELEMS(rgb_formats); i++) {
+        enum AVPixelFormat src_fmt = rgb_formats[i / 2];
+        const AVPixFmtDescriptor *desc = av_pix_fmt_desc_get(src_fmt);
+        int half = i & 1;
+
+        /* a subsampled destination makes swscale read the chroma of pixel
+         * pairs */
+        ctx = sws_getContext(MAX_STRIDE, MAX_HEIGHT, src_fmt,
+                             MAX_STRIDE, MAX_HEIGHT,
+                             half ? AV_PIX_FMT_YUV420P : AV_PIX_FMT_YUV444P,
+                             SWS_BILINEAR, NULL, NULL, NULL);
+        if (!ctx)
+            fail();
+        if (ctx->chrSrcHSubSample != half)
+            fail();
+
+        if (check_func(ctx->chrToYV12, "%s_to_uv%s", desc->name, half ? "_half" : "")) {
+            for (int j = 0; j < FF_ARRAY_ELEMS(input_sizes); j++) {
+                int w = input_sizes[j];
+
+                memset(dst0_u, 0xFF, MAX_STRIDE * 2);
+                memset(dst0_v, 0xFF, MAX_STRIDE * 2);
+                memset(dst1_u, 0xFF, MAX_STRIDE * 2);
+                memset(dst1_v, 0xFF, MAX_STRIDE * 2);
+
+                call_ref(dst0_u, dst0_v, NULL, src, src, w, ctx->input_rgb2yuv_table);
+                call_new(dst1_u, dst1_v, NULL, src, src, w, ctx->input_rgb2yuv_table);
+
+                if (memcmp(dst0_u, dst1_u, MAX_STRIDE * 2) ||
+                    memcmp(dst0_v, dst1_v, MAX_STRIDE * 2))
+                    fail();
+            }
+            bench_new(dst1_u, dst1_v, NULL, src, src, MAX_STRIDE, ctx->input_rgb2yuv_table);
+        }
+        sws_freeContext(ctx);
+    }
+}
+
 void checkasm_check_sw_rgb(void)
 {
     ff_sws_rgb2rgb_init();
@@ -203,4 +311,10 @@ void checkasm_check_sw_rgb(void)
 
     check_interleave_bytes();
     report("interleave_bytes");
+
+    check_rgb_to_y();
+    report("rgb_to_y");
+
+    check_rgb_to_uv();
+    report("rgb_to_uv");
 }
@@ -131,6 +131,80 @@ static void check_yuv2yuvX(void)
     }
     sws_freeContext(ctx);
 #undef FILTER_SIZES
+#undef INPUT_SIZES
+}
+
+static void check_yuv2nv12cX(void)
+{
+    struct SwsContext *ctx;
+    int fsi, isi, dfi, i;
+    int dstW;
+#define FILTER_SIZES 5
+    static const int filter_sizes[FILTER_SIZES] = {1, 2, 4, 7, 16};
+#define INPUT_SIZES 6
+    static const int input_sizes[INPUT_SIZES] = {1, 13, 24, 128, 135, 512};
+    static const enum AVPixelFormat dst_formats[] = {AV_PIX_FMT_NV12, AV_PIX_FMT_NV21};
+
+    declare_func_emms(AV_CPU_FLAG_MMX, void, enum AVPixelFormat dstFormat,
+                      const uint8_t *chrDither, const int16_t *chrFilter,
+                      int chrFilterSize, const int16_t **chrUSrc,
+                      const int16_t **chrVSrc, uint8_t *dest, int dstW);
+
+    const int16_t *u[LARGEST_FILTER], *v[LARGEST_FILTER];
+    LOCAL_ALIGNED_8(int16_t, u_pixels, [LARGEST_FILTER * LARGEST_INPUT_SIZE]);
+    LOCAL_ALIGNED_8(int16_t, v_pixels, [LARGEST_FILTER * LARGEST_INPUT_SIZE]);
+    LOCAL_ALIGNED_8(int16_t, filter_coeff, [LARGEST_FILTER]);
+    LOCAL_ALIGNED_8(uint8_t, dst0, [LARGEST_INPUT_SIZE * 2]);
+    LOCAL_ALIGNED_8(uint8_t, dst1, [LARGEST_INPUT_SIZE * 2]);
+    LOCAL_ALIGNED_8(uint8_t, dither, [8]);
+
+    randomize_buffers(dither, 8);
+    randomize_buffers((uint8_t*)u_pixels, LARGEST_FILTER * LARGEST_INPUT_SIZE * sizeof(int16_t));
+    randomize_buffers((uint8_t*)v_pixels, LARGEST_FILTER * LARGEST_INPUT_SIZE * sizeof(int16_t));
+    for (i = 0; i < LARGEST_FILTER; i++) {
+        u[i] = &u_pixels[i * LARGEST_INPUT_SIZE];
+        v[i] = &v_pixels[i * LARGEST_INPUT_SIZE];
+    }
+
+    ctx = sws_alloc_context();
+    if (sws_init_context(ctx, NULL, NULL) < 0)
+        fail();
+
+    for (dfi = 0; dfi < FF_ARRAY_ELEMS(dst_formats); dfi++) {
+        ctx->dstFormat = dst_formats[dfi];
+        ff_sws_init_scale(ctx);
+
+        for (fsi = 0; fsi < FILTER_SIZES; fsi++) {
+            int filter_size = filter_sizes[fsi];
+
+            // Keep the sum of the coefficients around the 1.0 point (1 << 12)
+            // so that the output covers the whole range, clipping included.
+            for (i = 0; i < filter_size; i++)
+                filter_coeff[i] = ((1 << 12) + (rnd() & 0xfff) - 0x800) / filter_size;
+
+            if (check_func(ctx->yuv2nv12cX, "yuv2%s_cX_%d",
+                           av_get_pix_fmt_name(dst_formats[dfi]), filter_size)) {
+                for (isi = 0; isi < INPUT_SIZES; isi++) {
+                    dstW = input_sizes[isi];
+
+                    memset(dst0, 0, LARGEST_INPUT_SIZE * 2);
+                    memset(dst1, 0, LARGEST_INPUT_SIZE * 2);
+
+                    call_ref(ctx->dstFormat, dither, filter_coeff, filter_size,
+                             u, v, dst0, dstW);
+                    call_new(ctx->dstFormat, dither, filter_coeff, filter_size,
+                             u, v, dst1, dstW);
+                    if (memcmp(dst0, dst1, LARGEST_INPUT_SIZE * 2))
+                        fail();
+                }
+                bench_new(ctx->dstFormat, dither, filter_coeff, filter_size,
+                          u, v, dst1, LARGEST_INPUT_SIZE);
+            }
+        }
+    }
+    sws_freeContext(ctx);
+#undef FILTER_SIZES
+#undef INPUT_SIZES
 }
 
 #undef SRC_PIXELS
@@ -235,10 +309,141 @@ static void check_hscale(void)
     sws_freeContext(ctx);
 }
 
+static void randomize_floats(float *buf, int size)
+{
+    int i;
+
+    // Cover values outside of [0,1] too, the float path keeps them.
+    for (i = 0; i < size; i++)
+        buf[i] = (rnd() & 0xffff) * (2.0f / 0xffff) - 0.5f;
+}
+
+static void check_hscale_float(void)
+{
+#define FILTER_SIZES 6
+    static const int filter_sizes[FILTER_SIZES] = { 4, 8, 12, 16, 32, 40 };
+    int i, j, fsi, width;
+    struct SwsContext *ctx;
+
+    LOCAL_ALIGNED_32(float, src, [SRC_PIXELS + MAX_FILTER_WIDTH - 1]);
+    LOCAL_ALIGNED_32(float, dst0, [SRC_PIXELS]);
+    LOCAL_ALIGNED_32(float, dst1, [SRC_PIXELS]);
+    LOCAL_ALIGNED_32(int16_t, filter, [SRC_PIXELS * MAX_FILTER_WIDTH + MAX_FILTER_WIDTH]);
+    LOCAL_ALIGNED_32(int32_t, filterPos, [SRC_PIXELS]);
+
+    declare_func(void, void *c, void *dst, int dstW, const uint8_t *src,
+                 const int16_t *filter, const int32_t *filterPos, int filterSize);
+
+    ctx = sws_alloc_context();
+    if (sws_init_context(ctx, NULL, NULL) < 0)
+        fail();
+
+    randomize_floats(src, SRC_PIXELS + MAX_FILTER_WIDTH - 1);
+
+    for (fsi = 0; fsi < FILTER_SIZES; fsi++) {
+        width = filter_sizes[fsi];
+
+        ctx->srcFormat = ctx->dstFormat = AV_PIX_FMT_GBRPF32;
+        ctx->float_path = 1;
+        ctx->srcBpc = ctx->dstBpc = 32;
+        ctx->hLumFilterSize = ctx->hChrFilterSize = width;
+        ctx->dstW = ctx->chrDstW = SRC_PIXELS;
+
+        // Coefficients sum to the 1.0 point (1 << 14), with negative lobes.
+        for (i = 0; i < SRC_PIXELS; i++) {
+            filterPos[i] = rnd() % SRC_PIXELS;
+            for (j = 0; j < width; j++)
+                filter[i * width + j] = -((1 << 14) / (width - 1));
+            filter[i * width + (rnd() % width)] = (1 << 15) - 1;
+        }
+        ff_sws_init_scale(ctx);
+
+        if (check_func(ctx->hyScale, "hscale_float_width%d", width)) {
+            memset(dst0, 0, SRC_PIXELS * sizeof(dst0[0]));
+            memset(dst1, 0, SRC_PIXELS * sizeof(dst1[0]));
+
+            call_ref(NULL, dst0, SRC_PIXELS, (const uint8_t *)src, filter, filterPos, width);
+            call_new(NULL, dst1, SRC_PIXELS, (const uint8_t *)src, filter, filterPos, width);
+            if (!float_near_abs_eps_array(dst0, dst1, 1e-4, SRC_PIXELS))
+                fail();
+            bench_new(NULL, dst0, SRC_PIXELS, (const uint8_t *)src, filter, filterPos, width);
+        }
+    }
+    sws_freeContext(ctx);
+#undef FILTER_SIZES
+}
+
+static void check_yuv2planeX_float(void)
+{
+#define FILTER_SIZES 5
+    static const int filter_sizes[FILTER_SIZES] = {2, 3, 4, 8, 16};
+#define INPUT_SIZES 6
+    static const int input_sizes[INPUT_SIZES] = {1, 13, 24, 128, 135, 512};
+    struct SwsContext *ctx;
+    int fsi, isi, i;
+
+    const int16_t *src[LARGEST_FILTER];
+    LOCAL_ALIGNED_16(float, src_pixels, [LARGEST_FILTER * LARGEST_INPUT_SIZE]);
+    LOCAL_ALIGNED_16(int16_t, filter_coeff, [LARGEST_FILTER]);
+    LOCAL_ALIGNED_16(float, dst0, [LARGEST_INPUT_SIZE]);
+    LOCAL_ALIGNED_16(float, dst1, [LARGEST_INPUT_SIZE]);
+    LOCAL_ALIGNED_16(uint8_t, dither, [8]);
+
+    declare_func(void, const int16_t *filter, int filterSize,
+                 const int16_t **src, uint8_t *dest, int dstW,
+                 const uint8_t *dither, int offset);
+
+    randomize_buffers(dither, 8);
+    randomize_floats(src_pixels, LARGEST_FILTER * LARGEST_INPUT_SIZE);
+    for (i = 0; i < LARGEST_FILTER; i++)
+        src[i] = (const int16_t *)&src_pixels[i * LARGEST_INPUT_SIZE];
+
+    ctx = sws_alloc_context();
+    if (sws_init_context(ctx, NULL, NULL) < 0)
+        fail();
+
+    ctx->srcFormat = ctx->dstFormat = AV_PIX_FMT_GBRPF32;
+    ctx->float_path = 1;
+    ctx->srcBpc = ctx->dstBpc = 32;
+    ff_sws_init_scale(ctx);
+
+    for (fsi = 0; fsi < FILTER_SIZES; fsi++) {
+        int filter_size = filter_sizes[fsi];
+
+        // The coefficients sum to around the 1.0 point (1 << 12).
+        for (i = 0; i < filter_size; i++)
+            filter_coeff[i] = ((1 << 12) + (rnd() & 0xfff) - 0x800) / filter_size;
+
+        if (check_func(ctx->yuv2planeX, "yuv2planeX_float_%d", filter_size)) {
+            for (isi = 0; isi < INPUT_SIZES; isi++) {
+                int dstW = input_sizes[isi];
+
+                memset(dst0, 0, LARGEST_INPUT_SIZE * sizeof(dst0[0]));
+                memset(dst1, 0, LARGEST_INPUT_SIZE * sizeof(dst1[0]));
+
+                call_ref(filter_coeff, filter_size, src, (uint8_t *)dst0, dstW, dither, 0);
+                call_new(filter_coeff, filter_size, src, (uint8_t *)dst1, dstW, dither, 0);
+                if (!float_near_abs_eps_array(dst0, dst1, 1e-5, LARGEST_INPUT_SIZE))
+                    fail();
+            }
+            bench_new(filter_coeff, filter_size, src, (uint8_t *)dst1, LARGEST_INPUT_SIZE, dither, 0);
+        }
+    }
+    sws_freeContext(ctx);
+#undef FILTER_SIZES
+#undef INPUT_SIZES
+}
+
 void checkasm_check_sw_scale(void)
 {
     check_hscale();
     report("hscale");
     check_yuv2yuvX();
     report("yuv2yuvX");
+    check_yuv2nv12cX();
+    report("yuv2nv12cX");
+    check_hscale_float();
+    report("hscale_float");
+    check_yuv2planeX_float();
+    report("yuv2planeX_float");
 }
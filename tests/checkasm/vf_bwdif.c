@@ -0,0 +1,97 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/bwdif.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH  256
+#define STRIDE (WIDTH + 32)
+#define ROWS   9
+
+#define randomize_buffers(buf, size, depth)                 \
+    do {                                                    \
+        int j;                                              \
+        for (j = 0; j < size; j++) {                        \
+            if (depth > 8)                                  \
+                AV_WN16A(buf + 2 * j,                       \
+                         rnd() & ((1 << depth) - 1));       \
+            else                                            \
+                buf[j] = rnd() & 0xFF;                      \
+        }                                                   \
+    } while (0)
+
+static void check_bwdif(enum AVPixelFormat pix_fmt)
+{
+    LOCAL_ALIGNED_32(uint8_t, prev,    [ROWS * STRIDE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, cur,     [ROWS * STRIDE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, next,    [ROWS * STRIDE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref, [STRIDE * 2]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new, [STRIDE * 2]);
+    BWDIFContext s = { 0 };
+    int depth, df, clip_max, row, w, parity;
+
+    declare_func(void, void *dst, void *prev, void *cur, void *next,
+                 int w, int prefs, int mrefs, int prefs2, int mrefs2,
+                 int prefs3, int mrefs3, int prefs4, int mrefs4,
+                 int parity, int clip_max);
+
+    s.yadif.csp = av_pix_fmt_desc_get(pix_fmt);
+    depth    = s.yadif.csp->comp[0].depth;
+    df       = (depth + 7) / 8;
+    clip_max = (1 << depth) - 1;
+    /* the line functions take the strides in pixels */
+    row      = 4 * STRIDE * df;
+
+    randomize_buffers(prev, ROWS * STRIDE, depth);
+    randomize_buffers(cur,  ROWS * STRIDE, depth);
+    randomize_buffers(next, ROWS * STRIDE, depth);
+
+    ff_bwdif_init_filter_line(&s);
+
+#define ARGS(dst, w, parity)                                        \
+    dst, prev + row, cur + row, next + row, w,                      \
+    STRIDE, -STRIDE, 2 * STRIDE, -2 * STRIDE,                       \
+    3 * STRIDE, -3 * STRIDE, 4 * STRIDE, -4 * STRIDE, parity, clip_max
+
+    if (check_func(s.filter_line, "bwdif_filter_line_%dbit", depth)) {
+        for (w = 1; w <= WIDTH; w += 29) {
+            for (parity = 0; parity < 2; parity++) {
+                memset(dst_ref, 0, STRIDE * 2);
+                memset(dst_new, 0, STRIDE * 2);
+                call_ref(ARGS(dst_ref, w, parity));
+                call_new(ARGS(dst_new, w, parity));
+                if (memcmp(dst_ref, dst_new, w * df))
+                    fail();
+            }
+        }
+        bench_new(ARGS(dst_new, WIDTH, 0));
+    }
+#undef ARGS
+}
+
+void checkasm_check_vf_bwdif(void)
+{
+    check_bwdif(AV_PIX_FMT_YUV420P);
+    report("bwdif_8bit");
+
+    check_bwdif(AV_PIX_FMT_YUV420P10);
+    report("bwdif_10bit");
+}
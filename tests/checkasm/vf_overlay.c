@@ -0,0 +1,125 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/vf_overlay.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH  256
+#define ALINESIZE (2 * WIDTH + 32)
+
+#define randomize_buffers(buf, size)      \
+    do {                                  \
+        int j;                            \
+        uint8_t *tmp_buf = (uint8_t *)buf;\
+        for (j = 0; j < size; j++)        \
+            tmp_buf[j] = rnd() & 0xFF;    \
+    } while (0)
+
+#define FAST_DIV255(x) ((((x) + 128) * 257) >> 16)
+
+/* Straight alpha blending of one row, as done by blend_plane() for pixels
+ * that are not on the right or bottom edge of the overlay. */
+static int overlay_row_44_c(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                            int w, ptrdiff_t alinesize)
+{
+    for (int k = 0; k < w; k++)
+        d[k] = FAST_DIV255(d[k] * (255 - a[k]) + s[k] * a[k]);
+    return w;
+}
+
+static int overlay_row_22_c(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                            int w, ptrdiff_t alinesize)
+{
+    for (int k = 0; k < w - 1; k++) {
+        int alpha = (a[2 * k] + ((a[2 * k] + a[2 * k + 1]) >> 1)) >> 1;
+        d[k] = FAST_DIV255(d[k] * (255 - alpha) + s[k] * alpha);
+    }
+    return FFMAX(w - 1, 0);
+}
+
+static int overlay_row_20_c(uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                            int w, ptrdiff_t alinesize)
+{
+    for (int k = 0; k < w - 1; k++) {
+        int alpha = (a[2 * k] + a[2 * k + 1] +
+                     a[alinesize + 2 * k] + a[alinesize + 2 * k + 1]) >> 2;
+        d[k] = FAST_DIV255(d[k] * (255 - alpha) + s[k] * alpha);
+    }
+    return FFMAX(w - 1, 0);
+}
+
+static void check_overlay_row(int format, enum AVPixelFormat pix_fmt,
+                              int plane, const char *name)
+{
+    LOCAL_ALIGNED_32(uint8_t, d,     [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, d_ref, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, d_new, [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, s,     [WIDTH]);
+    LOCAL_ALIGNED_32(uint8_t, a,     [2 * ALINESIZE]);
+    OverlayContext ctx = { 0 };
+    int w;
+
+    declare_func(int, uint8_t *d, uint8_t *da, uint8_t *s, uint8_t *a,
+                 int w, ptrdiff_t alinesize);
+
+    randomize_buffers(d, WIDTH);
+    randomize_buffers(s, WIDTH);
+    randomize_buffers(a, 2 * ALINESIZE);
+
+    /* only the SIMD versions exist in the filter; the C fallback is the
+     * per pixel loop in blend_plane() */
+    for (int i = 0; i < 3; i++)
+        ctx.blend_row[i] = overlay_row_44_c;
+    if (format == OVERLAY_FORMAT_YUV422)
+        ctx.blend_row[1] = ctx.blend_row[2] = overlay_row_22_c;
+    if (format == OVERLAY_FORMAT_YUV420)
+        ctx.blend_row[1] = ctx.blend_row[2] = overlay_row_20_c;
+
+    ff_overlay_init_blend_row(&ctx, format, pix_fmt, 0, 0);
+
+    if (check_func(ctx.blend_row[plane], "%s", name)) {
+        for (w = 0; w <= WIDTH; w += 17) {
+            int c_ref, c_new;
+
+            memcpy(d_ref, d, WIDTH);
+            memcpy(d_new, d, WIDTH);
+            c_ref = call_ref(d_ref, NULL, s, a, w, ALINESIZE);
+            c_new = call_new(d_new, NULL, s, a, w, ALINESIZE);
+            /* the pixels left over are blended by the C loop */
+            if (c_new < 0 || c_new > c_ref ||
+                memcmp(d_ref, d_new, c_new) ||
+                memcmp(d + c_new, d_new + c_new, WIDTH - c_new))
+                fail();
+        }
+        bench_new(d_new, NULL, s, a, WIDTH, ALINESIZE);
+    }
+}
+
+void checkasm_check_vf_overlay(void)
+{
+    check_overlay_row(OVERLAY_FORMAT_YUV444, AV_PIX_FMT_YUV444P, 0, "overlay_row_44");
+    report("overlay_row_44");
+
+    check_overlay_row(OVERLAY_FORMAT_YUV422, AV_PIX_FMT_YUV422P, 1, "overlay_row_22");
+    report("overlay_row_22");
+
+    check_overlay_row(OVERLAY_FORMAT_YUV420, AV_PIX_FMT_YUV420P, 1, "overlay_row_20");
+    report("overlay_row_20");
+}
@@ -0,0 +1,67 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/psnr.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH 256
+
+static void check_sse_line(int bpp, const char *report_name)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf, [WIDTH * 2]);
+    LOCAL_ALIGNED_32(uint8_t, ref, [WIDTH * 2]);
+    int mask = (1 << bpp) - 1;
+    PSNRDSPContext dsp;
+    int i, w;
+
+    declare_func(uint64_t, const uint8_t *buf, const uint8_t *ref, int w);
+
+    for (i = 0; i < WIDTH; i++) {
+        if (bpp > 8) {
+            AV_WN16A(buf + 2 * i, rnd() & mask);
+            AV_WN16A(ref + 2 * i, rnd() & mask);
+        } else {
+            buf[i] = rnd() & mask;
+            ref[i] = rnd() & mask;
+        }
+    }
+
+    ff_psnr_init(&dsp, bpp);
+
+    if (check_func(dsp.sse_line, "sse_line_%s", report_name)) {
+        for (w = 1; w <= WIDTH; w++) {
+            uint64_t res_ref = call_ref(buf, ref, w);
+            uint64_t res_new = call_new(buf, ref, w);
+            if (res_ref != res_new)
+                fail();
+        }
+        bench_new(buf, ref, WIDTH);
+    }
+}
+
+void checkasm_check_vf_psnr(void)
+{
+    check_sse_line(8, "8bit");
+    report("sse_line_8bit");
+
+    check_sse_line(16, "16bit");
+    report("sse_line_16bit");
+}
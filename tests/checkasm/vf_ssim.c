@@ -0,0 +1,101 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/ssim.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH  256
+#define HEIGHT 4
+#define BLOCKS (WIDTH / 4)
+
+static void check_ssim_4x4_line(SSIMDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(uint8_t, buf, [WIDTH * HEIGHT]);
+    LOCAL_ALIGNED_32(uint8_t, ref, [WIDTH * HEIGHT]);
+    LOCAL_ALIGNED_32(int, sums_ref, [BLOCKS], [4]);
+    LOCAL_ALIGNED_32(int, sums_new, [BLOCKS], [4]);
+    int i, w;
+
+    declare_func(void, const uint8_t *buf, ptrdiff_t buf_stride,
+                 const uint8_t *ref, ptrdiff_t ref_stride,
+                 int (*sums)[4], int w);
+
+    for (i = 0; i < WIDTH * HEIGHT; i++) {
+        buf[i] = rnd();
+        ref[i] = rnd();
+    }
+
+    if (check_func(dsp->ssim_4x4_line, "ssim_4x4_line")) {
+        for (w = 1; w <= BLOCKS; w++) {
+            memset(sums_ref, 0, sizeof(int[BLOCKS][4]));
+            memset(sums_new, 0, sizeof(int[BLOCKS][4]));
+            call_ref(buf, WIDTH, ref, WIDTH, sums_ref, w);
+            call_new(buf, WIDTH, ref, WIDTH, sums_new, w);
+            if (memcmp(sums_ref, sums_new, sizeof(int[BLOCKS][4])))
+                fail();
+        }
+        bench_new(buf, WIDTH, ref, WIDTH, sums_new, BLOCKS);
+    }
+}
+
+static void check_ssim_end_line(SSIMDSPContext *dsp)
+{
+    LOCAL_ALIGNED_32(int, sum0, [BLOCKS + 1], [4]);
+    LOCAL_ALIGNED_32(int, sum1, [BLOCKS + 1], [4]);
+    int i, j, w;
+
+    declare_func(double, const int (*sum0)[4], const int (*sum1)[4], int w);
+
+    for (i = 0; i <= BLOCKS; i++) {
+        // plausible sums of a 4x4 block: s1, s2 <= 16 * 255,
+        // ss, s12 <= 16 * 255 * 255
+        for (j = 0; j < 2; j++) {
+            sum0[i][j] = rnd() % (16 * 255 + 1);
+            sum1[i][j] = rnd() % (16 * 255 + 1);
+        }
+        for (j = 2; j < 4; j++) {
+            sum0[i][j] = rnd() % (16 * 255 * 255 + 1);
+            sum1[i][j] = rnd() % (16 * 255 * 255 + 1);
+        }
+    }
+
+    if (check_func(dsp->ssim_end_line, "ssim_end_line")) {
+        for (w = 1; w <= BLOCKS; w++) {
+            double res_ref = call_ref((const int (*)[4])sum0, (const int (*)[4])sum1, w);
+            double res_new = call_new((const int (*)[4])sum0, (const int (*)[4])sum1, w);
+            if (!double_near_abs_eps(res_ref, res_new, 1e-4 * w))
+                fail();
+        }
+        bench_new((const int (*)[4])sum0, (const int (*)[4])sum1, BLOCKS);
+    }
+}
+
+void checkasm_check_vf_ssim(void)
+{
+    SSIMDSPContext dsp;
+
+    ff_ssim_init(&dsp);
+
+    check_ssim_4x4_line(&dsp);
+    report("ssim_4x4_line");
+
+    check_ssim_end_line(&dsp);
+    report("ssim_end_line");
+}
@@ -0,0 +1,64 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/transpose.h"
+#include "libavutil/mem_internal.h"
+
+#define STRIDE 64
+
+#define randomize_buffers(buf, size)      \
+    do {                                  \
+        int j;                            \
+        uint8_t *tmp_buf = (uint8_t *)buf;\
+        for (j = 0; j < size; j++)        \
+            tmp_buf[j] = rnd() & 0xFF;    \
+    } while (0)
+
+static void check_transpose_8x8(int pixstep)
+{
+    LOCAL_ALIGNED_32(uint8_t, src,     [8 * STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref, [8 * STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new, [8 * STRIDE]);
+    TransVtable v = { 0 };
+
+    declare_func(void, uint8_t *src, ptrdiff_t src_linesize,
+                 uint8_t *dst, ptrdiff_t dst_linesize);
+
+    randomize_buffers(src, 8 * STRIDE);
+    memset(dst_ref, 0, 8 * STRIDE);
+    memset(dst_new, 0, 8 * STRIDE);
+
+    ff_transpose_init(&v, pixstep);
+
+    if (check_func(v.transpose_8x8, "transpose_8x8_%d", pixstep * 8)) {
+        call_ref(src, STRIDE, dst_ref, STRIDE);
+        call_new(src, STRIDE, dst_new, STRIDE);
+        if (memcmp(dst_ref, dst_new, 8 * STRIDE))
+            fail();
+        bench_new(src, STRIDE, dst_new, STRIDE);
+    }
+}
+
+void checkasm_check_vf_transpose(void)
+{
+    check_transpose_8x8(1);
+    check_transpose_8x8(2);
+    report("transpose_8x8");
+}
@@ -0,0 +1,95 @@
+/*
+ * This file is part of FFmpeg.
+ *
+ * FFmpeg is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation; either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * FFmpeg is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License along
+ * with FFmpeg; if not, write to the Free Software Foundation, Inc.,
+ * 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301 USA.
+ */
+
+#include <string.h>
+#include "checkasm.h"
+#include "libavfilter/yadif.h"
+#include "libavutil/intreadwrite.h"
+#include "libavutil/mem_internal.h"
+
+#define WIDTH  256
+#define STRIDE (2 * (WIDTH + 64))
+#define ROWS   5
+
+#define randomize_buffers(buf, size, depth)                 \
+    do {                                                    \
+        int j;                                              \
+        for (j = 0; j < size; j++) {                        \
+            if (depth > 8)                                  \
+                AV_WN16A(buf + 2 * j,                       \
+                         rnd() & ((1 << depth) - 1));       \
+            else                                            \
+                buf[j] = rnd() & 0xFF;                      \
+        }                                                   \
+    } while (0)
+
+static void check_yadif(enum AVPixelFormat pix_fmt)
+{
+    LOCAL_ALIGNED_32(uint8_t, prev,    [ROWS * STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, cur,     [ROWS * STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, next,    [ROWS * STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, dst_ref, [STRIDE]);
+    LOCAL_ALIGNED_32(uint8_t, dst_new, [STRIDE]);
+    YADIFContext s = { 0 };
+    const int row = 2 * STRIDE + 16;
+    int depth, df, w, parity, mode;
+
+    declare_func(void, void *dst, void *prev, void *cur, void *next,
+                 int w, int prefs, int mrefs, int parity, int mode);
+
+    s.csp = av_pix_fmt_desc_get(pix_fmt);
+    depth = s.csp->comp[0].depth;
+    df    = (depth + 7) / 8;
+
+    randomize_buffers(prev, ROWS * STRIDE / df, depth);
+    randomize_buffers(cur,  ROWS * STRIDE / df, depth);
+    randomize_buffers(next, ROWS * STRIDE / df, depth);
+
+    ff_yadif_init_filter_line(&s);
+
+    if (check_func(s.filter_line, "yadif_filter_line_%dbit", depth)) {
+        for (w = 1; w <= WIDTH; w += 29) {
+            for (parity = 0; parity < 2; parity++) {
+                for (mode = 0; mode < 4; mode += 2) {
+                    memset(dst_ref, 0, STRIDE);
+                    memset(dst_new, 0, STRIDE);
+                    call_ref(dst_ref, prev + row, cur + row, next + row,
+                             w, STRIDE, -STRIDE, parity, mode);
+                    call_new(dst_new, prev + row, cur + row, next + row,
+                             w, STRIDE, -STRIDE, parity, mode);
+                    if (memcmp(dst_ref, dst_new, w * df))
+                        fail();
+                }
+            }
+        }
+        bench_new(dst_new, prev + row, cur + row, next + row,
+                  WIDTH, STRIDE, -STRIDE, 0, 0);
+    }
+}
+
+void checkasm_check_vf_yadif(void)
+{
+    check_yadif(AV_PIX_FMT_YUV420P);
+    report("yadif_8bit");
+
+    check_yadif(AV_PIX_FMT_YUV420P10);
+    report("yadif_10bit");
+
+    check_yadif(AV_PIX_FMT_YUV420P16);
+    report("yadif_16bit");
+}
@@ -396,6 +396,10 @@ FATE_AFILTER-yes += fate-filter-formats
 fate-filter-formats: libavfilter/tests/formats$(EXESUF)
 fate-filter-formats: CMD = run libavfilter/tests/formats$(EXESUF)
 
+FATE_AFILTER-$(call ALLYES, VOLUME_FILTER ASETPTS_FILTER) += fate-filter-framebatch
+fate-filter-framebatch: libavfilter/tests/framebatch$(EXESUF)
+fate-filter-framebatch: CMD = run libavfilter/tests/framebatch$(EXESUF)
+
 FATE_SAMPLES_AVCONV += $(FATE_AFILTER_SAMPLES-yes)
 FATE_FFMPEG += $(FATE_AFILTER-yes)
 fate-afilter: $(FATE_AFILTER-yes) $(FATE_AFILTER_SAMPLES-yes)
@@ -113,6 +113,10 @@ fate-filter-yuvtestsrc-yuv444p: CMD = framecrc -lavfi yuvtestsrc=rate=5:duration
 FATE_FILTER-$(call ALLYES, LAVFI_INDEV YUVTESTSRC_FILTER) += fate-filter-yuvtestsrc-yuv444p12
 fate-filter-yuvtestsrc-yuv444p12: CMD = framecrc -lavfi yuvtestsrc=rate=5:duration=1,format=yuv444p12,scale -pix_fmt yuv444p12le
 
+# scale into the negatively strided buffers of vflip, in output slices on several threads
+FATE_FILTER-$(call ALLYES, LAVFI_INDEV TESTSRC_FILTER SCALE_FILTER FORMAT_FILTER VFLIP_FILTER) += fate-filter-scale-vflip-threads
+fate-filter-scale-vflip-threads: CMD = framecrc -cpuflags 0 -filter_complex_threads 3 -lavfi testsrc=s=640x360:rate=5:duration=1,scale=320:182,format=yuv420p,vflip -sws_flags +accurate_rnd+bitexact
+
 FATE_FILTER-$(call ALLYES, AVDEVICE TESTSRC_FILTER FORMAT_FILTER CONCAT_FILTER SCALE_FILTER) += fate-filter-lavd-scalenorm
 fate-filter-lavd-scalenorm: tests/data/filtergraphs/scalenorm
 fate-filter-lavd-scalenorm: CMD = framecrc -f lavfi -graph_file $(TARGET_PATH)/tests/data/filtergraphs/scalenorm -i dummy
@@ -862,6 +866,30 @@ fate-filter-refcmp-ssim-rgb: CMD = refcmp_metadata ssim rgb24 0.015
 FATE_FILTER-$(call ALLYES, $(REFCMP_DEPS) SSIM_FILTER) += fate-filter-refcmp-ssim-yuv
 fate-filter-refcmp-ssim-yuv: CMD = refcmp_metadata ssim yuv422p 0.015
 
+FATE_FILTER-$(call ALLYES, SPLIT_FILTER DRAWBOX_FILTER HFLIP_FILTER SCALE_FILTER OVERLAY_FILTER CROP_FILTER PAD_FILTER) += fate-filter-inplace
+fate-filter-inplace: libavfilter/tests/inplace$(EXESUF)
+fate-filter-inplace: CMD = run libavfilter/tests/inplace$(EXESUF)
+
+# the branches after split are activated together with -parallel_filters,
+# which must not change the output of one frame in, one frame out filters
+SPLIT_GRAPH = "testsrc2=s=320x240:rate=10:duration=2,format=yuv420p,split=3[a][b][c];[a]hflip[a1];[b]vflip,negate[b1];[c]edgedetect=mode=canny[c1];[a1][b1][c1]vstack=3"
+FATE_FILTER-$(call ALLYES, LAVFI_INDEV TESTSRC2_FILTER FORMAT_FILTER SPLIT_FILTER HFLIP_FILTER VFLIP_FILTER NEGATE_FILTER EDGEDETECT_FILTER VSTACK_FILTER) += fate-filter-split-serial fate-filter-split-parallel
+fate-filter-split-serial:   CMD = framecrc -filter_complex_threads 4 -lavfi $(SPLIT_GRAPH)
+fate-filter-split-parallel: CMD = framecrc -filter_complex_threads 4 -parallel_filters -lavfi $(SPLIT_GRAPH)
+fate-filter-split-parallel: REF = $(SRC_PATH)/tests/ref/fate/filter-split-serial
+
+# scdet computes the SAD of batches of frames concurrently, the scores must
+# not depend on the number of threads
+SCDET_GRAPH = "mptestsrc=r=25:d=2,scdet=t=3,metadata=mode=print:file=-"
+FATE_FILTER-$(call ALLYES, MPTESTSRC_FILTER SCDET_FILTER METADATA_FILTER WRAPPED_AVFRAME_ENCODER NULL_MUXER) += fate-filter-scdet-threads1 fate-filter-scdet-threads4
+fate-filter-scdet-threads1: CMD = ffmpeg -filter_complex_threads 1 -lavfi $(SCDET_GRAPH) -f null -
+fate-filter-scdet-threads4: CMD = ffmpeg -filter_complex_threads 4 -lavfi $(SCDET_GRAPH) -f null -
+fate-filter-scdet-threads4: REF = $(SRC_PATH)/tests/ref/fate/filter-scdet-threads1
+
+FATE_FILTER-yes += fate-filter-framepool
+fate-filter-framepool: libavfilter/tests/framepool$(EXESUF)
+fate-filter-framepool: CMD = run libavfilter/tests/framepool$(EXESUF)
+
 FATE_SAMPLES_FFPROBE += $(FATE_METADATA_FILTER-yes)
 FATE_SAMPLES_FFMPEG += $(FATE_FILTER_SAMPLES-yes)
 FATE_FFMPEG += $(FATE_FILTER-yes)